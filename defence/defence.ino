@@ -1,395 +1,117 @@
-#include <SoftwareSerial.h>
 #include <Wire.h>
-#include <Adafruit_BNO055.h>
-#include <LiquidCrystal_I2C.h>
-
-SoftwareSerial mySer(10, 11); //RX, TX
-LiquidCrystal_I2C lcd(0x27, 16, 2);
-
-Adafruit_BNO055 bno = Adafruit_BNO055(-1, 0x28);    //コンパス
-
-volatile bool switch_con = true;
-bool judge_bno = true;
-bool judge_stay = true;
-
-const uint8_t color_pin[] = {1, 2, 3};
-
-uint8_t push_count = 0;
-
-//モーターパワー
-uint8_t m[4];   //回転の向き決定用  左前、右前、右後ろ、左後ろ
-uint8_t m_power[4];
-const String Direction[] = {"F", "R"};
-const uint8_t motor_pin[] = {1, 2, 4, 3};
-
-
-void print_lcd(String words, uint8_t k) {
-  lcd.setCursor(0, k);
-  lcd.print(words);
-}
-
-void interrupt() {
-  switch_con != switch_con;
-}
-
-void stop_motor() {
-  m_power[0] = m_power[1] = m_power[2] = m_power[3] = 0;
-}
-
-void init_motor() {
-  m_power[1] = m_power[3] = m_power[0] = m_power[2] = 30;
-}
-
-void motor_ctrl() {
-  String d = Direction[m[0]];
-  String p = "0" + String(m_power[0]);
-  if (p.length() == 2) {
-    p = "0" + p;
-  }
-  mySer.println(String(motor_pin[0] + d + p));
-
-  d = Direction[m[1]];
-  p = "0" + String(m_power[1]);
-  if (p.length() == 2) {
-    p = "0" + p;
-  }
-  mySer.println(String(motor_pin[1] + d + p));
-  
-
-  d = Direction[m[2]];
-  p = "0" + String(m_power[2]);
-  if (p.length() == 2) {
-    p = "0" + p;
-  }
-  mySer.println(String(motor_pin[2] + d + p));
-
-  d = Direction[m[3]];
-  p = "0" + String(m_power[3]);
-  if (p.length() == 2) {
-    p = "0" + p;
-  }
-  mySer.println(String(motor_pin[3] + d + p));
-}
-
-struct CamPos {
-public:
-  uint16_t x, y;
-  CamPos(uint8_t x, uint8_t y) : x(x), y(y) {}
-  uint8_t to_string(char *dst)
-  {
-    if (dst == NULL)
-      return 0;
-    return sprintf(dst, "(%u, %u)", x, y);
-  }
-};
-
-bool operator==(const CamPos &lh, const CamPos &rh)
-{
-  return lh.x == rh.x && lh.y == rh.y;
-}
-
-bool operator!=(const CamPos &lh, const CamPos &rh)
-{
-  return lh.x != rh.x || lh.y != rh.y;
+#include <SoftwareSerial.h>
+#include <robo2019.h>
+
+// defence機のMCBはSoftwareSerial(10, 11)につながっている(RX, TX)
+SoftwareSerial motor_ser(10, 11);
+robo::Motor motor(&motor_ser);
+robo::LCD lcd(robo::profile::lcd_address, robo::profile::lcd_cols, robo::profile::lcd_rows);
+robo::BNO055 bno055(-1, robo::profile::bno055_address);
+robo::openmv::Reader mv_reader(robo::profile::openmv_address);
+robo::openmv::FrameData frame;
+
+// 実行中に調整できるパラメーター(シリアルで"list"、"set goal_far_y 100"、"save"など)
+namespace param {
+    enum : uint8_t {
+        line_white,  // ラインセンサーの値がこれより大きければ白
+        goal_near_y, // 自分のゴールのy座標がこれより小さければ近づきすぎ
+        goal_far_y,  // 自分のゴールのy座標がこれより大きければ離れすぎ
+        center_x,    // 機体の正面のx座標
+        dead_band,   // ボールとの横方向の差がこれ以下なら動かない(正面の範囲はcenter_x±dead_band)
+        count,
+    };
+    const char line_white_name[] PROGMEM = "line_white";
+    const char goal_near_y_name[] PROGMEM = "goal_near_y";
+    const char goal_far_y_name[] PROGMEM = "goal_far_y";
+    const char center_x_name[] PROGMEM = "center_x";
+    const char dead_band_name[] PROGMEM = "dead_band";
+
+    constexpr robo::ParamDef defs[] PROGMEM = {
+        { line_white_name, robo::profile::lines::defence_line_white, 0, 1023 },
+        { goal_near_y_name, 92, 0, 140 },
+        { goal_far_y_name, 103, 0, 140 },
+        { center_x_name, 80, 0, 180 },
+        { dead_band_name, 7, 0, 90 },
+    };
+    static_assert(sizeof(defs) / sizeof(defs[0]) == count, "defs must match the enum");
 }
-
-class Frame
-{
-public:
-  CamPos *ball_pos, *yellow_goal_pos, *blue_goal_pos;
-#define X(_name_) _name_##_x
-#define Y(_name_) _name_##_y
-#define PARAM(_name_) uint16_t X(_name_), uint16_t Y(_name_)
-#define NEW_POS(_name_) new CamPos(X(_name_), Y(_name_))
-  Frame(PARAM(ball), PARAM(yellow_goal), PARAM(blue_goal))
-      : ball_pos(NEW_POS(ball)), yellow_goal_pos(NEW_POS(yellow_goal)), blue_goal_pos(NEW_POS(blue_goal))
-  {
-  }
-#undef X
-#undef Y
-#undef PARAM
-#undef NEW_POS
-  Frame(CamPos *ball_pos, CamPos *yellow_goal_pos, CamPos *blue_goal_pos)
-      : ball_pos(ball_pos), yellow_goal_pos(yellow_goal_pos), blue_goal_pos(blue_goal_pos)
-  {
-  }
-  ~Frame()
-  {
-#define DELETE(_name_)      \
-  if (_name_##_pos != NULL) \
-    delete _name_##_pos;
-    DELETE(ball)
-    DELETE(yellow_goal)
-    DELETE(blue_goal)
-#undef DELETE
-  }
-  uint8_t to_string(char *dst)
-  {
-    if (dst == NULL)
-      return 0;
-    char *ptr = dst;
-    if (ball_pos != NULL)
-    {
-      ptr += sprintf(ptr, "ball_pos: ");
-      ptr += ball_pos->to_string(ptr);
-      *(ptr++) = '\n';
-    }
-    if (yellow_goal_pos != NULL)
-    {
-      ptr += sprintf(ptr, "yellow_goal_pos: ");
-      ptr += yellow_goal_pos->to_string(ptr);
-      *(ptr++) = '\n';
-    }
-    if (blue_goal_pos != NULL)
-    {
-      ptr += sprintf(ptr, "blue_goal_pos: ");
-      ptr += blue_goal_pos->to_string(ptr);
-      *(ptr++) = '\n';
-    }
-    *ptr = '\0';
-    return ptr - dst;
-  }
-};
-
-class OpenMV
-{
-private:
-  TwoWire &_wire;
-
-  uint16_t read_2byte() { return _wire.read() | ((uint16_t)_wire.read() << 8); }
-  CamPos *read_pos()
-  {
-    constexpr uint16_t default_value = 0xffff;
-    uint16_t x = read_2byte();
-    uint16_t y = read_2byte();
-    return (x != default_value || y != default_value) ? new CamPos(x, y) : NULL;
-  }
-
-public:
-  const uint8_t address;
-
-  OpenMV() : _wire(Wire), address(0x12) {}
-  OpenMV(uint8_t addr) : _wire(Wire), address(addr) {}
-  OpenMV(TwoWire &wire, uint8_t addr) : _wire(wire), address(addr) {}
-  OpenMV(uint8_t addr, TwoWire &wire) : _wire(wire), address(addr) {}
-
-  void setup() { _wire.begin(); }
-  Frame *read_frame()
-  {
-    constexpr uint8_t req_size = 3 * 4;
-    uint8_t res_size = _wire.requestFrom(address, req_size);
-    if (res_size != req_size)
-      return NULL;
-    CamPos *ball = read_pos();
-    CamPos *yellow = read_pos();
-    CamPos *blue = read_pos();
-    _wire.beginTransmission(address);
-    _wire.write(1);
-    _wire.endTransmission();
-    if (ball == NULL && yellow == NULL && blue == NULL)
-      return NULL;
-    return new Frame(ball, yellow, blue);
-  }
-};
-
-OpenMV *openmv;
-char buffer[128] = "";
-
-
-int read_compass() {  //地磁気読み込み  正面0 //x回転のみ調べてる
-  static int16_t compass_x_pri;
-  static bool t = true;
-
-  double euler_x = bno.getVector(Adafruit_BNO055::VECTOR_EULER).x();
-
-  if (t) { // 最初の方向の取得(一回のみ)
-    compass_x_pri = euler_x;
-    t = false;
-  }
-
-  return int16_t(euler_x - compass_x_pri) % 360 - 180; //反時計回りに180～-180
+robo::Params<param::count> params(param::defs);
+robo::ParamConsole console(params, robo::profile::eeprom::params);
+
+// Goalieはパラメーターを参照で持つので、書き換えれば次の周期から使われる
+robo::Goalie::Config goalie_config = robo::Goalie::default_config;
+robo::Interceptor::Config intercept_config = robo::Interceptor::default_config;
+robo::Goalie goalie(motor, goalie_config, intercept_config);
+
+// パラメーターを各クラスの設定に写す
+void apply_params() {
+    goalie_config.goal_near_y = params[param::goal_near_y];
+    goalie_config.goal_far_y = params[param::goal_far_y];
+    intercept_config.center_x = params[param::center_x];
+    intercept_config.dead_band = params[param::dead_band];
 }
 
-void compass() { //コンパスチェック→角度、距離を出す→動く
-  int16_t com = read_compass();
+// ラインセンサー群
+namespace lines {
+    robo::profile::lines::Left left;   // 1
+    robo::profile::lines::Right right; // 2
+    robo::profile::lines::Back back;   // 3
 
-  if (abs(com) < 165) {
-    judge_bno = true;
-    if (com > 0) {
-      m[0] = 1 , m[1] = 0 , m[2] = 0 , m[3] = 1;
-      for (uint8_t i = 0; i < 4; i++) {
-        m_power[i] = min(int(abs(com - 180.0) / 180.0 * 100), 30);
-        m_power[i] = max(m_power[i], 20);
-      }
-    } else {
-      m[0] = 0 , m[1] = 1 , m[2] = 1 , m[3] = 0;
-      for (uint8_t i = 0; i < 4; i++) {
-        m_power[i] = min(int(abs(com + 180.0) / 180.0 * 100), 30);
-        m_power[i] = max(m_power[i], 20);
-      }
+    bool iswhite(uint16_t val) {
+        return int16_t(val) > params[param::line_white];
     }
-    motor_ctrl();
-  } else {
-    judge_bno = false;
-  }
 }
 
-void motor_dire(uint8_t m1, uint8_t m2, uint8_t m3, uint8_t m4) { //後ろならfalse
-  m[0] = m1, m[1] = m2, m[2] = m3, m[3] = m4;
-}
+// 起動したときの向き(これを正面とする)
+robo::Angle heading_offset;
 
-void push(uint8_t pos_y ) {
-  push_count = 0;
-  
-  m_power[0] = m_power[1] = m_power[2] = m_power[3] = 60;
-  motor_dire(1, 1, 1, 1);
-  motor_ctrl();
-  delay(abs(pos_y - 60) * 10);
-
-  stop_motor();
-  delay(20);
-  
-  m_power[0] = m_power[1] = m_power[2] = m_power[3] = 40;
-  motor_dire(0, 0, 0, 0);
-  motor_ctrl();
-  delay(abs(pos_y - 60) * 10);
+// 起動したときの向きからのずれ(左回りが正)。robo::Angleは1周で自然に折り返す
+robo::Angle read_heading() {
+    return bno055.get_heading() - heading_offset;
 }
 
-void Line() {
-  static uint8_t count_move = 0;
-  static bool goal_color;
-  uint8_t pos_x, pos_y;
-  Frame *frame = openmv->read_frame();
-  
-  if(frame->ball_pos != NULL){
-    pos_x = frame->ball_pos->x;
-    pos_y = frame->ball_pos->y;
-    
-    if (pos_x < 73 || pos_x > 87) {
-      if (pos_x > 87) {
-        motor_dire(0, 1, 0, 1);
-      } else if (pos_x < 73) {
-        motor_dire(1, 0, 1, 0);
-      }
-      uint8_t pro = max(20, abs(uint8_t(pos_x) - 80)*3);
-      m_power[0] = m_power[1] = m_power[2] = m_power[3] = min(40, pro);
-      motor_ctrl();
-      push_count = 0;
-    } else if (73 <= pos_x && pos_x <= 87 && pos_y <= 40 && pos_y >= 21) {
-      push_count++;
-      if(push_count > 30){
-        push(int(pos_y));
-      }
-      stop_motor();
-      motor_ctrl();
-    }
-    delete frame;
-  } else if (count_move > 6) {
-      stop_motor();
-      count_move = 0;
-      motor_ctrl();
-  } else {
-      count_move++;
-  }
-  
-}
+void setup() {
+    Serial.begin(9600);
 
-void stay() {
-  init_motor();
-  bool j_move=false;
-  uint16_t c1 = analogRead(1), c2 = analogRead(2), c3 = analogRead(3);  //1::left  2::right  3::back
-  Frame *frame = openmv->read_frame();
-  static bool color, first=true;
-  uint8_t goal_pos_y;
+    lcd.setup();
+    mv_reader.setup();
+    motor_ser.begin(robo::profile::motor::baud);
+    motor.stop();
 
-  if(c1 > 550){
-    motor_dire(1, 0, 1, 0);
-    judge_stay = j_move = true;
-    motor_ctrl();
-    delay(400);
-  }else if(c2 > 550){
-    motor_dire(0, 1, 0, 1);
-    judge_stay = j_move = true; 
-    motor_ctrl();
-    delay(400);
-  }else if(c3 > 550){
-    motor_dire(1, 1, 1, 1);
-    judge_stay = j_move = true;
-    motor_ctrl();
-    delay(200);
-  }
-  
-  if(first){
-    if(frame->blue_goal_pos->y > frame->yellow_goal_pos->y)  color = true;
-    else                                                     color = false; //false::blue=back
-    first = false;
-  }
-  if(color){
-    if(frame->yellow_goal_pos != NULL){
-      goal_pos_y = frame->yellow_goal_pos->y;
-      if(goal_pos_y > 103){
-        motor_dire(0, 0, 0, 0);
-        motor_ctrl();
-        judge_stay = j_move = true;
-        Serial.println("Too long");
-      } else if(goal_pos_y < 92){
-        motor_dire(1, 1, 1, 1);
-        motor_ctrl();
-        judge_stay = j_move = true;
-      }
-      Serial.println(String(goal_pos_y));
-    }
-  } else {
-    if(frame->blue_goal_pos != NULL){
-      goal_pos_y = frame->blue_goal_pos->y;
-      if(goal_pos_y > 103){
-        motor_dire(0, 0, 0, 0);
-        motor_ctrl();
-        judge_stay = j_move = true;
-      } else if(goal_pos_y < 92){
-        motor_dire(1, 1, 1, 1);
-        motor_ctrl();
-        judge_stay = j_move = true;
-      }
+    bno055.setup();
+    lcd.setCursor(0, 1);
+    if (!bno055.detected()) {
+        lcd.print(F("could not connect to bno"));
+    } else {
+        // EEPROMから較正値を書き戻せたかどうか
+        lcd.print(bno055.restored() ? F("calib: restored") : F("calib: none"));
     }
-  }
-  if(frame != NULL)  delete frame;
-  
-  if(judge_stay == true && j_move == false){
-    stop_motor();
-    motor_ctrl();
-    judge_stay = false;
-  }
-}
-
-void setup() {
 
-  Serial.begin(9600);
-  openmv = new OpenMV(0x12);
-  
-  Wire.begin();
-  lcd.init();
-  lcd.backlight();
-  openmv->setup();
-  mySer.begin(19200);
+    lines::left.setup();
+    lines::right.setup();
+    lines::back.setup();
 
-  bool started = bno.begin();
-  if (!started) {
-    print_lcd("could not connect to bno", 1);
-  }
-  bno.setExtCrystalUse(true);
+    heading_offset = bno055.get_heading();
 
-  for(uint8_t i=0; i<3; i++){
-    pinMode(color_pin[i], INPUT);
-  }
+    // EEPROMに保存したパラメーターがあれば使う
+    params.load(robo::profile::eeprom::params);
+    apply_params();
 }
 
 void loop() {
-  compass();
-  if (!judge_bno) {
-    stay();
-    if (!judge_stay) {
-      Line();
+    const uint32_t now = millis();
+    // シリアルからパラメーターを読み書きする(受け取った文字だけを読むので待たない)
+    if (console.poll(Serial)) apply_params();
+    // 較正が終わったら、次の起動のためにEEPROMへ保存する
+    if (bno055.autosave(now)) {
+        lcd.setCursor(0, 1);
+        lcd.print(F("calib: saved   "));
     }
-  }
+    const robo::Angle dir = read_heading();
+    const bool w_left = lines::iswhite(lines::left.read());
+    const bool w_right = lines::iswhite(lines::right.read());
+    const bool w_back = lines::iswhite(lines::back.read());
+    // 1周期に1回だけ読む(ヒープは使わない)
+    mv_reader.read_frame(frame);
+    goalie.update(dir, w_left, w_right, w_back, frame, now);
 }
@@ -64,20 +64,66 @@ namespace omv {
 // half-pi
 constexpr float HPI = PI / 2;
 constexpr float QPI = PI / 4;
-// 「正面」の範囲
-constexpr float front_range = PI / 10;
-// 機体の移動スピード
-constexpr int8_t max_speed = 100;
-// キッカーのピン番号(不使用)
-constexpr uint8_t kicker_pin = 10;
-
-SoftwareSerial motor_ser(12, 13);
-robo::Motor motor(&motor_ser);
+// 実行中に調整できるパラメーター(シリアルで"list"、"set max_speed 80"、"save"など)
+namespace param {
+    enum : uint8_t {
+        front_range, // 「正面」の範囲(度)
+        max_speed,   // 機体の移動スピード
+        rotate_gain, // 正面に戻るときの回転の速さ = ずれ(ラジアン) * rotate_gain + rotate_base
+        rotate_base,
+        line_white,  // ラインセンサーの値がこれ以上なら白
+        slew_rate,   // 1秒あたりに変えられるモーターのパワー(0なら制限しない)
+        dead_band,   // 目標のパワーの変化がこれ未満なら無視する
+        count,
+    };
+    const char front_range_name[] PROGMEM = "front_range";
+    const char max_speed_name[] PROGMEM = "max_speed";
+    const char rotate_gain_name[] PROGMEM = "rotate_gain";
+    const char rotate_base_name[] PROGMEM = "rotate_base";
+    const char line_white_name[] PROGMEM = "line_white";
+    const char slew_rate_name[] PROGMEM = "slew_rate";
+    const char dead_band_name[] PROGMEM = "dead_band";
+
+    constexpr robo::ParamDef defs[] PROGMEM = {
+        { front_range_name, 18, 1, 90 },
+        { max_speed_name, 100, 0, 100 },
+        { rotate_gain_name, 25, 0, 100 },
+        { rotate_base_name, 20, 0, 100 },
+        { line_white_name, robo::profile::lines::offense_line_white, 0, 1023 },
+        // 全速の後退から全速の前進まで0.2秒
+        { slew_rate_name, 1000, 0, 10000 },
+        { dead_band_name, 3, 0, 20 },
+    };
+    static_assert(sizeof(defs) / sizeof(defs[0]) == count, "defs must match the enum");
+}
+robo::Params<param::count> params(param::defs);
+robo::ParamConsole console(params, robo::profile::eeprom::params);
+
+// 「正面」の範囲(パラメーターから求める)
+robo::Angle front_range;
+// モーターのパワーの変え方(パラメーターから求める。motorが参照するのでSRAMに置く)
+robo::Motor::Config motor_config = robo::Motor::default_config;
+
+// パラメーターから求める値を作り直す
+void apply_params() {
+    front_range = robo::Angle::from_degrees(params[param::front_range]);
+    motor_config.slew_rate = params[param::slew_rate];
+    motor_config.dead_band = params[param::dead_band];
+}
+// ラインセンサーがすべて黒に戻ってから、ラインを離れ続ける時間(ms)と距離(mm)
+constexpr uint16_t escape_hold_ms = 150;
+constexpr uint16_t escape_hold_mm = 80;
+
+SoftwareSerial motor_ser(robo::profile::motor::rx_pin, robo::profile::motor::tx_pin);
+robo::Motor motor(&motor_ser, motor_config);
 auto_ptr<info::MoveInfo> m_info;
+robo::LineEscape line_escape(escape_hold_ms, escape_hold_mm);
 
 // ラインセンサー群
 namespace lines {
-    robo::LineSensor left(1), right(2), back(3);
+    robo::profile::lines::Left left;
+    robo::profile::lines::Right right;
+    robo::profile::lines::Back back;
 
     /**
      * @brief センサーで読み取った値が白かどうかを判定する
@@ -85,23 +131,206 @@ namespace lines {
      * @return true 白
      * @return false 黒
      */
-    constexpr bool iswhite(uint16_t val) {
-        return val >= 450;
+    bool iswhite(uint16_t val) {
+        return int16_t(val) >= params[param::line_white];
     }
 }
 
 // 超音波センサー群
 namespace uss {
-    robo::USSensor left(1, 2), right(3, 4), back(5, 6);
+    robo::profile::uss::Left left;
+    robo::profile::uss::Right right;
+    robo::profile::uss::Back back;
 }
 
-omv::Reader mv_reader(0x12);
+// 動きの決め方(条件、各状態での動き、状態と遷移の表)
+#include <offense_strategy.h>
+
+omv::Reader mv_reader(robo::profile::openmv_address);
 using FramePtr = auto_ptr<omv::Frame>;
 FramePtr frame;
-robo::BNO055 bno055(0, 0x28);
-robo::LCD lcd(0x27, 16, 2);
+robo::BNO055 bno055(0, robo::profile::bno055_address);
+robo::LCD lcd(robo::profile::lcd_address, robo::profile::lcd_cols, robo::profile::lcd_rows);
+robo::Localizer localizer;
+robo::Kicker kicker;
+
+// 起動に時間のかかるデバイスの起動処理(robo::Bootから呼ぶ)
+namespace startup {
+    const char bno055_name[] PROGMEM = "bno055";
+    const char openmv_name[] PROGMEM = "openmv";
+    const char lcd_name[] PROGMEM = "lcd";
+
+    robo::InitStatus bno055(uint32_t now) { return ::bno055.init_step(now); }
+    robo::InitStatus openmv(uint32_t now) { return mv_reader.init_step(now); }
+    robo::InitStatus lcd(uint32_t now) { return ::lcd.init_step(now); }
+}
+
+// 起動していないデバイスは見つからないときと同じように振る舞うので、起動を待たずに制御を始める
+robo::BootDevice devices[] = {
+    robo::BootDevice(startup::bno055_name, startup::bno055, 1500),
+    // OpenMVはスクリプトが動き出すまで応答しない
+    robo::BootDevice(startup::openmv_name, startup::openmv, 3000),
+    robo::BootDevice(startup::lcd_name, startup::lcd, 500),
+};
+robo::Boot boot(devices);
+
+// 各タスクが更新するセンサーの最新の値
+namespace state {
+    // ラインセンサーが白を読んだかどうか
+    bool w_left = false, w_right = false, w_back = false;
+    // BNO055で取得した現在の方向(方向の定義はrobo2019/README参照)
+    robo::Angle bno_dir;
+    // 止まっているかどうか(IDLEのときtrue。BNO055の較正値はこの間に読む)
+    bool idle = true;
+}
+
+// ラインセンサーの値を取得
+void read_lines(uint32_t) {
+    state::w_left = lines::iswhite(lines::left.read());
+    state::w_right = lines::iswhite(lines::right.read());
+    state::w_back = lines::iswhite(lines::back.read());
+}
+
+// I2Cの通信(robo::I2CBusから1回ずつ呼ぶ)
+namespace transact {
+    // BNO055で現在の方向を取得
+    bool heading(uint32_t) {
+        state::bno_dir = bno055.get_heading();
+        // 較正の状態を読み、較正が終わったら次の起動のためにEEPROMへ保存する(1回に1歩ずつ)
+        bno055.autosave(millis(), state::idle);
+        return false;
+    }
+
+    // OpenMV
+    bool camera(uint32_t) {
+        FramePtr nframe(mv_reader.read_frame());
+        if (nframe) {
+            frame.reset(nframe.release());
+            localizer.update(*frame, state::bno_dir);
+            kicker.observe(frame->ball_pos);
+        } else {
+            localizer.miss();
+        }
+        return false;
+    }
 
-uint8_t frame_count = 0;
+    // LCDに積んだ表示を1文字ずつ送る
+    bool display(uint32_t) {
+        return lcd.send_chunk();
+    }
+}
+
+// I2Cの番号(clientsの添字)
+enum : uint8_t {
+    BUS_HEADING,
+    BUS_CAMERA,
+    BUS_DISPLAY,
+};
+
+// 配列の前にあるほど優先度が高い。LCDへの書き込みは1文字ずつ送るので、読み込みを1文字分しか待たせない
+robo::BusClient clients[] = {
+    // 方向の2バイトと、autosave()の1歩(多くても2バイト)
+    robo::BusClient(transact::heading, 800),
+    robo::BusClient(transact::camera, 1200),
+    // 1文字でI2Cの送信が6回
+    robo::BusClient(transact::display, 1300),
+};
+robo::I2CBus bus(clients);
+// LCDの表示は2行分をまとめて積む
+robo::LCD::Queue lcd_queue;
+
+// BNO055で現在の方向を取得(すぐに読む)
+void read_heading(uint32_t) {
+    bus.request(BUS_HEADING, micros());
+}
+
+// OpenMV(すぐに読む)
+void read_camera(uint32_t) {
+    bus.request(BUS_CAMERA, micros());
+}
+
+// 動きを決めるための材料(Contextはoffense_strategy.hで定義)
+Context ctx;
+
+robo::Strategy<Context> strategy(states, transitions, IDLE);
+
+// 動きを決めてモーターに送る
+void control(uint32_t dt) {
+    const uint32_t now = millis();
+    update_context(ctx, state::w_left, state::w_right, state::w_back, state::bno_dir,
+        frame ? &*frame : NULL, localizer, now);
+    strategy.update(ctx, now);
+    state::idle = strategy.state() == IDLE;
+
+    // モーターの目標のパワーを更新し、経過時間に応じた量だけ近づける
+    if (m_info) m_info->apply(motor);
+    motor.update(dt);
+    // ボールを追っていて正面を向いているときだけキックする
+    kicker.update(now, strategy.state() == CHASE && guard::facing_front(ctx));
+
+    robo::memory::update();
+}
+
+// LCDに状態を表示する
+void display(uint32_t) {
+    char buff[32] = "";
+    omv::Position *ball_pos = frame ? frame->ball_pos : NULL;
+    // 前の表示を送り切っていなければ、古い方を捨てて書き直す
+    lcd.discard_queue();
+    lcd.setCursor(0,0);
+    if (ball_pos != NULL) {
+        lcd.print(robo::printable(*ball_pos));
+    } else {
+        lcd.print(F("no ball"));
+    }
+    // ラインセンサーとBNO055の較正の状態(較正の状態はautosave()が読んだもの)
+    sprintf_P(buff, PSTR("L:%u%u%u "), state::w_left, state::w_right, state::w_back);
+    bno055.calibration_to_string(buff + strlen(buff));
+    lcd.setCursor(0, 1);
+    lcd.print(buff);
+    // 送るのは読み込みの合間(期限は次の表示まで)
+    bus.request(BUS_DISPLAY, micros() + 200000UL);
+}
+
+// ログをとる
+void report(uint32_t);
+
+// シリアルからパラメーターを読み書きする(受け取った文字だけを読むので待たない)
+void tune(uint32_t) {
+    if (console.poll(Serial)) apply_params();
+}
+
+// 配列の前にあるほど優先度が高い
+robo::Task tasks[] = {
+    robo::Task(read_lines, 200),
+    // BNO055のフュージョン出力は100Hzで更新される
+    robo::Task(read_heading, 100),
+    robo::Task(control, 200),
+    // OpenMVは60fps程度
+    robo::Task(read_camera, 60),
+    robo::Task(display, 5),
+    robo::Task(report, 1),
+    robo::Task(tune, 10),
+};
+robo::Scheduler scheduler(tasks);
+
+void report(uint32_t) {
+    char buff[64] = "";
+    Serial.print(F("state: "));
+    Serial.println(strategy.state());
+    if (m_info) Serial.print(*m_info);
+    Serial.println();
+    const robo::Localizer::Pose &pose = localizer.pose();
+    sprintf_P(buff, PSTR("pose: (%d, %d), goals: %u, age: %u"), pose.x, pose.y, pose.goals, pose.age);
+    Serial.println(buff);
+    sprintf_P(buff, PSTR("kicker: possession: %u, kicks: %u"), kicker.possession(), kicker.kicks());
+    Serial.println(buff);
+    sprintf_P(buff, PSTR("openmv: %u.%u fps"), mv_reader.fps10() / 10, mv_reader.fps10() % 10);
+    Serial.println(buff);
+    robo::memory::print_info(Serial);
+    scheduler.print_stats(Serial);
+    bus.print_stats(Serial);
+}
 
 void setup() {
     uss::left.setup();
@@ -112,119 +341,30 @@ void setup() {
     lines::right.setup();
     lines::back.setup();
 
-    mv_reader.setup();
+    kicker.setup();
 
-    bno055.setup();
-
-    motor_ser.begin(19200);
+    motor_ser.begin(robo::profile::motor::baud);
     motor.stop();
-    Serial.begin(19200);
+    Serial.begin(115200);
     m_info.reset(new info::Stop());
 
-    lcd.setup();
-}
-
-void loop() {
-    // ラインセンサーの値を取得
-    #define L_BIND(_name_) w_ ## _name_ = lines::iswhite(lines::_name_.read())
-    const bool L_BIND(left), L_BIND(right), L_BIND(back);
-    #undef L_BIND
-    const bool on_line = w_left || w_right || w_back;
-
-    // OpenMV
-    FramePtr nframe(mv_reader.read_frame());
-    if (nframe) frame.reset(nframe.release());
-    // エイリアス
-    using PosPtr = omv::Position *;
-    // ボールの座標(OpenMVが見つけていなかったらNULL)
-    PosPtr ball_pos = frame ? frame->ball_pos : NULL;
-    //　黄色のゴールの座標
-    PosPtr y_goal_pos = frame ? frame->y_goal_pos : NULL;
-    // 黄色のゴールの方向(10はとにかく大きい値というだけで深い意味なし)
-    float y_goal_dir = y_goal_pos ? omv::pos2dir(*y_goal_pos) : 10;
-
-    // BNO055で現在の方向を取得(方向の定義はrobo2019/README参照)
-    float bno_dir = bno055.get_geomag_direction();
-
-    // ラインセンサー処理(アウトオブバウンズ対策)
-    if (on_line) { // 線を踏んだ
-        float d = 0.0;
-        if (abs(y_goal_dir) < front_range) {
-            // ゴールが前にある => 前にペナルティエリアがある
-            d = PI;
-        } else {
-            // ペナルティエリア以外
-            //#define USE_USS
-            #ifdef USE_USS
-            #define BIND(_name_) e_ ## _name_ = uss::_name_.read()
-            uint16_t BIND(left), BIND(right), BIND(back);
-            #undef BIND
-            d = (e_back < e_right && e_back < e_left)
-                ? 0.0 // 後ろの壁が一番近い => 前に進む
-                : e_left < e_right ? -HPI : HPI; // 左の方が近い ? 右に進む : 左に進む
-            #else /* USE_USS */
-            d = w_left == w_right
-            ? (w_back ? 0.0 : PI) // 左と右どちらも同じ色 => 後ろのラインセンサーに応じて決定
-            : (w_left ? -HPI : HPI); // 左右で色が違う => 左が白 ? 右に進む : 左に進む
-            #endif /* USE_USS */
-        }
-        m_info.reset(new info::Translate(
-            robo::V2_float::from_polar_coord(d, max_speed)
-        ));
-        goto MOTOR;
-    }
-
-    // 姿勢制御
-    BNO: {
-        float adir = abs(bno_dir);
-        // 左右どちらかわからないが、正面を向いていない
-        if (adir > front_range) {
-            m_info.reset(new info::Rotate(bno_dir > 0, int8_t(adir * 25 + 20)));
-            // (adir - 0) / (PI - 0) * (100 - 20) + 20
-            // -> adir * 25 + 40
-            goto MOTOR;
-        }
-    }
+    // EEPROMに保存したパラメーターがあれば使う
+    params.load(robo::profile::eeprom::params);
+    apply_params();
 
-    // ボールを追う
-    BALL:
-    if (ball_pos != NULL) {
-        float ball_dir = omv::pos2dir(*ball_pos);
-        m_info.reset(new info::Translate(
-            // ボールの角度から3/2倍した方向に動いて回り込みを実現
-            robo::V2_float::from_polar_coord(ball_dir * 3 /2 , max_speed)
-        ));
-        goto MOTOR;
-    }
+    // LCDへの書き込みはキューに積み、busから少しずつ送る
+    lcd.set_queue(&lcd_queue);
 
-    // 何もすることがないため停止
-    m_info.reset(new info::Stop());
+    // BNO055, OpenMV, LCDはloop()の中で起動を進める
+    boot.start(millis());
 
-    // モーターのパワーを更新
-    MOTOR: {
-        if (m_info) m_info->apply(motor);
-    }
+    scheduler.setup();
+}
 
-    // ログをとる
-    LOG:
-    if (++frame_count == 10) {
-        //lcd.clear();
-        char buff[128] = "";
-        if (ball_pos != NULL) {
-            ball_pos->to_string(buff);
-        } else {
-            strcat_P(buff, PSTR("no ball"));
-        }
-        lcd.setCursor(0,0);
-        lcd.print(buff);
-        sprintf_P(buff, PSTR("l:%u,r:%u,b:%u"), w_left, w_right, w_back);
-        lcd.setCursor(0, 1);
-        lcd.print(buff);
-        buff[0] = '\0';
-        if (m_info) {
-            m_info->to_string(buff);
-        }
-        Serial.println(buff);
-        frame_count = 0;
-    }
+void loop() {
+    // 起動が終わったら、デバイスごとの起動にかかった時間を1度だけ出力する
+    if (!boot.done() && boot.poll(millis())) boot.print_report(Serial);
+    // I2Cの通信を1回分だけ進めてから、タスクを1つ動かす
+    bus.poll(micros());
+    scheduler.run();
 }
@@ -0,0 +1,336 @@
+#include <avr/sleep.h>
+#include <robo2019.h>
+
+// ATmega328P(Arduino Uno)用のベンチマーク
+// Timer1をプリスケーラ1で動かし、処理にかかったサイクル数をそのまま数える。
+// 実機でもsimavrでも動き、結果はシリアルに1行ずつ次の形式で出力する。
+//   bench,<名前>,<サイクル数>
+//   mem,<項目>,<バイト数>
+//   done
+// extras/avr_bench.pyで実行するとJSONにまとめられる。
+
+namespace omv {
+    using namespace robo::openmv;
+}
+namespace info {
+    using namespace robo::move_info;
+}
+
+// 書き込まれた文字を捨てるだけのPrint(MCB, LCDの代わり)
+class NullPrint : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t *, size_t size) override { return size; }
+};
+
+NullPrint null_port;
+robo::Motor motor(&null_port);
+
+// 最適化で処理が消えないようにするための変数
+volatile float sink_f;
+volatile int8_t src_power = 40;
+volatile float src_x = 12.5, src_y = -7.25, src_deg = 270.5;
+
+// OpenMVから送られてくるデータの例。ボール(100, 40), 黄色のゴール(80, 10), 青色のゴールなし, 60.0fps
+uint8_t sample_frame[omv::Reader::frame_size] = {
+    100, 0, 40, 0,
+    80, 0, 10, 0,
+    0xff, 0xff, 0xff, 0xff,
+    600 & 0xff, 600 >> 8
+};
+
+volatile uint16_t t1_overflows;
+ISR(TIMER1_OVF_vect) { ++t1_overflows; }
+
+uint8_t timsk0_backup;
+
+void cycles_start()
+{
+    // millis()の割り込みが計測に混ざらないよう止める
+    timsk0_backup = TIMSK0;
+    TIMSK0 = 0;
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    t1_overflows = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    TCCR1B = _BV(CS10);
+}
+
+uint32_t cycles_stop()
+{
+    TCCR1B = 0;
+    uint16_t low = TCNT1;
+    if (TIFR1 & _BV(TOV1)) {
+        ++t1_overflows;
+        TIFR1 = _BV(TOV1);
+    }
+    TIMSK1 = 0;
+    TIMSK0 = timsk0_backup;
+    return (uint32_t(t1_overflows) << 16) | low;
+}
+
+uint32_t overhead = 0;
+
+void report(const __FlashStringHelper *kind, const __FlashStringHelper *name, uint32_t value)
+{
+    Serial.print(kind);
+    Serial.print(',');
+    Serial.print(name);
+    Serial.print(',');
+    Serial.println(value);
+    Serial.flush();
+}
+
+#define BENCH(_name_, ...) do {                 \
+    cycles_start();                             \
+    __VA_ARGS__;                                \
+    uint32_t c = cycles_stop();                 \
+    report(F("bench"), F(_name_), c - overhead); \
+} while (0)
+
+// offense_strategy.hが使うもの(offense.inoのパラメーターの初期値)
+namespace param {
+    enum : uint8_t {
+        max_speed,
+        rotate_gain,
+        rotate_base,
+        count,
+    };
+}
+int16_t params[param::count] = { 100, 25, 20 };
+robo::Angle front_range = robo::Angle::from_degrees(18);
+robo::LineEscape line_escape(150, 80);
+
+// offense.inoのauto_ptrの代わり(最後に決めた動きを持つ)
+struct MoveHolder {
+    info::MoveInfo *ptr = NULL;
+    void reset(info::MoveInfo *p)
+    {
+        if (ptr != NULL) delete ptr;
+        ptr = p;
+    }
+    operator bool() const { return ptr != NULL; }
+    info::MoveInfo *operator->() { return ptr; }
+} m_info;
+
+#include <offense_strategy.h>
+
+// offense.inoのread_camera()とcontrol()と同じ処理(キッカーとメモリーの監視は除く)。MCBはnull_port
+namespace offense {
+    // offense.inoのslew_rateとdead_bandの初期値
+    const robo::Motor::Config motor_config = { 1000, 3 };
+    robo::Motor motor(&null_port, motor_config);
+    robo::Localizer localizer;
+    omv::Frame *frame = NULL;
+    Context ctx;
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+
+    // フィールドの中央でボール(100, 40)が見えているフレーム。黄色のゴール(90, 20), 青色のゴール(90, 120), 60.0fps
+    uint8_t field_frame[omv::Reader::frame_size] = {
+        100, 0, 40, 0,
+        90, 0, 20, 0,
+        90, 0, 120, 0,
+        600 & 0xff, 600 >> 8
+    };
+
+    void camera(robo::Angle bno_dir)
+    {
+        omv::Frame *nframe = omv::Reader::decode_frame(field_frame);
+        if (nframe != NULL) {
+            if (frame != NULL) delete frame;
+            frame = nframe;
+            localizer.update(*frame, bno_dir);
+        } else {
+            localizer.miss();
+        }
+    }
+
+    //! 制御の周期(200Hz)ごとの処理。状態に応じた動きを決め、モーターに送る
+    void control(bool w_left, bool w_right, bool w_back, robo::Angle bno_dir, uint32_t now)
+    {
+        update_context(ctx, w_left, w_right, w_back, bno_dir, frame, localizer, now);
+        strategy.update(ctx, now);
+        if (m_info) m_info->apply(motor);
+        motor.update(5000);
+    }
+
+    //! 止まった状態から始め直す
+    void reset()
+    {
+        m_info.reset(new info::Stop());
+        motor.stop();
+        line_escape.reset();
+        strategy.reset();
+        ctx = Context();
+    }
+}
+
+// 移植前のdefence.inoのmotor_ctrl()と同じ処理(Stringでコマンドを作る)
+namespace defence_legacy {
+    uint8_t m[4];
+    uint8_t m_power[4];
+    const String Direction[] = {"F", "R"};
+    const uint8_t motor_pin[] = {1, 2, 4, 3};
+
+    void motor_ctrl() {
+        for (uint8_t i = 0; i < 4; i++) {
+            String d = Direction[m[i]];
+            String p = "0" + String(m_power[i]);
+            if (p.length() == 2) {
+                p = "0" + p;
+            }
+            null_port.println(String(motor_pin[i] + d + p));
+        }
+    }
+
+    // 左に平行移動(パワー30)
+    void move_left(uint8_t power) {
+        m[0] = 1; m[1] = 0; m[2] = 0; m[3] = 1;
+        m_power[0] = m_power[1] = m_power[2] = m_power[3] = power;
+        motor_ctrl();
+    }
+}
+
+void report_memory()
+{
+    extern char __data_start, __data_end, __bss_start, __bss_end, __heap_start;
+    extern char *__brkval;
+    report(F("mem"), F("data"), &__data_end - &__data_start);
+    report(F("mem"), F("bss"), &__bss_end - &__bss_start);
+    report(F("mem"), F("heap"), __brkval == NULL ? 0 : __brkval - &__heap_start);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    // 計測処理そのもののサイクル数を差し引く
+    cycles_start();
+    overhead = cycles_stop();
+
+    // volatileの値はあらかじめ読み込んでおく
+    const float x = src_x, y = src_y, deg = src_deg;
+    const int8_t power = src_power;
+
+    robo::V2_float v(x, y);
+    BENCH("vec2d_from_polar_coord", sink_f = robo::V2_float::from_polar_coord(x, y).x);
+    BENCH("vec2d_angle", sink_f = v.angle());
+    BENCH("vec2d_mag", sink_f = v.mag());
+    {
+        namespace fm = robo::fastmath;
+        const int16_t ix = int16_t(x * 8), iy = int16_t(y * 8);
+        float sn, cs;
+        BENCH("fastmath_atan2_exact", sink_f = fm::atan2<fm::exact>(y, x));
+        BENCH("fastmath_atan2_precise", sink_f = fm::atan2<fm::precise>(y, x));
+        BENCH("fastmath_atan2_fast", sink_f = fm::atan2<fm::fast>(y, x));
+        BENCH("fastmath_hypot_exact", sink_f = fm::hypot<fm::exact>(x, y));
+        BENCH("fastmath_hypot_precise", sink_f = fm::hypot<fm::precise>(x, y));
+        BENCH("fastmath_hypot_fast", sink_f = fm::hypot<fm::fast>(x, y));
+        BENCH("fastmath_sincos_exact", (fm::sincos<fm::exact>(x, sn, cs), sink_f = sn + cs));
+        BENCH("fastmath_sincos_precise", (fm::sincos<fm::precise>(x, sn, cs), sink_f = sn + cs));
+        BENCH("fastmath_iatan2_precise", sink_f = fm::iatan2<fm::precise>(iy, ix).raw());
+        BENCH("fastmath_iatan2_fast", sink_f = fm::iatan2<fm::fast>(iy, ix).raw());
+        BENCH("fastmath_ihypot_precise", sink_f = fm::ihypot<fm::precise>(ix, iy));
+        BENCH("fastmath_ihypot_fast", sink_f = fm::ihypot<fm::fast>(ix, iy));
+    }
+    const robo::Angle a = robo::Angle::from_radians(x);
+    BENCH("vec2d_from_polar_coord_angle", sink_f = robo::V2_float::from_polar_coord(a, y).x);
+    {
+        const robo::V2_q8_8 q(x, y);
+        const robo::Q8_8 k = y;
+        BENCH("vec2d_q8_8_from_polar_coord", sink_f = robo::V2_q8_8::from_polar_coord(a, k).x.raw());
+        BENCH("vec2d_q8_8_scale", sink_f = (q * k).x.raw());
+        BENCH("vec2d_q8_8_direction", sink_f = q.direction().raw());
+    }
+    BENCH("angle_from_radians", sink_f = robo::Angle::from_radians(x).raw());
+    BENCH("angle_sin", sink_f = a.sin());
+    BENCH("angle_within", sink_f = a.within(robo::Angle::from_degrees(15)));
+    BENCH("vec2d_dot", sink_f = v.dot(y, x));
+    {
+        char buff[32];
+        BENCH("vec2d_to_string", v.to_string(buff));
+    }
+    BENCH("vec2d_print", null_port.print(robo::printable(v)));
+
+    BENCH("motor_set_all_motors", motor.set_all_motors(power, -power, power, -power));
+    BENCH("motor_set_all_motors_nochange", motor.set_all_motors(power, -power, power, -power));
+    BENCH("motor_set_all_motors_maximize", motor.set_all_motors(-power, power, 10, 0, true));
+    BENCH("motor_set_dir_and_speed", motor.set_dir_and_speed(x, power));
+    BENCH("motor_set_dir_and_speed_angle", motor.set_dir_and_speed(a, power + 1));
+    BENCH("motor_print", null_port.print(motor));
+
+    BENCH("openmv_decode_frame", delete omv::Reader::decode_frame(sample_frame));
+    omv::Position ball(sample_frame[0], sample_frame[2]);
+    BENCH("openmv_pos2dir", sink_f = omv::pos2dir(ball));
+    BENCH("openmv_pos2angle", sink_f = omv::pos2angle(ball).raw());
+    BENCH("orbit_polar", sink_f = robo::V2_float::from_polar_coord(omv::pos2dir(ball) * 3 / 2, power).x);
+    BENCH("orbit_lookup", sink_f = robo::orbit::lookup(ball).to_vec().x);
+    {
+        robo::Localizer localizer;
+        omv::Position y_goal(sample_frame[4], sample_frame[6]);
+        omv::Position b_goal(180 - y_goal.x, 140 - y_goal.y);
+        BENCH("localizer_update_one", localizer.update(&y_goal, NULL, robo::Angle::from_radians(deg)));
+        BENCH("localizer_update_both", localizer.update(&y_goal, &b_goal, robo::Angle::from_radians(deg)));
+    }
+
+    BENCH("bno055_euler_to_direction", sink_f = robo::BNO055::euler_to_direction(deg));
+    BENCH("bno055_euler_to_angle", sink_f = robo::BNO055::euler_to_angle(int16_t(deg * 16)).raw());
+
+    // defence: 移植前(String)とGoalie(スタック上のバッファ)の比較
+    // 毎回出力されるように、パワーを変えながら計測する
+    {
+        extern char *__brkval;
+        extern char __heap_start;
+        const char *heap_before = __brkval == NULL ? &__heap_start : __brkval;
+        BENCH("defence_legacy_move", defence_legacy::move_left(power));
+        BENCH("defence_legacy_move_again", defence_legacy::move_left(power + 1));
+        const char *heap_after = __brkval == NULL ? &__heap_start : __brkval;
+        report(F("mem"), F("defence_legacy_heap"), heap_after - heap_before);
+
+        robo::Goalie goalie(motor);
+        omv::FrameData frame;
+        heap_before = heap_after;
+        BENCH("defence_goalie_move", goalie.move(robo::Goalie::left, power));
+        BENCH("defence_goalie_move_again", goalie.move(robo::Goalie::left, power + 1));
+        BENCH("openmv_decode_frame_data", omv::Reader::decode_frame(sample_frame, frame));
+        BENCH("defence_goalie_update", goalie.update(robo::Angle(), false, false, false, frame, 0));
+
+        robo::Interceptor interceptor;
+        interceptor.update(&ball, 0);
+        omv::Position moved(ball.x - 2, ball.y + 3);
+        BENCH("intercept_update", interceptor.update(&moved, 33));
+        heap_after = __brkval == NULL ? &__heap_start : __brkval;
+        report(F("mem"), F("defence_goalie_heap"), heap_after - heap_before);
+    }
+
+    // 1回目は状態に入る処理とヒープの確保が入るので、同じ状態での2回目を計測する
+    {
+        const robo::Angle facing = robo::Angle::from_degrees(deg);
+        offense::camera(robo::Angle());
+        BENCH("offense_camera", offense::camera(robo::Angle()));
+
+        offense::reset();
+        offense::control(false, false, false, facing, 0);
+        BENCH("offense_control_rotate", offense::control(false, false, false, facing, 5));
+        offense::reset();
+        offense::control(false, false, false, robo::Angle(), 0);
+        BENCH("offense_control_chase", offense::control(false, false, false, robo::Angle(), 5));
+        offense::reset();
+        offense::control(true, false, false, robo::Angle(), 0);
+        BENCH("offense_control_line", offense::control(true, false, false, robo::Angle(), 5));
+    }
+
+    report_memory();
+    Serial.println(F("done"));
+    Serial.flush();
+
+    // simavrは割り込み禁止のままスリープすると終了する
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    cli();
+    sleep_cpu();
+}
+
+void loop() {}
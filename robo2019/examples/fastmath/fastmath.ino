@@ -0,0 +1,84 @@
+#include <robo2019.h>
+
+// robo::fastmathの精度の確認
+// 各関数・各精度について、libmとの差の最大値をシリアルに1行ずつ次の形式で出力する。
+//   fastmath,<関数>,<精度>,<最大の誤差>
+// atan2とsincosはラジアンの絶対誤差、hypotは相対誤差。
+// センサーもモーターも使わないので、実機でもsimavrでも動く。
+
+namespace fm {
+    using namespace robo::fastmath;
+}
+
+// 調べる点の数(円周上に等間隔)
+constexpr uint16_t steps = 720;
+// 調べる円の半径(画像の座標やフィールドの座標の大きさに合わせる)
+const int16_t radii[] PROGMEM = { 3, 20, 70, 300, 1500 };
+
+// 角度の差(-PI..PI)
+float angle_error(float a, float b)
+{
+    float d = a - b;
+    while (d > PI) d -= 2 * PI;
+    while (d < -PI) d += 2 * PI;
+    return fabs(d);
+}
+
+void report(const __FlashStringHelper *func, const __FlashStringHelper *accuracy, float error)
+{
+    Serial.print(F("fastmath,"));
+    Serial.print(func);
+    Serial.print(',');
+    Serial.print(accuracy);
+    Serial.print(',');
+    Serial.println(error, 6);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    float atan2_precise = 0, atan2_fast = 0, hypot_precise = 0, hypot_fast = 0;
+    float iatan2_precise = 0, iatan2_fast = 0, ihypot_precise = 0, ihypot_fast = 0;
+    float sincos_precise = 0;
+    for (uint8_t r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+        const int16_t radius = pgm_read_word(&radii[r]);
+        for (uint16_t i = 0; i < steps; i++) {
+            const float rad = 2 * PI * i / steps - PI;
+            const float x = radius * cos(rad), y = radius * sin(rad);
+            const int16_t ix = int16_t(round(x)), iy = int16_t(round(y));
+            const float exact_dir = atan2(y, x), exact_mag = hypot(x, y);
+            const float exact_idir = atan2(float(iy), float(ix)), exact_imag = hypot(float(ix), float(iy));
+
+            atan2_precise = max(atan2_precise, angle_error(fm::atan2<fm::precise>(y, x), exact_dir));
+            atan2_fast = max(atan2_fast, angle_error(fm::atan2<fm::fast>(y, x), exact_dir));
+            hypot_precise = max(hypot_precise, fabs(fm::hypot<fm::precise>(x, y) - exact_mag) / exact_mag);
+            hypot_fast = max(hypot_fast, fabs(fm::hypot<fm::fast>(x, y) - exact_mag) / exact_mag);
+            if (ix != 0 || iy != 0) {
+                iatan2_precise = max(iatan2_precise,
+                    angle_error(fm::iatan2<fm::precise>(iy, ix).to_radians(), exact_idir));
+                iatan2_fast = max(iatan2_fast, angle_error(fm::iatan2<fm::fast>(iy, ix).to_radians(), exact_idir));
+                // 整数の切り捨ての分(1未満)は誤差に含めない
+                ihypot_precise = max(ihypot_precise,
+                    max(0.0f, fabs(fm::ihypot<fm::precise>(ix, iy) - exact_imag) - 1) / exact_imag);
+                ihypot_fast = max(ihypot_fast,
+                    max(0.0f, fabs(fm::ihypot<fm::fast>(ix, iy) - exact_imag) - 1) / exact_imag);
+            }
+            float s, c;
+            fm::sincos<fm::precise>(rad, s, c);
+            sincos_precise = max(sincos_precise, max(fabs(s - sin(rad)), fabs(c - cos(rad))));
+        }
+    }
+    report(F("atan2"), F("precise"), atan2_precise);
+    report(F("atan2"), F("fast"), atan2_fast);
+    report(F("hypot"), F("precise"), hypot_precise);
+    report(F("hypot"), F("fast"), hypot_fast);
+    report(F("sincos"), F("precise"), sincos_precise);
+    report(F("iatan2"), F("precise"), iatan2_precise);
+    report(F("iatan2"), F("fast"), iatan2_fast);
+    report(F("ihypot"), F("precise"), ihypot_precise);
+    report(F("ihypot"), F("fast"), ihypot_fast);
+    Serial.flush();
+}
+
+void loop() {}
@@ -0,0 +1,116 @@
+#include <robo2019.h>
+
+// robo::Interceptorのシナリオ再生
+// いろいろな速さ・角度のシュートを画像上で再現し、ボールが守備ラインに届いたときに
+// 機体の正面からどれだけずれていたかを、移植前のdefence.inoの動き(正面73-87に入るまで横移動)と比べる。
+// センサーもモーターも使わないので、実機でもsimavrでも動く。結果はシリアルに1行ずつ次の形式で出力する。
+//   shot,<速さ(px/s)>,<始点x>,<終点x>,<予測x>,<Interceptorのずれ(px)>,<移植前のずれ(px)>
+//   total,<Interceptorで止めた数>,<移植前で止めた数>,<シュートの数>
+
+namespace omv {
+    using namespace robo::openmv;
+}
+
+// ボールのy座標の始点
+constexpr float start_y = 10;
+// 1周期の長さ(ミリ秒)
+constexpr uint16_t loop_ms = 10;
+// カメラのフレームの間隔(ミリ秒)
+constexpr uint16_t frame_ms = 33;
+// パワー1あたりの横移動の速さ(px/s)。Interceptor::Config::full_speedと合わせてある
+constexpr float px_per_power = 1.5;
+// 機体の正面からこの範囲(px)でボールが守備ラインに届いたら止めたとする
+constexpr float catch_px = 10;
+
+struct Shot {
+    int16_t speed; // px/s
+    int16_t from_x;
+    int16_t to_x;
+};
+
+const Shot shots[] PROGMEM = {
+    {  60,  80,  80 },
+    {  60,  40, 110 },
+    { 120, 120,  50 },
+    { 120,  60, 100 },
+    { 240,  30, 100 },
+    { 240, 130,  60 },
+    { 480,  50, 110 },
+    { 480, 110,  45 },
+};
+
+// 移植前のdefence.inoと同じ横移動のパワー
+int8_t legacy_power(const omv::Position *ball)
+{
+    if (ball == NULL) return 0;
+    if (ball->x >= 73 && ball->x <= 87) return 0;
+    const int8_t p = constrain(abs(int16_t(ball->x) - 80) * 3, 20, 40);
+    return ball->x > 87 ? p : -p;
+}
+
+// シュートを1本再生し、ボールが守備ラインに届いたときの機体の正面からのずれ(px)を返す
+int16_t replay(const Shot &shot, bool legacy, int16_t &predicted)
+{
+    const robo::Interceptor::Config &config = robo::Interceptor::default_config;
+    robo::Interceptor interceptor;
+    const float guard_y = config.guard_y;
+    const float duration = (guard_y - start_y) / shot.speed;
+    const float vx = (shot.to_x - shot.from_x) / duration;
+    float robot = 0; // 機体が左に動いた距離(px)
+    float power = 0;
+    omv::Position ball;
+    bool seen = false;
+    predicted = config.center_x;
+    for (uint32_t t = 0;; t += loop_ms) {
+        const float sec = t / 1000.0f;
+        const float bx = shot.from_x + vx * sec, by = start_y + shot.speed * sec;
+        if (by >= guard_y) {
+            // 機体が左に動くと、画像上のボールは右(xが小さい方)にずれる
+            return int16_t(bx - robot - config.center_x);
+        }
+        if (t % frame_ms < loop_ms) {
+            ball.x = uint16_t(bx - robot + 0.5f);
+            ball.y = uint16_t(by + 0.5f);
+            seen = true;
+        }
+        const omv::Position *pos = seen ? &ball : NULL;
+        if (legacy) {
+            power = legacy_power(pos);
+        } else {
+            power = interceptor.update(pos, t);
+            predicted = interceptor.target() + int16_t(robot);
+        }
+        robot += power * px_per_power * loop_ms / 1000;
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    uint8_t saved = 0, saved_legacy = 0;
+    const uint8_t count = sizeof(shots) / sizeof(shots[0]);
+    for (uint8_t i = 0; i < count; i++) {
+        Shot shot;
+        memcpy_P(&shot, &shots[i], sizeof(Shot));
+        int16_t predicted, unused;
+        const int16_t offset = replay(shot, false, predicted);
+        const int16_t offset_legacy = replay(shot, true, unused);
+        saved += abs(offset) <= catch_px;
+        saved_legacy += abs(offset_legacy) <= catch_px;
+
+        char buff[64];
+        sprintf_P(buff, PSTR("shot,%d,%d,%d,%d,%d,%d"), shot.speed, shot.from_x, shot.to_x, predicted,
+            offset, offset_legacy);
+        Serial.println(buff);
+    }
+    Serial.print(F("total,"));
+    Serial.print(saved);
+    Serial.print(',');
+    Serial.print(saved_legacy);
+    Serial.print(',');
+    Serial.println(count);
+    Serial.flush();
+}
+
+void loop() {}
@@ -0,0 +1,438 @@
+#include <avr/sleep.h>
+#include <robo2019.h>
+
+// センサーへの入力からMCBへのコマンドが出きるまでの遅延を計測するスケッチ
+// OpenMV, BNO055, ラインセンサー, LCD, MCBを仮想デバイスに置き換え、
+// 通信にかかる時間はビジーウェイトで再現する。実機でもsimavrでも動く。
+// シナリオごとに刺激を入れるタイミングをずらしながら何度も計測し、次の形式で出力する。
+//   latency,<シナリオ名>,<p50[us]>,<p99[us]>,<最大[us]>,<反応しなかった回数>
+//   done
+// extras/avr_bench.py --sketch examples/latency で実行するとJSONにまとめられる。
+
+namespace omv {
+    using namespace robo::openmv;
+}
+namespace info {
+    using namespace robo::move_info;
+}
+
+//! 仮想デバイスが返す、ある時点での周囲の状態
+struct World {
+    bool ball;
+    uint16_t ball_x, ball_y;
+    uint16_t y_goal_x, y_goal_y;
+    uint16_t b_goal_x, b_goal_y;
+    //! BNO055のオイラー角のx成分(度数法)
+    float euler_x;
+    uint16_t line_left, line_right, line_back;
+};
+
+// 仮想デバイスのタイミング(マイクロ秒)
+namespace timing {
+    //! OpenMVのフレーム周期(約60fps)。撮影からI2Cで渡せるようになるまでにも同じだけかかるものとする
+    constexpr uint32_t camera_period = 16667;
+    //! 100kHzのI2Cでアドレス+14バイトを読み、1バイトを書く時間
+    constexpr uint16_t camera_read = 1440 + 180;
+    //! BNO055のオイラー角のx成分(2バイト)を読む時間
+    constexpr uint16_t bno_read = 450;
+    //! analogRead 1回分
+    constexpr uint16_t analog_read = 112;
+    //! I2C接続のLCDに1文字書く時間
+    constexpr uint16_t lcd_char = 1200;
+    //! 19200bpsのSoftwareSerialで1バイト送る時間
+    constexpr uint16_t mcb_byte = 521;
+}
+
+// 仮想の世界。stim_atを過ぎるとbeforeからafterに切り替わる
+namespace sim {
+    World before, after;
+    uint32_t t0, stim_at, camera_phase;
+
+    uint32_t now() { return micros() - t0; }
+    const World &world_at(uint32_t t) { return t >= stim_at ? after : before; }
+    const World &world() { return world_at(now()); }
+
+    //! OpenMVがいまI2Cで渡せるフレームを撮影した時刻
+    uint32_t camera_capture_time()
+    {
+        uint32_t t = now() + camera_phase;
+        if (t < 2 * timing::camera_period) return 0;
+        return (t / timing::camera_period - 1) * timing::camera_period - camera_phase;
+    }
+}
+
+//! 仮想OpenMV。フレームのデータをI2Cで受け取ったのと同じバイト列にする
+void virtual_openmv(uint8_t (&data)[omv::Reader::frame_size])
+{
+    delayMicroseconds(timing::camera_read);
+    const World &w = sim::world_at(sim::camera_capture_time());
+    uint16_t vals[7] = {
+        w.ball ? w.ball_x : uint16_t(0xffff), w.ball ? w.ball_y : uint16_t(0xffff),
+        w.y_goal_x, w.y_goal_y, w.b_goal_x, w.b_goal_y,
+        uint16_t(10000000UL / timing::camera_period)
+    };
+    for (uint8_t i = 0; i < 7; i++) {
+        data[2 * i] = vals[i] & 0xff;
+        data[2 * i + 1] = vals[i] >> 8;
+    }
+}
+
+//! 仮想BNO055。オイラー角のx成分のレジスタ(1/16度)を読むのと同じにする
+robo::Angle virtual_heading()
+{
+    delayMicroseconds(timing::bno_read);
+    return robo::BNO055::euler_to_angle(int16_t(sim::world().euler_x * 16));
+}
+
+uint16_t virtual_analog(uint8_t pin)
+{
+    delayMicroseconds(timing::analog_read);
+    const World &w = sim::world();
+    return pin == 1 ? w.line_left : pin == 2 ? w.line_right : w.line_back;
+}
+
+//! 仮想LCD。文字を捨てるが、I2Cで送るのと同じだけ時間をかける
+class VirtualLCD : public Print {
+public:
+    size_t write(uint8_t) override
+    {
+        delayMicroseconds(timing::lcd_char);
+        return 1;
+    }
+    void setCursor(uint8_t, uint8_t) { write(0); }
+};
+
+/**
+ * @brief 仮想MCB
+ * @details 受け取ったコマンドを解読してモーターのパワーを再現し、
+ *  計測中にパワーが変化したら、そのコマンドの最後のバイトが送られた時刻を記録する
+ */
+class VirtualMCB : public Print {
+private:
+    char _line[8];
+    uint8_t _len = 0;
+
+public:
+    int8_t powers[4] = {0, 0, 0, 0};
+    int8_t baseline[4];
+    bool armed = false;
+    uint32_t reacted_at;
+
+    size_t write(uint8_t c) override
+    {
+        delayMicroseconds(timing::mcb_byte);
+        if (c == '\r') return 1;
+        if (c != '\n') {
+            if (_len < sizeof(_line)) _line[_len++] = c;
+            return 1;
+        }
+        // "<pin><F|R><power:3桁>"
+        if (_len == 5 && '1' <= _line[0] && _line[0] <= '4') {
+            int8_t p = (_line[2] - '0') * 100 + (_line[3] - '0') * 10 + (_line[4] - '0');
+            powers[_line[0] - '1'] = _line[1] == 'F' ? -p : p;
+        }
+        _len = 0;
+        if (armed && sim::now() >= sim::stim_at && memcmp(powers, baseline, 4) != 0) {
+            reacted_at = sim::now();
+            armed = false;
+        }
+        return 1;
+    }
+
+    void arm()
+    {
+        memcpy(baseline, powers, 4);
+        armed = true;
+    }
+};
+
+VirtualLCD lcd;
+VirtualMCB mcb;
+
+// offense_strategy.hが使うもの(offense.inoのパラメーターの初期値)
+namespace param {
+    enum : uint8_t {
+        max_speed,
+        rotate_gain,
+        rotate_base,
+        count,
+    };
+}
+int16_t params[param::count] = { 100, 25, 20 };
+robo::Angle front_range = robo::Angle::from_degrees(18);
+robo::LineEscape line_escape(150, 80);
+
+// offense.inoのauto_ptrの代わり(最後に決めた動きを持つ)
+struct MoveHolder {
+    info::MoveInfo *ptr = NULL;
+    void reset(info::MoveInfo *p)
+    {
+        if (ptr != NULL) delete ptr;
+        ptr = p;
+    }
+    operator bool() const { return ptr != NULL; }
+    info::MoveInfo *operator->() { return ptr; }
+} m_info;
+
+#include <offense_strategy.h>
+
+// offense.inoと同じタスクとI2Cの通信で、offense_strategy.hの表を動かす(シリアルへのログとキッカーは除く)
+namespace offense {
+    // offense.inoのslew_rateとdead_bandの初期値
+    const robo::Motor::Config motor_config = { 1000, 3 };
+    robo::Motor motor(&mcb, motor_config);
+    robo::Localizer *localizer = NULL;
+    omv::Frame *frame = NULL;
+    Context ctx;
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+    bool w_left, w_right, w_back;
+    robo::Angle bno_dir;
+    // LCDに送る2行分の文字と、送った文字数
+    char lcd_buff[40];
+    uint8_t lcd_len = 0, lcd_sent = 0;
+
+    void read_lines(uint32_t)
+    {
+        w_left = virtual_analog(1) >= robo::profile::lines::offense_line_white;
+        w_right = virtual_analog(2) >= robo::profile::lines::offense_line_white;
+        w_back = virtual_analog(3) >= robo::profile::lines::offense_line_white;
+    }
+
+    bool heading(uint32_t)
+    {
+        bno_dir = virtual_heading();
+        return false;
+    }
+
+    bool camera(uint32_t)
+    {
+        uint8_t data[omv::Reader::frame_size];
+        virtual_openmv(data);
+        omv::Frame *nframe = omv::Reader::decode_frame(data);
+        if (nframe != NULL) {
+            if (frame != NULL) delete frame;
+            frame = nframe;
+            localizer->update(*frame, bno_dir);
+        } else {
+            localizer->miss();
+        }
+        return false;
+    }
+
+    // LCDには1回に1文字ずつ送る
+    bool display(uint32_t)
+    {
+        if (lcd_sent < lcd_len) lcd.write(lcd_buff[lcd_sent++]);
+        return lcd_sent < lcd_len;
+    }
+
+    enum : uint8_t {
+        BUS_HEADING,
+        BUS_CAMERA,
+        BUS_DISPLAY,
+    };
+
+    robo::BusClient clients[] = {
+        robo::BusClient(heading, 800),
+        robo::BusClient(camera, 1200),
+        robo::BusClient(display, 1300),
+    };
+    robo::I2CBus bus(clients);
+
+    void read_heading(uint32_t) { bus.request(BUS_HEADING, micros()); }
+    void read_camera(uint32_t) { bus.request(BUS_CAMERA, micros()); }
+
+    void control(uint32_t dt)
+    {
+        const uint32_t now = millis();
+        update_context(ctx, w_left, w_right, w_back, bno_dir, frame, *localizer, now);
+        strategy.update(ctx, now);
+        if (m_info) m_info->apply(motor);
+        motor.update(dt);
+    }
+
+    // offense.inoのdisplay()と同じく、2行分を積んでbusから送る
+    void show(uint32_t)
+    {
+        omv::Position *ball_pos = frame ? frame->ball_pos : NULL;
+        if (ball_pos != NULL) {
+            ball_pos->to_string(lcd_buff);
+        } else {
+            strcpy_P(lcd_buff, PSTR("no ball"));
+        }
+        sprintf_P(lcd_buff + strlen(lcd_buff), PSTR("L:%u%u%u S3G3A3M3"), w_left, w_right, w_back);
+        lcd_len = strlen(lcd_buff);
+        lcd_sent = 0;
+        bus.request(BUS_DISPLAY, micros() + 200000UL);
+    }
+
+    robo::Task tasks[] = {
+        robo::Task(read_lines, 200),
+        robo::Task(read_heading, 100),
+        robo::Task(control, 200),
+        robo::Task(read_camera, 60),
+        robo::Task(show, 5),
+    };
+    robo::Scheduler scheduler(tasks);
+
+    void reset()
+    {
+        m_info.reset(new info::Stop());
+        motor.stop();
+        line_escape.reset();
+        strategy.reset();
+        ctx = Context();
+        if (frame != NULL) delete frame;
+        frame = NULL;
+        if (localizer != NULL) delete localizer;
+        localizer = new robo::Localizer();
+        w_left = w_right = w_back = false;
+        lcd_len = lcd_sent = 0;
+        scheduler.setup();
+    }
+
+    void loop()
+    {
+        bus.poll(micros());
+        scheduler.run();
+    }
+}
+
+// defence.inoのloop()と同じ処理(robo::Goalieで動く)
+namespace defence {
+    robo::Motor motor(&mcb);
+    robo::Goalie *goalie = NULL;
+    robo::Angle heading_offset;
+    omv::FrameData frame;
+
+    void reset()
+    {
+        motor.stop();
+        if (goalie != NULL) delete goalie;
+        goalie = new robo::Goalie(motor);
+        frame = omv::FrameData();
+        heading_offset = virtual_heading();
+    }
+
+    void loop()
+    {
+        const uint32_t now = millis();
+        const robo::Angle dir = virtual_heading() - heading_offset;
+        const bool w_left = virtual_analog(1) > robo::profile::lines::defence_line_white;
+        const bool w_right = virtual_analog(2) > robo::profile::lines::defence_line_white;
+        const bool w_back = virtual_analog(3) > robo::profile::lines::defence_line_white;
+        // 1周期に1回だけ読む
+        uint8_t data[omv::Reader::frame_size];
+        virtual_openmv(data);
+        omv::Reader::decode_frame(data, frame);
+        goalie->update(dir, w_left, w_right, w_back, frame, now);
+    }
+}
+
+struct Scenario {
+    const char *name;
+    void (*reset)();
+    void (*loop)();
+    World before, after;
+};
+
+// ボールなし、正面を向いていて、ラインも踏んでいない状態
+constexpr World idle = { false, 0, 0, 90, 20, 90, 120, 0, 100, 100, 100 };
+// ゴール前で待っているディフェンス。ボールは正面の少し遠く、自分のゴール(青)はgoal_near_yとgoal_far_yの間
+constexpr World keeping = { true, 80, 60, 90, 20, 90, 98, 0, 100, 100, 100 };
+
+const Scenario scenarios[] = {
+    { "offense_ball_appears", offense::reset, offense::loop,
+      idle, { true, 90, 20, 90, 20, 90, 120, 0, 100, 100, 100 } },
+    { "offense_heading_kick", offense::reset, offense::loop,
+      idle, { false, 0, 0, 90, 20, 90, 120, 40, 100, 100, 100 } },
+    { "offense_line_touch", offense::reset, offense::loop,
+      idle, { false, 0, 0, 90, 20, 90, 120, 0, 600, 100, 100 } },
+    { "defence_ball_side", defence::reset, defence::loop,
+      keeping, { true, 120, 60, 90, 20, 90, 98, 0, 100, 100, 100 } },
+    { "defence_line_touch", defence::reset, defence::loop,
+      keeping, { true, 80, 60, 90, 20, 90, 98, 0, 600, 100, 100 } },
+};
+
+constexpr uint8_t trials = 64;
+//! 刺激を入れる前に状態を落ち着かせる時間
+constexpr uint32_t settle_time = 600000;
+//! これより長く反応がなければ、反応しなかったものとみなす
+constexpr uint32_t reaction_timeout = 1000000;
+
+uint32_t samples[trials];
+
+// 再現性のために自前の疑似乱数を使う
+uint16_t lfsr = 0xace1;
+uint16_t next_random()
+{
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xb400u);
+    return lfsr;
+}
+
+void run_scenario(const Scenario &s)
+{
+    uint8_t count = 0, misses = 0;
+    for (uint8_t i = 0; i < trials; i++) {
+        sim::before = s.before;
+        sim::after = s.after;
+        sim::stim_at = 0xffffffff;
+        sim::camera_phase = next_random() % timing::camera_period;
+        sim::t0 = micros();
+        // defenceは最初の向きを正面にするので、世界を決めてから初期化する
+        s.reset();
+        while (sim::now() < settle_time) s.loop();
+
+        // ループやカメラの周期に対して、刺激のタイミングをずらす
+        sim::stim_at = sim::now() + next_random() % timing::camera_period;
+        mcb.arm();
+        while (mcb.armed && sim::now() < sim::stim_at + reaction_timeout) s.loop();
+        if (mcb.armed) {
+            mcb.armed = false;
+            ++misses;
+        } else {
+            samples[count++] = mcb.reacted_at - sim::stim_at;
+        }
+    }
+
+    // 挿入ソート
+    for (uint8_t i = 1; i < count; i++) {
+        uint32_t v = samples[i];
+        uint8_t j = i;
+        for (; j > 0 && samples[j - 1] > v; j--) samples[j] = samples[j - 1];
+        samples[j] = v;
+    }
+    auto percentile = [count](uint8_t p) -> uint32_t {
+        if (count == 0) return 0;
+        uint16_t rank = (uint16_t(count) * p + 99) / 100;
+        return samples[rank == 0 ? 0 : rank - 1];
+    };
+
+    Serial.print(F("latency,"));
+    Serial.print(s.name);
+    Serial.print(',');
+    Serial.print(percentile(50));
+    Serial.print(',');
+    Serial.print(percentile(99));
+    Serial.print(',');
+    Serial.print(count ? samples[count - 1] : 0);
+    Serial.print(',');
+    Serial.println(misses);
+    Serial.flush();
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    for (const Scenario &s : scenarios) run_scenario(s);
+    Serial.println(F("done"));
+    Serial.flush();
+
+    // simavrは割り込み禁止のままスリープすると終了する
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    cli();
+    sleep_cpu();
+}
+
+void loop() {}
@@ -1,7 +1,7 @@
 #include <robo2019.h>
 
-// LineSensor(analog-in pin)
-robo::LineSensor line(3);
+// LineSensor<analog-in pin>
+robo::LineSensor<3> line;
 
 void setup()
 {
@@ -13,12 +13,10 @@ void setup() {
 
 void loop() {
     omv::Frame * frame = reader.read_frame();
-    if (frame != NULL) {
+    if (frame == NULL) {
         Serial.println(F("No frame"));
     } else {
-        char buff[128] = "";
-        frame->to_string(buff);
-        Serial.println(buff);
+        Serial.print(*frame);
         delete frame;
     }
     delay(100);
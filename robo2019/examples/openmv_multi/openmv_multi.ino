@@ -0,0 +1,39 @@
+#include <robo2019.h>
+
+namespace omv {
+    using namespace robo::openmv;
+}
+
+// 全方位カメラ: 画像の中心から見た方向。60fps
+const omv::Calibration omni_calibration = {
+    omv::center, robo::Angle(), robo::Angle(), 160, 16, 100
+};
+// 前向きのカメラ: 横に1ピクセルで0.5度。30fpsだが、ボールやゴールの方向はこちらの方が正確
+const omv::Calibration front_calibration = {
+    {80, 60}, robo::Angle(), robo::Angle::from_degrees(1) / 2, 240, 33, 100
+};
+
+omv::Camera cameras[] = {
+    omv::Camera(robo::profile::openmv_address, omni_calibration),
+    omv::Camera(robo::profile::openmv_front_address, front_calibration),
+};
+omv::MultiReader reader(cameras);
+omv::Observation observation;
+
+uint32_t last_print = 0;
+
+void setup() {
+    Serial.begin(9600);
+    reader.setup();
+}
+
+void loop() {
+    const uint32_t now = millis();
+    // 読み込む時刻になったカメラを1台ずつ読む
+    reader.poll(now);
+    if (now - last_print < 200) return;
+    last_print = now;
+    reader.fuse(observation, now);
+    Serial.print(observation);
+    reader.print_stats(Serial, now);
+}
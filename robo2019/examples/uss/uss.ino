@@ -1,7 +1,7 @@
 #include <robo2019.h>
 
-// USSensor(Echo-pin, Trig-pin)
-robo::USSensor echo(3, 4);
+// USSensor<Echo-pin, Trig-pin>
+robo::USSensor<3, 4> echo;
 
 void setup()
 {
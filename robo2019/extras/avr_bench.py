@@ -0,0 +1,154 @@
+"""
+examples/benchmark (または examples/latency) をATmega328P向けにビルドし、
+simavrで実行して結果をJSONにまとめる
+
+必要なもの: arduino-cli (arduino:avr コア), avr-size, avr-nm, simavr
+
+使い方:
+    python3 extras/avr_bench.py                      # 結果を標準出力に表示
+    python3 extras/avr_bench.py -o bench.json        # 結果をファイルに保存
+    python3 extras/avr_bench.py --compare bench.json # 前回の結果との差分を表示
+    python3 extras/avr_bench.py --sketch examples/latency --timeout 600
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+LIB_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_SKETCH = os.path.join(LIB_DIR, "examples", "benchmark")
+ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*m")
+
+
+def build(sketch, fqbn, out_dir):
+    subprocess.run(
+        [
+            "arduino-cli", "compile",
+            "--fqbn", fqbn,
+            "--library", LIB_DIR,
+            "--output-dir", out_dir,
+            sketch,
+        ],
+        check=True,
+        stdout=sys.stderr,
+    )
+    name = os.path.basename(os.path.normpath(sketch))
+    return os.path.join(out_dir, name + ".ino.elf")
+
+
+def section_sizes(elf):
+    # avr-size -A: "<section> <size> <addr>"
+    out = subprocess.run(
+        ["avr-size", "-A", elf], check=True, capture_output=True, text=True
+    ).stdout
+    sizes = {}
+    for line in out.splitlines():
+        cols = line.split()
+        if len(cols) == 3 and cols[1].isdigit():
+            sizes[cols[0]] = int(cols[1])
+    text, data, bss = (sizes.get(s, 0) for s in (".text", ".data", ".bss"))
+    return {"flash": text + data, "sram_static": data + bss, "data": data, "bss": bss}
+
+
+def symbol_sizes(elf, pattern):
+    # avr-nm -S -C: "<addr> <size> <type> <name>"
+    out = subprocess.run(
+        ["avr-nm", "-S", "-C", "--size-sort", elf],
+        check=True, capture_output=True, text=True,
+    ).stdout
+    result = {}
+    for line in out.splitlines():
+        cols = line.split(None, 3)
+        if len(cols) == 4 and cols[2] in "tTwW" and re.search(pattern, cols[3]):
+            result[cols[3]] = result.get(cols[3], 0) + int(cols[1], 16)
+    return result
+
+
+def run(elf, mcu, freq, timeout):
+    proc = subprocess.run(
+        ["simavr", "-m", mcu, "-f", str(freq), elf],
+        stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+        text=True, errors="replace", timeout=timeout,
+    )
+    bench, mem, latency, done = {}, {}, {}, False
+    for line in ANSI_ESCAPE.sub("", proc.stdout).splitlines():
+        m = re.search(r"\b(bench|mem|latency),(\w+),([\d,]+)", line)
+        if m:
+            kind, name, values = m.group(1), m.group(2), [int(v) for v in m.group(3).split(",")]
+            if kind == "latency":
+                latency[name] = dict(zip(("p50_us", "p99_us", "max_us", "misses"), values))
+            else:
+                (bench if kind == "bench" else mem)[name] = values[0]
+        elif line.strip().endswith("done"):
+            done = True
+    if not done:
+        sys.stderr.write(proc.stdout)
+        raise RuntimeError("benchmark did not finish")
+    return bench, mem, latency
+
+
+def flatten(report):
+    flat = {}
+    for key in ("cycles", "latency", "size", "sram_runtime"):
+        for name, value in report.get(key, {}).items():
+            if isinstance(value, dict):
+                for sub, v in value.items():
+                    flat["%s.%s.%s" % (key, name, sub)] = v
+            else:
+                flat["%s.%s" % (key, name)] = value
+    return flat
+
+
+def compare(old, new):
+    old, new = flatten(old), flatten(new)
+    for name in sorted(set(old) | set(new)):
+        a, b = old.get(name), new.get(name)
+        if a == b:
+            continue
+        diff = "" if a is None or b is None else " (%+d, %+.1f%%)" % (b - a, 100.0 * (b - a) / max(a, 1))
+        print("%-48s %8s -> %8s%s" % (name, a, b, diff))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sketch", default=DEFAULT_SKETCH)
+    parser.add_argument("--fqbn", default="arduino:avr:uno")
+    parser.add_argument("--mcu", default="atmega328p")
+    parser.add_argument("--freq", type=int, default=16000000)
+    parser.add_argument("--timeout", type=float, default=60)
+    parser.add_argument("-o", "--output", help="JSONの出力先")
+    parser.add_argument("--compare", help="比較する以前のJSON")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as out_dir:
+        elf = build(args.sketch, args.fqbn, out_dir)
+        size = section_sizes(elf)
+        size["functions"] = symbol_sizes(elf, r"^robo::")
+        cycles, mem, latency = run(elf, args.mcu, args.freq, args.timeout)
+
+    report = {
+        "mcu": args.mcu,
+        "f_cpu": args.freq,
+        "cycles": cycles,
+        "latency": latency,
+        "size": size,
+        "sram_runtime": mem,
+    }
+    text = json.dumps(report, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+    if args.compare:
+        with open(args.compare) as f:
+            compare(json.load(f), report)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,197 @@
+"""
+ボールへの回り込み(orbit)用のベクトル場を計算し、src/orbit_table.h を生成する
+
+ボールの方向(bearing)と距離(ring)で区切ったセルごとに、機体が進む速度ベクトルを求める。
+- ボールが正面(capture_cone以内)にあれば、そのままボールに向かう
+- それ以外は、ボールを中心とする半径orbit_radiusの円に接する方向に進み、
+  ボールの後ろ(ロボットから見て奥)に回り込む。円の内側にいるときは少し離れる方向に進む
+- ボールに近いほど遅くして(slow_radius以内)、ボールを押し出さないようにする
+
+距離はOpenMVの画像上のピクセル数(画像の中心 openmv::center から)で指定する。
+
+使い方:
+    python3 extras/gen_orbit.py                        # src/orbit_table.h を上書き
+    python3 extras/gen_orbit.py --orbit-radius 24 --min-speed 40
+    python3 extras/gen_orbit.py --preview              # 表を文字で表示するだけ
+"""
+
+import argparse
+import math
+import os
+
+LIB_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_OUTPUT = os.path.join(LIB_DIR, "src", "orbit_table.h")
+
+
+def smoothstep(edge0, edge1, x):
+    if edge1 <= edge0:
+        return 0.0 if x < edge0 else 1.0
+    t = min(max((x - edge0) / (edge1 - edge0), 0.0), 1.0)
+    return t * t * (3 - 2 * t)
+
+
+def field(bearing, dist, p):
+    """
+    bearing: ボールの方向(ラジアン、前が0、左が正)
+    dist: ボールまでの距離(ピクセル)
+    return: (方向(ラジアン), 速さ)
+    """
+    side = 1.0 if bearing >= 0 else -1.0
+    if dist > p.orbit_radius:
+        # 半径orbit_radiusの円への接線の方向
+        offset = math.asin(p.orbit_radius / dist)
+    else:
+        # 円の内側 => 接線より外向きにずらして離れる
+        offset = math.pi / 2 + (1 - dist / p.orbit_radius) * math.radians(p.escape_angle)
+    # 正面付近では回り込まずにまっすぐ向かう(境目はなめらかにつなぐ)
+    cone = math.radians(p.capture_cone)
+    weight = smoothstep(cone, cone * 2, abs(bearing))
+    direction = bearing + side * offset * weight
+
+    speed = p.max_speed
+    if dist < p.slow_radius:
+        t = dist / p.slow_radius
+        speed = p.min_speed + (p.max_speed - p.min_speed) * t
+    if weight < 1 and dist < p.slow_radius:
+        # 正面で近い => ドリブルの速さに抑える
+        speed = min(speed, p.capture_speed + (p.max_speed - p.capture_speed) * weight)
+    return direction, speed
+
+
+def tan_thresholds(sectors):
+    # 象限の中を sectors / 4 等分する境目の tan を、256倍した整数で表す
+    per_quadrant = sectors // 4
+    step = math.pi / 2 / per_quadrant
+    return [round(math.tan(step * k) * 256) for k in range(1, per_quadrant)]
+
+
+def build(p):
+    sector_width = 2 * math.pi / p.sectors
+    rings = p.rings
+    centers = []
+    for i in range(len(rings) + 1):
+        lo = rings[i - 1] if i > 0 else 0
+        hi = rings[i] if i < len(rings) else lo + (rings[-1] - rings[-2])
+        centers.append((lo + hi) / 2)
+    cells = []
+    for s in range(p.sectors):
+        # セルsは [s * width, (s + 1) * width) の方向(0..2pi、左回り)を受け持つ
+        bearing = (s + 0.5) * sector_width
+        if bearing > math.pi:
+            bearing -= 2 * math.pi
+        row = []
+        for dist in centers:
+            direction, speed = field(bearing, dist, p)
+            row.append((round(speed * math.cos(direction)), round(speed * math.sin(direction))))
+        cells.append(row)
+    return cells
+
+
+def render(p, cells):
+    thresholds = tan_thresholds(p.sectors)
+    lines = []
+    w = lines.append
+    w("/**")
+    w(" * @file orbit_table.h")
+    w(" * @brief orbit.hで使うベクトル場の表")
+    w(" * @note extras/gen_orbit.pyで生成したファイル。直接書き換えないこと")
+    w(" * @details")
+    w(" *  python3 extras/gen_orbit.py %s" % " ".join(p.argv))
+    w(" */")
+    w("")
+    w("#pragma once")
+    w("")
+    w("#ifndef ROBO2019_ORBIT_TABLE_H")
+    w("#define ROBO2019_ORBIT_TABLE_H")
+    w("")
+    w("#include <avr/pgmspace.h>")
+    w("")
+    w("namespace robo {")
+    w("")
+    w("namespace orbit {")
+    w("")
+    w("namespace table {")
+    w("    //! 方向の分割数(4の倍数)")
+    w("    constexpr uint8_t sectors = %d;" % p.sectors)
+    w("    //! 距離の分割数")
+    w("    constexpr uint8_t rings = %d;" % (len(p.rings) + 1))
+    w("    //! 象限の中での方向の境目(tanを256倍したもの)")
+    w("    const uint16_t tan_thresholds[] PROGMEM = { %s };" % ", ".join(str(t) for t in thresholds))
+    w("    //! 距離の境目(ピクセル数の2乗)")
+    w("    const uint16_t ring_limits_sq[] PROGMEM = { %s };" % ", ".join(str(r * r) for r in p.rings))
+    w("    //! 速度ベクトル[方向][距離] = {前, 左}")
+    w("    const int8_t field[sectors][rings][2] PROGMEM = {")
+    for s, row in enumerate(cells):
+        deg = 360.0 * s / p.sectors
+        body = ", ".join("{%4d,%4d}" % c for c in row)
+        w("        /* %5.1f */ { %s }," % (deg, body))
+    w("    };")
+    w("} // namespace table")
+    w("")
+    w("} // namespace orbit")
+    w("")
+    w("} // namespace robo")
+    w("")
+    w("#endif /* ROBO2019_ORBIT_TABLE_H */")
+    return "\n".join(lines) + "\n"
+
+
+def preview(p, cells):
+    arrows = "→↗↑↖←↙↓↘"
+    print("bearing  " + " ".join("%5d" % r for r in p.rings + [p.rings[-1] * 2]))
+    for s, row in enumerate(cells):
+        out = []
+        for x, y in row:
+            # 表示は「前」を上にする
+            a = math.atan2(x, -y)
+            idx = int(round(a / (math.pi / 4))) % 8
+            out.append("%s%3d" % (arrows[idx], round(math.hypot(x, y))))
+        print("%6.1f   %s" % (360.0 * s / p.sectors, " ".join(out)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sectors", type=int, default=32, help="方向の分割数(4の倍数)")
+    parser.add_argument("--rings", type=int, nargs="+", default=[10, 16, 22, 30, 40, 52, 66],
+                        help="距離の境目(ピクセル、昇順)")
+    parser.add_argument("--orbit-radius", type=float, default=20, help="回り込むときの半径(ピクセル)")
+    parser.add_argument("--escape-angle", type=float, default=30,
+                        help="円の内側にいるとき、接線からさらに外にずらす角度の最大値(度)")
+    parser.add_argument("--capture-cone", type=float, default=15,
+                        help="まっすぐ向かう正面の範囲(度)。この2倍の範囲で回り込みに切り替わる")
+    parser.add_argument("--slow-radius", type=float, default=30, help="減速を始める距離(ピクセル)")
+    parser.add_argument("--max-speed", type=float, default=100)
+    parser.add_argument("--min-speed", type=float, default=50, help="ボールのすぐそばでの速さ")
+    parser.add_argument("--capture-speed", type=float, default=60, help="正面のボールに近づくときの速さ")
+    parser.add_argument("-o", "--output", default=DEFAULT_OUTPUT)
+    parser.add_argument("--preview", action="store_true")
+    args = parser.parse_args()
+
+    if args.sectors % 4 or args.sectors < 4:
+        parser.error("--sectors must be a multiple of 4")
+    if sorted(args.rings) != args.rings or len(args.rings) < 2 or args.rings[-1] > 255:
+        parser.error("--rings must be ascending, at least 2 values, each <= 255")
+    if args.max_speed > 127:
+        parser.error("--max-speed must fit in int8_t")
+    args.argv = [
+        "--sectors %d" % args.sectors,
+        "--rings %s" % " ".join(str(r) for r in args.rings),
+        "--orbit-radius %g" % args.orbit_radius,
+        "--escape-angle %g" % args.escape_angle,
+        "--capture-cone %g" % args.capture_cone,
+        "--slow-radius %g" % args.slow_radius,
+        "--max-speed %g" % args.max_speed,
+        "--min-speed %g" % args.min_speed,
+        "--capture-speed %g" % args.capture_speed,
+    ]
+
+    cells = build(args)
+    if args.preview:
+        preview(args, cells)
+        return
+    with open(args.output, "w") as f:
+        f.write(render(args, cells))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+"""
+extras/host_test/ のテストをPCのコンパイラでビルドして実行する
+
+Arduinoの機能に依存しない(または extras/host_test/stub の最小限のArduino.hで足りる)部分を、
+実機を使わずに確かめる。各テストは extras/host_test/test_*.cpp で、先頭の
+    // sources: fastmath.cpp angle.cpp
+の行に、一緒にビルドする src/ のファイルを書く(ヘッダーだけで済むなら要らない)。
+
+必要なもの: g++ (C++11)
+
+使い方:
+    python3 extras/host_test.py                 # すべてのテストを実行
+    python3 extras/host_test.py strategy        # test_strategy.cppだけ実行
+    python3 extras/host_test.py --cxx clang++
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+LIB_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TEST_DIR = os.path.join(LIB_DIR, "extras", "host_test")
+SOURCES = re.compile(r"^//\s*sources:(.*)$", re.MULTILINE)
+
+
+def sources_of(test):
+    with open(test) as f:
+        m = SOURCES.search(f.read())
+    if not m:
+        return []
+    return [os.path.join(LIB_DIR, "src", name) for name in m.group(1).split()]
+
+
+def run(test, cxx, build_dir):
+    name = os.path.splitext(os.path.basename(test))[0]
+    exe = os.path.join(build_dir, name)
+    subprocess.run(
+        [
+            cxx, "-std=gnu++11", "-Wall", "-Wextra",
+            # Arduinoのビルドと同じく、ARDUINOを定義してライブラリのヘッダーを使えるようにする
+            "-DARDUINO=10813",
+            "-I", os.path.join(TEST_DIR, "stub"),
+            "-I", os.path.join(LIB_DIR, "src"),
+            "-o", exe,
+            test,
+        ] + sources_of(test) + ["-lm"],
+        check=True,
+    )
+    return subprocess.run([exe]).returncode == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("names", nargs="*", help="実行するテスト(test_<name>.cppの<name>)")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"), help="C++コンパイラ")
+    args = parser.parse_args()
+
+    if args.names:
+        tests = [os.path.join(TEST_DIR, "test_%s.cpp" % name) for name in args.names]
+    else:
+        tests = sorted(glob.glob(os.path.join(TEST_DIR, "test_*.cpp")))
+
+    failed = []
+    with tempfile.TemporaryDirectory() as build_dir:
+        for test in tests:
+            name = os.path.basename(test)
+            print("== %s" % name)
+            if not run(test, args.cxx, build_dir):
+                failed.append(name)
+
+    if failed:
+        print("FAILED: %s" % ", ".join(failed))
+        sys.exit(1)
+    print("all %d tests passed" % len(tests))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+/**
+ * @file check.h
+ * @brief ホストのPCで動かすテストの最小限の仕組み
+ * @note 失敗した条件とその行を表示し、最後にcheck_result()で終了コードを返す
+ */
+
+#pragma once
+
+#ifndef ROBO2019_HOST_TEST_CHECK_H
+#define ROBO2019_HOST_TEST_CHECK_H
+
+#include <stdio.h>
+
+namespace check {
+    //! 失敗した条件の数
+    inline int &failures() { static int n = 0; return n; }
+}
+
+//! 条件が成り立たなければ失敗として表示する
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        ++check::failures(); \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+//! main()の最後で返す終了コード
+inline int check_result()
+{
+    if (check::failures() != 0) {
+        printf("%d check(s) failed\n", check::failures());
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
+
+#endif /* ROBO2019_HOST_TEST_CHECK_H */
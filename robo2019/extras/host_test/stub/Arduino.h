@@ -0,0 +1,76 @@
+/**
+ * @file Arduino.h
+ * @brief ホストのPCでライブラリをビルドするための、最小限のArduino.hの代わり
+ * @details
+ *  テストで使う部分がビルドできるだけの定義しかない。
+ *  PROGMEMは普通のメモリに置き、pgm_read_*はそのまま読む。millis()/micros()はテストが値を決める。
+ */
+
+#pragma once
+
+#ifndef ROBO2019_HOST_TEST_ARDUINO_H
+#define ROBO2019_HOST_TEST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Print.h"
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+// Arduinoと同じくマクロにする(同じ名前のメンバーを作れないことも含めて確かめられる)
+#undef abs
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_float(p) (*(const float *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+namespace host {
+    //! millis()/micros()が返す時刻(マイクロ秒)。テストが進める
+    inline uint32_t &now_us() { static uint32_t t = 0; return t; }
+}
+
+inline unsigned long micros() { return host::now_us(); }
+inline unsigned long millis() { return host::now_us() / 1000; }
+
+namespace host {
+    //! 何も送らず、何も受け取らないSerialの代わり
+    class NullSerial : public Stream
+    {
+    public:
+        size_t write(uint8_t) override { return 1; }
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+    };
+}
+
+static host::NullSerial Serial;
+
+#endif /* ROBO2019_HOST_TEST_ARDUINO_H */
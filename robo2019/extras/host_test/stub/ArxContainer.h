@@ -0,0 +1,2 @@
+#pragma once
+// ホストのPCでビルドするテストでは使わない
@@ -0,0 +1,4 @@
+#pragma once
+// ホストのPCでは標準ライブラリのものを使う
+#include <type_traits>
+#include <utility>
@@ -0,0 +1,88 @@
+/**
+ * @file Print.h
+ * @brief ホストのPCでライブラリをビルドするための、最小限のPrint.hの代わり
+ * @note print()などは何も出力しない(ライブラリの出力を使う部分をリンクできるようにするだけ)
+ */
+
+#pragma once
+
+#ifndef ROBO2019_HOST_TEST_PRINT_H
+#define ROBO2019_HOST_TEST_PRINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+class String
+{
+public:
+    String(const char * = "") {}
+    unsigned int length() const { return 0; }
+    const char *c_str() const { return ""; }
+    unsigned char concat(char) { return 1; }
+    unsigned char reserve(unsigned int) { return 1; }
+};
+
+class Print;
+
+class Printable
+{
+public:
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+public:
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char *str) { return write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+    size_t write(const char *buffer, size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *) { return 0; }
+    size_t print(const String &) { return 0; }
+    size_t print(const char[]) { return 0; }
+    size_t print(char) { return 0; }
+    size_t print(unsigned char, int = DEC) { return 0; }
+    size_t print(int, int = DEC) { return 0; }
+    size_t print(unsigned int, int = DEC) { return 0; }
+    size_t print(long, int = DEC) { return 0; }
+    size_t print(unsigned long, int = DEC) { return 0; }
+    size_t print(double, int = 2) { return 0; }
+    size_t print(const Printable &) { return 0; }
+    size_t println(const __FlashStringHelper *) { return 0; }
+    size_t println(const String &) { return 0; }
+    size_t println(const char[]) { return 0; }
+    size_t println(char) { return 0; }
+    size_t println(unsigned char, int = DEC) { return 0; }
+    size_t println(int, int = DEC) { return 0; }
+    size_t println(unsigned int, int = DEC) { return 0; }
+    size_t println(long, int = DEC) { return 0; }
+    size_t println(unsigned long, int = DEC) { return 0; }
+    size_t println(double, int = 2) { return 0; }
+    size_t println(const Printable &) { return 0; }
+    size_t println() { return 0; }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+#endif /* ROBO2019_HOST_TEST_PRINT_H */
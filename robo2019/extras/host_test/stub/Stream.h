@@ -0,0 +1,8 @@
+/**
+ * @file Stream.h
+ * @brief ホストのPCでライブラリをビルドするための、Stream.hの代わり(Print.hで定義している)
+ */
+
+#pragma once
+
+#include "Print.h"
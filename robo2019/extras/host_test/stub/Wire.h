@@ -0,0 +1,34 @@
+/**
+ * @file Wire.h
+ * @brief ホストのPCでライブラリをビルドするための、最小限のWire.hの代わり
+ * @note 宣言だけなので、テストではI2Cで通信する機能は呼ばない
+ */
+
+#pragma once
+
+#ifndef ROBO2019_HOST_TEST_WIRE_H
+#define ROBO2019_HOST_TEST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire : public Stream
+{
+public:
+    void begin();
+    void setClock(uint32_t);
+    uint8_t requestFrom(uint8_t, uint8_t);
+    uint8_t requestFrom(uint8_t, uint8_t, uint8_t);
+    void beginTransmission(uint8_t);
+    uint8_t endTransmission();
+    uint8_t endTransmission(uint8_t);
+    size_t write(uint8_t) override;
+    size_t write(const uint8_t *, size_t) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+};
+
+extern TwoWire Wire;
+
+#endif /* ROBO2019_HOST_TEST_WIRE_H */
@@ -0,0 +1,8 @@
+/**
+ * @file pgmspace.h
+ * @brief ホストのPCでライブラリをビルドするための、avr/pgmspace.hの代わり(Arduino.hで定義している)
+ */
+
+#pragma once
+
+#include <Arduino.h>
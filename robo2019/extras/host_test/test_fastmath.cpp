@@ -0,0 +1,129 @@
+// sources: fastmath.cpp angle.cpp
+/**
+ * @file test_fastmath.cpp
+ * @brief robo::fastmathの近似とlibmとの差の最大値が、fastmath.hの表に書いた誤差に収まることを確かめる
+ * @details examples/fastmathと同じ点(円周上に等間隔)を、半径を増やして調べる。最大の誤差も表示する
+ */
+
+#include <stdio.h>
+
+#include <fastmath.h>
+
+#include "check.h"
+
+namespace {
+
+namespace fm = robo::fastmath;
+
+// 調べる点の数(円周上に等間隔)
+constexpr int steps = 3600;
+// 調べる円の半径
+const int16_t radii[] = { 1, 3, 20, 70, 300, 1500, 8000, 32000 };
+
+// 角度の差(-PI..PI)
+double angle_error(double a, double b)
+{
+    double d = a - b;
+    while (d > PI) d -= 2 * PI;
+    while (d < -PI) d += 2 * PI;
+    return fabs(d);
+}
+
+struct MaxError {
+    const char *name;
+    double bound;
+    double value;
+
+    void add(double error) { if (error > value) value = error; }
+    void check() const
+    {
+        printf("  %-16s %.3g (<= %.3g)\n", name, value, bound);
+        CHECK(value <= bound);
+    }
+};
+
+void test_against_libm()
+{
+    MaxError atan2_precise = { "atan2 precise", 1.2e-5, 0 };
+    MaxError atan2_fast = { "atan2 fast", 4e-3, 0 };
+    MaxError hypot_fast = { "hypot fast", 0.02, 0 };
+    MaxError sincos_precise = { "sincos precise", 2e-4, 0 };
+    MaxError iatan2_precise = { "iatan2 precise", 2e-4, 0 };
+    MaxError iatan2_fast = { "iatan2 fast", 4e-3, 0 };
+    MaxError ihypot_fast = { "ihypot fast", 0.02, 0 };
+
+    for (int16_t radius : radii) {
+        for (int i = 0; i < steps; i++) {
+            const double rad = 2 * PI * i / steps - PI;
+            const float x = radius * cos(rad), y = radius * sin(rad);
+            const int16_t ix = int16_t(lround(x)), iy = int16_t(lround(y));
+            const double exact_dir = atan2(double(y), double(x)), exact_mag = hypot(double(x), double(y));
+
+            atan2_precise.add(angle_error(fm::atan2<fm::precise>(y, x), exact_dir));
+            atan2_fast.add(angle_error(fm::atan2<fm::fast>(y, x), exact_dir));
+            hypot_fast.add(fabs(fm::hypot<fm::fast>(x, y) - exact_mag) / exact_mag);
+
+            float s, c;
+            fm::sincos<fm::precise>(float(rad), s, c);
+            sincos_precise.add(fmax(fabs(s - sin(rad)), fabs(c - cos(rad))));
+
+            if (ix == 0 && iy == 0) continue;
+            const double exact_idir = atan2(double(iy), double(ix)), exact_imag = hypot(double(ix), double(iy));
+            iatan2_precise.add(angle_error(fm::iatan2<fm::precise>(iy, ix).to_radians(), exact_idir));
+            iatan2_fast.add(angle_error(fm::iatan2<fm::fast>(iy, ix).to_radians(), exact_idir));
+            // 整数の切り捨ての分(1未満)は誤差に含めない
+            ihypot_fast.add(fmax(0.0, fabs(fm::ihypot<fm::fast>(ix, iy) - exact_imag) - 1) / exact_imag);
+
+            // exactとpreciseの整数版は切り捨てのsqrtなので、1未満しか違わない
+            const double ihypot_error = exact_imag - fm::ihypot<fm::precise>(ix, iy);
+            CHECK(ihypot_error >= 0 && ihypot_error < 1);
+        }
+    }
+
+    atan2_precise.check();
+    atan2_fast.check();
+    hypot_fast.check();
+    sincos_precise.check();
+    iatan2_precise.check();
+    iatan2_fast.check();
+    ihypot_fast.check();
+}
+
+// 原点、軸の上、45度の線の上
+void test_special_points()
+{
+    CHECK(fm::atan2<fm::precise>(0, 0) == 0);
+    CHECK(fm::atan2<fm::fast>(0, 0) == 0);
+    CHECK(fm::iatan2<fm::precise>(0, 0) == robo::Angle());
+    CHECK(fm::iatan2<fm::fast>(0, 0) == robo::Angle());
+    CHECK(fm::iatan2<fm::precise>(0, 100) == robo::Angle());
+    CHECK(fm::iatan2<fm::precise>(100, 0).raw() == robo::Angle::quarter_turn);
+    CHECK(fm::iatan2<fm::precise>(0, -100).raw() == robo::Angle::half_turn);
+    CHECK(fm::iatan2<fm::precise>(-100, 0).raw() == uint16_t(-robo::Angle::quarter_turn));
+    CHECK(fm::iatan2<fm::precise>(100, 100).raw() == robo::Angle::quarter_turn / 2);
+    CHECK(fm::iatan2<fm::fast>(100, 100).raw() == robo::Angle::quarter_turn / 2);
+}
+
+// 切り捨ての平方根を、uint32_tの範囲の端まで調べる
+void test_isqrt()
+{
+    const uint32_t values[] = { 0, 1, 2, 3, 4, 15, 16, 17, 65535, 65536, 0xfffe0001UL, 0xfffffffeUL, 0xffffffffUL };
+    for (uint32_t n : values) {
+        const uint32_t r = fm::isqrt(n);
+        CHECK(uint64_t(r) * r <= n && uint64_t(r + 1) * (r + 1) > n);
+    }
+    for (uint32_t n = 0; n < 0x1000000UL; n += 97) {
+        const uint32_t r = fm::isqrt(n);
+        CHECK(uint64_t(r) * r <= n && uint64_t(r + 1) * (r + 1) > n);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    test_against_libm();
+    test_special_points();
+    test_isqrt();
+    return check_result();
+}
@@ -0,0 +1,215 @@
+// sources: intercept.cpp
+/**
+ * @file test_intercept.cpp
+ * @brief robo::Interceptorに、速さのわかっているボールの位置を並べて渡し、予測した位置とパワーを確かめる
+ * @details 位置は100ミリ秒ごとに整数のピクセルで渡す(OpenMVのフレームと同じ)
+ */
+
+#include <intercept.h>
+
+#include "check.h"
+
+namespace {
+
+using Position = robo::openmv::Position;
+
+// examples/interceptと同じシュート(速さpx/s、始点x、守備ラインでのx)。始点のyは10
+struct Shot {
+    int16_t speed;
+    int16_t from_x;
+    int16_t to_x;
+};
+
+const Shot shots[] = {
+    {  60,  80,  80 },
+    {  60,  40, 110 },
+    {  60, 100,  60 },
+    { 120, 120,  50 },
+    { 120,  60, 100 },
+    { 180,  80, 120 },
+    { 240,  30, 100 },
+    { 240, 130,  60 },
+    { 360,  70,  40 },
+    { 480,  50, 110 },
+    { 480, 110,  45 },
+    { 480,  80,  80 },
+};
+
+// 機体の動きを差し引かず、遠くの予測も使う
+const robo::Interceptor::Config no_ego = {
+    60,   // guard_y
+    80,   // center_x
+    60,   // reach
+    7,    // dead_band
+    3,    // gain
+    20,   // min_power
+    40,   // max_power
+    400,  // max_accel
+    5000, // horizon_ms
+    0,    // full_speed
+};
+
+// 止まっているボールは、そのままのx座標を目標にする
+void test_still_ball()
+{
+    robo::Interceptor interceptor;
+    const Position center = { 80, 30 };
+    CHECK(interceptor.update(&center, 1000) == 0);
+    CHECK(interceptor.target() == 80);
+    CHECK(interceptor.tracking());
+
+    // 目標との差がdead_band以下なら動かない
+    const Position near = { 87, 30 };
+    CHECK(interceptor.update(&near, 1100) == 0);
+    CHECK(interceptor.target() == 87);
+}
+
+// 動き出すときはmin_powerまで一度に上げ、あとはmax_accelで増やす
+void test_power_profile()
+{
+    robo::Interceptor interceptor;
+    const Position left = { 100, 30 };
+    // 差20 * gain 3 = 60 -> max_power 40。1周期(20ミリ秒)に400 * 20 / 1000 = 8ずつ
+    CHECK(interceptor.update(&left, 0) == 20);
+    CHECK(interceptor.update(&left, 20) == 28);
+    CHECK(interceptor.update(&left, 40) == 36);
+    CHECK(interceptor.update(&left, 60) == 40);
+    CHECK(interceptor.update(&left, 80) == 40);
+
+    // 右にあるときは負のパワー
+    robo::Interceptor right_side;
+    const Position right = { 60, 30 };
+    CHECK(right_side.update(&right, 0) == -20);
+}
+
+// 近づいてくるボールは、守備ラインを横切るx座標を予測する
+void test_prediction()
+{
+    robo::Interceptor interceptor(no_ego);
+    // x = 80 + 10t, y = 20t (ピクセル、tは秒)。y = 60に届くときのx = 80 + 10 * 3 = 110
+    for (int n = 0; n <= 12; n++) {
+        const Position ball = { uint8_t(80 + n), uint8_t(2 * n) };
+        interceptor.update(&ball, 100 * n);
+    }
+    CHECK(interceptor.vx() >= 9 && interceptor.vx() <= 10);
+    CHECK(interceptor.vy() >= 19 && interceptor.vy() <= 20);
+    CHECK(interceptor.target() >= 109 && interceptor.target() <= 111);
+}
+
+// 遠ざかるボールと、horizon_msより先に届くボールは、今のx座標を目標にする
+void test_no_prediction()
+{
+    robo::Interceptor away(no_ego);
+    for (int n = 0; n <= 12; n++) {
+        const Position ball = { uint8_t(80 + n), uint8_t(50 - 2 * n) };
+        away.update(&ball, 100 * n);
+    }
+    CHECK(away.vy() < 0);
+    CHECK(away.target() == 92);
+
+    // 同じ動きでも、default_configのhorizon_ms(1秒)より先(3秒後)なら予測しない
+    robo::Interceptor far;
+    for (int n = 0; n <= 5; n++) {
+        const Position ball = { uint8_t(80 + n), uint8_t(2 * n) };
+        far.update(&ball, 100 * n);
+    }
+    CHECK(far.target() == 85);
+}
+
+// 目標はcenter_x ± reachに収める
+void test_reach()
+{
+    robo::Interceptor interceptor;
+    const Position edge = { 0, 30 };
+    interceptor.update(&edge, 0);
+    CHECK(interceptor.target() == 20);
+    const Position other = { 159, 30 };
+    interceptor.update(&other, 300);
+    CHECK(interceptor.target() == 140);
+}
+
+// 見失ったら正面に戻り、パワーを0に向けて減らす
+void test_lost()
+{
+    robo::Interceptor interceptor;
+    const Position left = { 120, 30 };
+    for (int n = 0; n <= 10; n++) interceptor.update(&left, 20 * n);
+    CHECK(interceptor.power() == 40);
+    CHECK(interceptor.update(NULL, 220) == 32);
+    CHECK(interceptor.target() == 80);
+    CHECK(interceptor.tracking());
+    for (int n = 12; n <= 30; n++) interceptor.update(NULL, 20 * n);
+    CHECK(interceptor.power() == 0);
+    CHECK(!interceptor.tracking());
+}
+
+// 機体が横移動している分は、画像上のボールの速さから差し引く
+void test_ego_motion()
+{
+    robo::Interceptor interceptor;
+    // パワー40(100ミリ秒で上限まで上がる)で左に動くと、画像上では40 * 150 / 100 = 60ピクセル毎秒で右に流れる
+    for (int n = 0; n <= 6; n++) {
+        const Position ball = { uint8_t(140 - 6 * n), 30 };
+        interceptor.update(&ball, 100 * n);
+        if (n >= 1) CHECK(interceptor.power() == 40);
+    }
+    CHECK(interceptor.vx() >= -1 && interceptor.vx() <= 1);
+}
+
+// いろいろな速さと角度のシュートを、examples/interceptと同じ周期(10ミリ秒)とフレームの間隔(33ミリ秒)で再生する。
+// 機体の横移動(パワー1あたり1.5px/s)は画像上のボールの位置に反映する
+void test_shots()
+{
+    const robo::Interceptor::Config &config = robo::Interceptor::default_config;
+    const uint16_t loop_ms = 10, frame_ms = 33;
+    const float start_y = 10, px_per_power = config.full_speed / 100.0f;
+    for (const Shot &shot : shots) {
+        robo::Interceptor interceptor;
+        const float duration = (config.guard_y - start_y) / shot.speed;
+        const float vx = (shot.to_x - shot.from_x) / duration;
+        float robot = 0; // 機体が左に動いた距離(px)
+        Position ball;
+        bool seen = false;
+        int16_t predicted = config.center_x;
+        int8_t prev = 0;
+        for (uint32_t t = 0;; t += loop_ms) {
+            const float sec = t / 1000.0f;
+            const float bx = shot.from_x + vx * sec, by = start_y + shot.speed * sec;
+            if (by >= config.guard_y) break;
+            if (t % frame_ms < loop_ms) {
+                ball.x = uint16_t(bx - robot + 0.5f);
+                ball.y = uint16_t(by + 0.5f);
+                seen = true;
+            }
+            const int8_t power = interceptor.update(seen ? &ball : NULL, t);
+            // 画像上の目標に、機体が動いた分を足すとフィールド上のx座標
+            predicted = interceptor.target() + int16_t(robot);
+
+            // パワーはmin_powerからmax_powerまで(min_powerより小さいのは止まる途中だけ)
+            CHECK(abs(power) <= config.max_power);
+            CHECK(power == 0 || abs(power) >= config.min_power || abs(power) < abs(prev));
+            // 1周期にmax_accelの分しか変えない(min_powerより小さいところからmin_powerに上げる分は除く)
+            const int16_t step = config.max_accel * loop_ms / 1000;
+            CHECK(abs(power - prev) <= step || (abs(power) == config.min_power && abs(prev) < config.min_power));
+            prev = power;
+            robot += power * px_per_power * loop_ms / 1000;
+        }
+        // 守備ラインに届く直前の予測は、実際に横切るx座標に近い
+        CHECK(abs(predicted - shot.to_x) <= 3);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    test_still_ball();
+    test_power_profile();
+    test_prediction();
+    test_no_prediction();
+    test_reach();
+    test_lost();
+    test_ego_motion();
+    test_shots();
+    return check_result();
+}
@@ -0,0 +1,214 @@
+// sources: fastmath.cpp angle.cpp line_escape.cpp localization.cpp move_info.cpp motor.cpp orbit.cpp
+/**
+ * @file test_strategy.cpp
+ * @brief offense.inoの状態と遷移の表(offense_strategy.h)を、robo::Strategyで動かして確かめる
+ * @details
+ *  offense.inoのESCAPEは、推定した位置で白線に近づいたとき(near_boundary)と、線を踏んだとき(on_line)の
+ *  どちらからも入る。近づいてESCAPEに入った後で線を踏んでも、遷移先が今の状態なので入り直さず、enterは呼ばれない。
+ *  そのため、離れる方向はaction::escapeの中で決め直す。ここでは実機と同じ表で、この流れを確かめる。
+ *  ほかに、ROTATEのパワーとCHASEの速さがパラメーターの範囲に収まることを確かめる。
+ */
+
+#include <line_escape.h>
+#include <motor.h>
+#include <move_info.h>
+
+#include "check.h"
+
+// offense_strategy.hが使うもの(offense.inoと同じ名前で用意する)
+namespace param {
+    enum : uint8_t {
+        max_speed,
+        rotate_gain,
+        rotate_base,
+        count,
+    };
+}
+int16_t params[param::count];
+robo::Angle front_range;
+robo::LineEscape line_escape(150, 80);
+
+// offense.inoのauto_ptrの代わり(最後に決めた動きを持つ)
+struct MoveHolder {
+    robo::move_info::MoveInfo *ptr = NULL;
+    ~MoveHolder() { delete ptr; }
+    void reset(robo::move_info::MoveInfo *p)
+    {
+        delete ptr;
+        ptr = p;
+    }
+    operator bool() const { return ptr != NULL; }
+    robo::move_info::MoveInfo *operator->() { return ptr; }
+} m_info;
+
+#include <offense_strategy.h>
+
+namespace {
+
+// モーターに送る内容は捨てる
+class NullPort : public Print
+{
+public:
+    size_t write(uint8_t) override { return 1; }
+};
+
+// 変化の速さを制限しない(すぐに目標のパワーになる)
+const robo::Motor::Config no_slew = { 0, 0 };
+
+// offense.inoのパラメーターの初期値に戻す
+void reset_params()
+{
+    params[param::max_speed] = 100;
+    params[param::rotate_gain] = 25;
+    params[param::rotate_base] = 20;
+    front_range = robo::Angle::from_degrees(18);
+    line_escape.reset();
+    m_info.reset(NULL);
+}
+
+// 正面を向き、ボールもゴールも見えず、白線から遠い
+Context fresh()
+{
+    Context c = {};
+    return c;
+}
+
+// offense.inoのcontrol()と同じく、直前の動きの速度ベクトルを渡してline_escapeを進める
+bool update_lines(uint8_t white, uint32_t now)
+{
+    return line_escape.update(white, m_info.ptr ? m_info.ptr->velocity() : robo::V2_float(0, 0), now);
+}
+
+bool near(float a, float b) { return fabs(a - b) < 1e-3; }
+
+// 白線に近づいてESCAPEに入り、その後で線を踏む
+void test_line_after_near_boundary()
+{
+    reset_params();
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+    Context c = fresh();
+    CHECK(strategy.update(c, 0) == IDLE);
+
+    // 後ろの白線に近い => 前(フィールドの中心)に向かう
+    c.pose_valid = true;
+    c.pose_x = -700;
+    c.margin = 100;
+    CHECK(strategy.update(c, 10) == ESCAPE);
+    CHECK(!c.escape_dir_on_line);
+    CHECK(c.escape_dir == robo::Angle());
+    const robo::V2_float forward = m_info.ptr->velocity();
+    CHECK(forward.x > 99 && fabs(forward.y) < 1);
+
+    // 線を踏んだ(前にゴールがある => ペナルティエリア)。ESCAPEには入り直さないが、方向は決め直す
+    c.escaping = update_lines(robo::LineEscape::left, 20);
+    c.y_goal_seen = true;
+    c.y_goal_dir = robo::Angle();
+    CHECK(strategy.update(c, 20) == ESCAPE);
+    CHECK(c.escape_dir_on_line);
+    CHECK(near(line_escape.direction(), PI));
+
+    // 線を踏んでいる間は決め直さない
+    c.y_goal_seen = false;
+    c.escaping = update_lines(robo::LineEscape::left, 30);
+    CHECK(strategy.update(c, 30) == ESCAPE);
+    CHECK(near(line_escape.direction(), PI));
+
+    // 離れ終わったが、まだ白線に近い => 推定した位置から決め直す
+    c.escaping = update_lines(0, 200);
+    CHECK(!c.escaping);
+    CHECK(strategy.update(c, 200) == ESCAPE);
+    CHECK(!c.escape_dir_on_line);
+    CHECK(m_info.ptr->velocity().x > 99);
+
+    // もう一度線を踏んだ(ゴールは見えない) => line_escapeがセンサーから決めた方向のまま
+    m_info.reset(new robo::move_info::Stop());
+    c.escaping = update_lines(robo::LineEscape::back, 210);
+    CHECK(strategy.update(c, 210) == ESCAPE);
+    CHECK(c.escape_dir_on_line);
+    CHECK(near(line_escape.direction(), 0));
+}
+
+// 線を踏んでESCAPEに入ったときは、enterで1回だけ決める
+void test_line_first()
+{
+    reset_params();
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+    Context c = fresh();
+    c.escaping = update_lines(robo::LineEscape::back, 0);
+    c.y_goal_seen = true;
+    CHECK(strategy.update(c, 0) == ESCAPE);
+    CHECK(c.escape_dir_on_line);
+    CHECK(near(line_escape.direction(), PI));
+
+    c.y_goal_seen = false;
+    c.escaping = update_lines(robo::LineEscape::back, 10);
+    CHECK(strategy.update(c, 10) == ESCAPE);
+    CHECK(near(line_escape.direction(), PI));
+}
+
+// preemptでない遷移は最短滞在時間が経つまで待つ
+void test_min_dwell()
+{
+    reset_params();
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+    Context c = fresh();
+    c.pose_valid = true;
+    c.margin = 100;
+    CHECK(strategy.update(c, 1000) == ESCAPE);
+    // safe_marginより離れた
+    c.margin = 300;
+    CHECK(strategy.update(c, 1099) == ESCAPE);
+    CHECK(strategy.update(c, 1100) == IDLE);
+    CHECK(strategy.dwell(1150) == 50);
+}
+
+// ROTATEのパワーは、パラメーターを最大にしても100を超えない
+void test_rotate_power()
+{
+    reset_params();
+    NullPort port;
+    robo::Motor motor(&port, no_slew);
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+    Context c = fresh();
+    c.bno_dir = robo::Angle::from_degrees(120);
+    CHECK(strategy.update(c, 0) == ROTATE);
+    m_info.ptr->apply(motor);
+    // 120度(2.09ラジアン) * 25 + 20 = 72
+    CHECK(motor.get_power(1) == -72 || motor.get_power(1) == 72);
+
+    params[param::rotate_gain] = 100;
+    params[param::rotate_base] = 100;
+    CHECK(strategy.update(c, 10) == ROTATE);
+    m_info.ptr->apply(motor);
+    CHECK(motor.get_power(1) == -100 || motor.get_power(1) == 100);
+}
+
+// CHASEの速さはmax_speedに比例する
+void test_chase_speed()
+{
+    reset_params();
+    robo::Strategy<Context> strategy(states, transitions, IDLE);
+    Context c = fresh();
+    robo::openmv::Position ball = robo::openmv::center;
+    ball.x += 30;
+    c.ball_pos = &ball;
+    CHECK(strategy.update(c, 0) == CHASE);
+    const float full = m_info.ptr->velocity().mag();
+    CHECK(full > 0);
+
+    params[param::max_speed] = 40;
+    CHECK(strategy.update(c, 10) == CHASE);
+    CHECK(near(m_info.ptr->velocity().mag(), full * 0.4f));
+}
+
+} // namespace
+
+int main()
+{
+    test_line_after_near_boundary();
+    test_line_first();
+    test_min_dwell();
+    test_rotate_power();
+    test_chase_speed();
+    return check_result();
+}
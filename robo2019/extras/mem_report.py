@@ -0,0 +1,225 @@
+"""
+スケッチをATmega328P向けにビルドし、SRAMの使用量をまとめる
+
+- モジュール(オブジェクトファイル)ごとの .data / .bss
+- loop() (と setup()) から辿れる関数の、最悪ケースのスタック使用量
+  (-fstack-usage の結果と、逆アセンブルした呼び出しグラフから求める)
+- 割り込みハンドラのうち、最もスタックを使うものの使用量
+
+必要なもの: arduino-cli (arduino:avr コア), avr-size, avr-objdump
+
+使い方:
+    python3 extras/mem_report.py ../offense
+    python3 extras/mem_report.py ../offense --json mem.json
+"""
+
+import argparse
+import collections
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+LIB_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+RAM_SIZE = 2048
+# call/rcallで積まれる戻り番地のサイズ
+RETURN_ADDR = 2
+
+FUNC_HEADER = re.compile(r"^[0-9a-f]+ <(.+)>:$")
+CALL = re.compile(r"\s(r?call|r?jmp)\s+[^<]*<([^>+]+)(\+0x[0-9a-f]+)?>")
+INDIRECT = re.compile(r"\s(e?icall|e?ijmp)\b")
+PUSH = re.compile(r"\spush\s")
+FRAME = re.compile(r"\s(?:sbiw\s+r28,\s*0x([0-9a-f]+)|subi\s+r28,\s*0x([0-9a-f]+))")
+
+
+def build(sketch, fqbn, build_dir):
+    flags = "-fstack-usage"
+    subprocess.run(
+        [
+            "arduino-cli", "compile",
+            "--fqbn", fqbn,
+            "--library", LIB_DIR,
+            "--build-path", build_dir,
+            "--build-property", "compiler.c.extra_flags=" + flags,
+            "--build-property", "compiler.cpp.extra_flags=" + flags,
+            sketch,
+        ],
+        check=True,
+        stdout=sys.stderr,
+    )
+    name = os.path.basename(os.path.normpath(sketch))
+    return os.path.join(build_dir, name + ".ino.elf")
+
+
+def module_name(path, build_dir):
+    rel = os.path.relpath(path, build_dir)
+    return re.sub(r"(\.(ino|cpp|c|S))?\.o$", "", rel)
+
+
+def module_sizes(build_dir):
+    objs = [
+        p for p in glob.glob(os.path.join(build_dir, "**", "*.o"), recursive=True)
+        if not os.path.basename(p).startswith("_")
+    ]
+    out = subprocess.run(
+        ["avr-size", "-B"] + objs, check=True, capture_output=True, text=True
+    ).stdout
+    modules = {}
+    for line in out.splitlines()[1:]:
+        cols = line.split()
+        if len(cols) < 6:
+            continue
+        data, bss = int(cols[1]), int(cols[2])
+        if data or bss:
+            modules[module_name(cols[5], build_dir)] = {"data": data, "bss": bss}
+    return modules
+
+
+def bare_name(name):
+    # "void robo::Motor::stop()" / "robo::Motor::stop()" -> "robo::Motor::stop"
+    name = name.split("(")[0]
+    return name.split(" ")[-1]
+
+
+def stack_usage(build_dir):
+    # "<file>:<line>:<col>:<function>\t<bytes>\t<static|dynamic|dynamic,bounded>"
+    frames, dynamic = {}, set()
+    for path in glob.glob(os.path.join(build_dir, "**", "*.su"), recursive=True):
+        with open(path, errors="replace") as f:
+            for line in f:
+                cols = line.rstrip("\n").split("\t")
+                if len(cols) != 3:
+                    continue
+                name = bare_name(cols[0].split(":", 3)[-1])
+                frames[name] = max(frames.get(name, 0), int(cols[1]))
+                if cols[2].startswith("dynamic") and "bounded" not in cols[2]:
+                    dynamic.add(name)
+    return frames, dynamic
+
+
+def call_graph(elf):
+    out = subprocess.run(
+        ["avr-objdump", "-d", "-C", "--no-show-raw-insn", elf],
+        check=True, capture_output=True, text=True,
+    ).stdout
+    calls = collections.defaultdict(set)
+    indirect = set()
+    prologue = {}
+    current, head = None, 0
+    for line in out.splitlines():
+        m = FUNC_HEADER.match(line)
+        if m:
+            current, head = bare_name(m.group(1)), 0
+            prologue[current] = 0
+            continue
+        if current is None:
+            continue
+        m = CALL.search(line)
+        if m:
+            target = bare_name(m.group(2))
+            if target != current:
+                calls[current].add(target)
+        if INDIRECT.search(line):
+            indirect.add(current)
+        # -fstack-usage の結果がない関数(avr-libcなど)用に、プロローグから見積もる
+        head += 1
+        if head <= 24:
+            if PUSH.search(line):
+                prologue[current] += 1
+            m = FRAME.search(line)
+            if m:
+                prologue[current] += int(m.group(1) or m.group(2), 16)
+    return calls, indirect, prologue
+
+
+def worst_path(root, calls, frame_of, indirect):
+    memo = {}
+    notes = {"recursive": set(), "indirect": set()}
+
+    def visit(func, stack):
+        if func in memo:
+            return memo[func]
+        if func in stack:
+            notes["recursive"].add(func)
+            return 0, [func + " (recursion)"]
+        if func in indirect:
+            notes["indirect"].add(func)
+        best, best_path = 0, []
+        stack.add(func)
+        for callee in calls.get(func, ()):
+            depth, path = visit(callee, stack)
+            if depth + RETURN_ADDR > best:
+                best, best_path = depth + RETURN_ADDR, path
+        stack.discard(func)
+        memo[func] = (frame_of(func) + best, [func] + best_path)
+        return memo[func]
+
+    depth, path = visit(root, set())
+    return depth, path, {k: sorted(v) for k, v in notes.items()}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("sketch")
+    parser.add_argument("--fqbn", default="arduino:avr:uno")
+    parser.add_argument("--json", help="JSONの出力先")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as build_dir:
+        elf = build(args.sketch, args.fqbn, build_dir)
+        modules = module_sizes(build_dir)
+        frames, dynamic = stack_usage(build_dir)
+        calls, indirect, prologue = call_graph(elf)
+
+    def frame_of(func):
+        return frames[func] if func in frames else prologue.get(func, 0)
+
+    roots = {}
+    for root in ("setup", "loop"):
+        depth, path, notes = worst_path(root, calls, frame_of, indirect)
+        # main() -> loop() の分の戻り番地と、main()のフレーム
+        roots[root] = {"depth": depth + RETURN_ADDR + frame_of("main"), "path": path, **notes}
+    isr_depth, isr_name = 0, None
+    for func in calls.keys() | prologue.keys():
+        if func.startswith("__vector_"):
+            depth, _, _ = worst_path(func, calls, frame_of, indirect)
+            if depth > isr_depth:
+                isr_depth, isr_name = depth, func
+
+    static = sum(m["data"] + m["bss"] for m in modules.values())
+    worst = max(r["depth"] for r in roots.values()) + isr_depth + RETURN_ADDR
+    report = {
+        "ram": RAM_SIZE,
+        "static": static,
+        "modules": modules,
+        "stack": roots,
+        "isr": {"name": isr_name, "depth": isr_depth},
+        "stack_worst": worst,
+        "headroom": RAM_SIZE - static - worst,
+        "dynamic_frames": sorted(dynamic),
+    }
+
+    print("%-48s %6s %6s" % ("module", ".data", ".bss"))
+    for name, m in sorted(modules.items(), key=lambda kv: -(kv[1]["data"] + kv[1]["bss"])):
+        print("%-48s %6d %6d" % (name, m["data"], m["bss"]))
+    print("%-48s %13d" % ("total (.data + .bss)", static))
+    print()
+    for root, r in roots.items():
+        print("worst-case stack of %s(): %d bytes" % (root, r["depth"]))
+        print("  " + " -> ".join(r["path"]))
+        if r["indirect"]:
+            print("  (indirect calls not followed in: %s)" % ", ".join(r["indirect"]))
+    print("deepest ISR: %s, %d bytes" % (isr_name, isr_depth))
+    print("headroom (RAM - static - stack - ISR): %d bytes (heap must fit here)" % report["headroom"])
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
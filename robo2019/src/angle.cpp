@@ -0,0 +1,38 @@
+#include <Arduino.h>
+#include "angle.h"
+
+namespace {
+    // sin(k * PI / 128) * 32767 (k = 0..64)
+    const int16_t sin_table[65] PROGMEM = {
+        0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+        6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+        12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+        18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+        23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+        27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+        30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+        32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+        32767,
+    };
+
+    // 1/4周期(0..0x4000)の範囲のsinを、表の間を線形補間して求める
+    int16_t quarter_sin(uint16_t p)
+    {
+        const uint8_t i = p >> 8, f = p & 0xff;
+        const int16_t a = pgm_read_word(&sin_table[i]);
+        if (f == 0) return a;
+        const int16_t b = pgm_read_word(&sin_table[i + 1]);
+        return a + int16_t((int32_t(b - a) * f) >> 8);
+    }
+}
+
+constexpr uint16_t robo::Angle::quarter_turn;
+constexpr uint16_t robo::Angle::half_turn;
+
+int16_t robo::Angle::sin() const
+{
+    uint16_t p = _raw & (quarter_turn - 1);
+    if (_raw & quarter_turn) p = quarter_turn - p;
+    const int16_t s = quarter_sin(p);
+    return (_raw & half_turn) ? -s : s;
+}
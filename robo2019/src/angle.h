@@ -0,0 +1,144 @@
+/**
+ * @file angle.h
+ * @brief 1周を65536とする整数の角度型
+ */
+
+#pragma once
+
+#ifndef ROBO2019_ANGLE_H
+#define ROBO2019_ANGLE_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Angle
+ * @brief 1周を65536とする整数の角度(バイナリ角度)
+ * @details
+ *  uint16_tがあふれるのと1周するのが同じなので、足し算・引き算で-PI..PIに直す必要がない。
+ *  例えば起動したときの向きとの差は`now - offset`だけで求まり、359度と1度の差は-2度になる。
+ *  sin/cosは1/4周期の表から引くので、浮動小数点数の計算をしない。
+ *
+ *  向きの定義はREADMEと同じで、0が正面、左回りが正。
+ *  比較演算子は差を-180度..180度に直して比べる(`a < b`はaがbより右回り側にあるということ)。
+ *  このため、半周以上離れた角度どうしの比較には意味がない。
+ * @note
+ *  ```C++
+ *  robo::Angle offset = bno055.get_heading();
+ *  robo::Angle dir = bno055.get_heading() - offset;
+ *  if (!dir.within(robo::Angle::from_degrees(15))) motor.set_rotate(dir > robo::Angle(), 30);
+ *  ```
+ */
+class Angle
+{
+public:
+    //! 1/4周(90度)
+    static constexpr uint16_t quarter_turn = 0x4000;
+    //! 半周(180度)
+    static constexpr uint16_t half_turn = 0x8000;
+
+private:
+    uint16_t _raw;
+
+    constexpr explicit Angle(uint16_t raw) : _raw(raw) {}
+
+    // u / 32767 を四捨五入する。割り算の代わりに、32767 = 32768 * (1 - 1/32768) を使ってシフトで求める
+    static constexpr uint32_t unscale_abs(uint32_t u) { return (u + ((u + 16384) >> 15) + 16384) >> 15; }
+
+public:
+    /** @brief 0(正面)で初期化 */
+    constexpr Angle() : _raw(0) {}
+
+    /**
+     * @brief 1周を65536とする値から作る
+     * @param[in] raw 値
+     */
+    static constexpr Angle from_raw(uint16_t raw) { return Angle(raw); }
+    /**
+     * @brief ラジアンから作る
+     * @param[in] rad 角度(ラジアン、-2PI..2PI)
+     */
+    static constexpr Angle from_radians(float rad) { return Angle(uint16_t(int32_t(rad * (32768.0f / PI)))); }
+    /**
+     * @brief 度から作る
+     * @param[in] deg 角度(度)
+     */
+    static constexpr Angle from_degrees(int16_t deg) { return Angle(uint16_t(int32_t(deg) * 65536 / 360)); }
+
+    /** @brief 1周を65536とする値(0..65535) */
+    constexpr uint16_t raw() const { return _raw; }
+    /** @brief 1周を65536とする値(-32768..32767) */
+    constexpr int16_t signed_raw() const { return int16_t(_raw); }
+    /** @brief ラジアン(-PI..PI) */
+    float to_radians() const { return signed_raw() * (PI / 32768); }
+    /** @brief 度(-180..180、四捨五入) */
+    int16_t to_degrees() const { return int16_t((int32_t(signed_raw()) * 360 + 0x8000) >> 16); }
+
+    /** @brief 大きさ(0..半周)。向きを問わずに正面からのずれを見るときに使う */
+    constexpr Angle magnitude() const { return Angle(signed_raw() < 0 ? uint16_t(-_raw) : _raw); }
+    /**
+     * @brief 正面(0)からのずれがtolerance以内かどうか
+     * @param[in] tolerance 許すずれ(0..半周)
+     */
+    constexpr bool within(Angle tolerance) const { return magnitude()._raw <= tolerance._raw; }
+
+    /**
+     * @brief sinを表から引く
+     * @return int16_t sinの値を32767倍したもの
+     */
+    int16_t sin() const;
+    /**
+     * @brief cosを表から引く
+     * @return int16_t cosの値を32767倍したもの
+     */
+    int16_t cos() const { return Angle(_raw + quarter_turn).sin(); }
+
+    /**
+     * @brief sin()/cos()を掛けた値を、32767で割って元の大きさに戻す
+     * @param[in] v 値 * sin()などの積(絶対値は32767 * 32767まで)
+     * @return int32_t v / 32767を四捨五入したもの(正負で対称)
+     * @details >> 15で割ると、sin()が32767のときに100が99になり、負の値は切り捨てで大きさが1ずれる
+     * @note
+     *  ```C++
+     *  int16_t x = robo::Angle::unscale(int32_t(speed) * dir.cos());
+     *  ```
+     */
+    static constexpr int32_t unscale(int32_t v)
+    {
+        return v < 0 ? -int32_t(unscale_abs(uint32_t(-v))) : int32_t(unscale_abs(uint32_t(v)));
+    }
+
+    constexpr Angle operator-() const { return Angle(uint16_t(-_raw)); }
+    constexpr Angle operator+(Angle rh) const { return Angle(uint16_t(_raw + rh._raw)); }
+    constexpr Angle operator-(Angle rh) const { return Angle(uint16_t(_raw - rh._raw)); }
+    /** @brief -180度..180度とみなして掛ける */
+    constexpr Angle operator*(int16_t k) const { return Angle(uint16_t(int32_t(signed_raw()) * k)); }
+    /** @brief -180度..180度とみなして割る */
+    constexpr Angle operator/(int16_t k) const { return Angle(uint16_t(signed_raw() / k)); }
+    Angle &operator+=(Angle rh) { _raw += rh._raw; return *this; }
+    Angle &operator-=(Angle rh) { _raw -= rh._raw; return *this; }
+
+    constexpr bool operator==(Angle rh) const { return _raw == rh._raw; }
+    constexpr bool operator!=(Angle rh) const { return _raw != rh._raw; }
+    constexpr bool operator<(Angle rh) const { return int16_t(_raw - rh._raw) < 0; }
+    constexpr bool operator>(Angle rh) const { return int16_t(_raw - rh._raw) > 0; }
+    constexpr bool operator<=(Angle rh) const { return int16_t(_raw - rh._raw) <= 0; }
+    constexpr bool operator>=(Angle rh) const { return int16_t(_raw - rh._raw) >= 0; }
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_ANGLE_H */
@@ -1,22 +1,324 @@
 #include <Arduino.h>
+#include <EEPROM.h>
+#include <avr/eeprom.h>
 #include "bno055.h"
 
-void robo::BNO055::setup()
+namespace {
+    // EEPROMに保存する形式
+    struct StoredCalibration {
+        //! 識別子('B', 'N')
+        uint16_t magic;
+        //! 形式のバージョン
+        uint8_t version;
+        adafruit_bno055_offsets_t offsets;
+        //! magicからoffsetsまでのCRC-8
+        uint8_t crc;
+    };
+
+    constexpr uint16_t calibration_magic = ('N' << 8) | 'B';
+
+    // レジスタ(データシート 4.2)
+    namespace reg {
+        constexpr uint8_t chip_id = 0x00;
+        constexpr uint8_t page_id = 0x07;
+        constexpr uint8_t euler_h_lsb = 0x1A;
+        constexpr uint8_t calib_stat = 0x35;
+        constexpr uint8_t accel_offset_x_lsb = 0x55;
+        constexpr uint8_t opr_mode = 0x3D;
+        constexpr uint8_t pwr_mode = 0x3E;
+        constexpr uint8_t sys_trigger = 0x3F;
+    }
+    constexpr uint8_t chip_id = 0xA0;
+    constexpr uint8_t opr_mode_config = 0x00;
+    constexpr uint8_t opr_mode_ndof = 0x0C;
+    // システム・ジャイロ・加速度・地磁気がすべて3
+    constexpr uint8_t calib_stat_full = 0xFF;
+    constexpr uint8_t pwr_mode_normal = 0x00;
+    constexpr uint8_t sys_trigger_reset = 0x20;
+    constexpr uint8_t sys_trigger_ext_crystal = 0x80;
+
+    // init_step()の手順
+    enum : uint8_t {
+        init_probe,     // チップIDを確かめ、CONFIGモードにする
+        init_reset,     // リセットする
+        init_wait_id,   // リセット後、チップIDが読めるまで待つ
+        init_power,     // 通常の電源モードにする
+        init_crystal,   // 外部の水晶を使う
+        init_calib,     // 較正値を書き戻し、NDOFモードにする
+        init_done,
+    };
+    // リセット後に応答するまでの時間の上限(ミリ秒)
+    constexpr uint16_t init_id_timeout = 1000;
+    // 較正の状態を確かめる間隔(ミリ秒)
+    constexpr uint16_t autosave_interval = 1000;
+
+    // autosave()の手順
+    enum : uint8_t {
+        save_check,  // 較正の状態を確かめ、終わっていればCONFIGモードにする
+        save_read,   // 較正値を1つずつ読む
+        save_resume, // NDOFモードに戻り、フュージョンの出力が戻るまで待つ
+        save_write,  // EEPROMに1バイトずつ書く
+    };
+    // CONFIGモードに切り替わるまでの時間(ミリ秒、データシート 3.3.1では19ms)
+    constexpr uint8_t config_switch_ms = 25;
+    // NDOFモードに戻してから、方向を読み始めるまでの時間(ミリ秒、切り替えは7ms)
+    constexpr uint8_t resume_ms = 20;
+
+    // オフセットのレジスタの順(accel_offset_x_lsbから2バイトずつ)
+    int16_t adafruit_bno055_offsets_t::*const offset_fields[] = {
+        &adafruit_bno055_offsets_t::accel_offset_x,
+        &adafruit_bno055_offsets_t::accel_offset_y,
+        &adafruit_bno055_offsets_t::accel_offset_z,
+        &adafruit_bno055_offsets_t::mag_offset_x,
+        &adafruit_bno055_offsets_t::mag_offset_y,
+        &adafruit_bno055_offsets_t::mag_offset_z,
+        &adafruit_bno055_offsets_t::gyro_offset_x,
+        &adafruit_bno055_offsets_t::gyro_offset_y,
+        &adafruit_bno055_offsets_t::gyro_offset_z,
+        &adafruit_bno055_offsets_t::accel_radius,
+        &adafruit_bno055_offsets_t::mag_radius,
+    };
+    constexpr uint8_t offset_count = sizeof(offset_fields) / sizeof(offset_fields[0]);
+
+    uint8_t stored_crc(const StoredCalibration &stored)
+    {
+        return robo::crc8(reinterpret_cast<const uint8_t *>(&stored), offsetof(StoredCalibration, crc));
+    }
+
+    // 較正値からEEPROMに保存する形式を作る
+    void make_stored(StoredCalibration &stored, const adafruit_bno055_offsets_t &offsets)
+    {
+        stored.magic = calibration_magic;
+        stored.version = robo::BNO055::calibration_version;
+        stored.offsets = offsets;
+        stored.crc = stored_crc(stored);
+    }
+}
+
+constexpr uint8_t robo::BNO055::calibration_version;
+
+void robo::BNO055::setup(bool restore)
 {
     _detected = Adafruit_BNO055::begin();
     Adafruit_BNO055::setExtCrystalUse(true);
+    _restored = restore && restore_calibration();
 }
 
-float robo::BNO055::get_geomag_direction()
+void robo::BNO055::write_reg(uint8_t r, uint8_t value)
 {
-    if (!_detected) { return 0.; }
-    float dir_degree = Adafruit_BNO055::getVector(Adafruit_BNO055::VECTOR_EULER).x();
-    float dir_radian = (
+    Wire.beginTransmission(_address);
+    Wire.write(r);
+    Wire.write(value);
+    Wire.endTransmission();
+}
+
+uint8_t robo::BNO055::read_reg(uint8_t r)
+{
+    Wire.beginTransmission(_address);
+    Wire.write(r);
+    if (Wire.endTransmission() != 0) return 0;
+    if (Wire.requestFrom(_address, uint8_t(1)) != 1) return 0;
+    return Wire.read();
+}
+
+bool robo::BNO055::read_regs(uint8_t r, uint8_t *dst, uint8_t len)
+{
+    Wire.beginTransmission(_address);
+    Wire.write(r);
+    if (Wire.endTransmission() != 0) return false;
+    if (Wire.requestFrom(_address, len) != len) return false;
+    for (uint8_t i = 0; i < len; i++) dst[i] = Wire.read();
+    return true;
+}
+
+robo::InitStatus robo::BNO055::init_step(uint32_t now, bool restore)
+{
+    if (_init_state == init_done) return _detected ? robo::init_ready : robo::init_failed;
+    if (_init_state != init_probe && int32_t(now - _init_wait) < 0) return robo::init_pending;
+    switch (_init_state) {
+    case init_probe:
+        if (_init_since == 0) {
+            Wire.begin();
+            _init_since = now;
+            _init_restore = restore;
+        }
+        // 電源を入れてから応答するまで0.65秒ほどかかる
+        if (read_reg(reg::chip_id) != chip_id) {
+            if (now - _init_since >= init_id_timeout) {
+                _init_state = init_done;
+                return robo::init_failed;
+            }
+            _init_wait = now + 10;
+            return robo::init_pending;
+        }
+        write_reg(reg::opr_mode, opr_mode_config);
+        _init_wait = now + 30;
+        _init_state = init_reset;
+        break;
+    case init_reset:
+        write_reg(reg::sys_trigger, sys_trigger_reset);
+        _init_wait = now + 30;
+        _init_since = now;
+        _init_state = init_wait_id;
+        break;
+    case init_wait_id:
+        if (read_reg(reg::chip_id) != chip_id) {
+            if (now - _init_since >= init_id_timeout) {
+                _init_state = init_done;
+                return robo::init_failed;
+            }
+            _init_wait = now + 10;
+            return robo::init_pending;
+        }
+        _init_wait = now + 50;
+        _init_state = init_power;
+        break;
+    case init_power:
+        write_reg(reg::pwr_mode, pwr_mode_normal);
+        _init_wait = now + 10;
+        _init_state = init_crystal;
+        break;
+    case init_crystal:
+        write_reg(reg::page_id, 0);
+        write_reg(reg::sys_trigger, sys_trigger_ext_crystal);
+        _init_wait = now + 10;
+        _init_state = init_calib;
+        break;
+    case init_calib: {
+        // CONFIGモードのままなので、オフセットのレジスタに直接書き込める
+        adafruit_bno055_offsets_t offsets;
+        if (_init_restore && read_calibration(robo::profile::eeprom::bno055_calibration, offsets)) {
+            const int16_t values[] = {
+                offsets.accel_offset_x, offsets.accel_offset_y, offsets.accel_offset_z,
+                offsets.mag_offset_x, offsets.mag_offset_y, offsets.mag_offset_z,
+                offsets.gyro_offset_x, offsets.gyro_offset_y, offsets.gyro_offset_z,
+                offsets.accel_radius, offsets.mag_radius,
+            };
+            uint8_t r = reg::accel_offset_x_lsb;
+            for (int16_t v : values) {
+                write_reg(r++, v & 0xff);
+                write_reg(r++, (v >> 8) & 0xff);
+            }
+            _restored = true;
+        }
+        Adafruit_BNO055::setMode(OPERATION_MODE_NDOF);
+        _detected = true;
+        _init_state = init_done;
+        return robo::init_ready;
+    }
+    }
+    return robo::init_pending;
+}
+
+bool robo::BNO055::read_calibration(uint16_t address, adafruit_bno055_offsets_t &dst)
+{
+    StoredCalibration stored;
+    EEPROM.get(address, stored);
+    if (stored.magic != calibration_magic
+        || stored.version != calibration_version
+        || stored.crc != stored_crc(stored)) {
+        return false;
+    }
+    dst = stored.offsets;
+    return true;
+}
+
+bool robo::BNO055::restore_calibration(uint16_t address)
+{
+    if (!_detected) return false;
+    adafruit_bno055_offsets_t offsets;
+    if (!read_calibration(address, offsets)) return false;
+    // setSensorOffsets()はCONFIGモードに切り替えて書き込み、元のモードに戻す
+    Adafruit_BNO055::setSensorOffsets(offsets);
+    return true;
+}
+
+bool robo::BNO055::save_calibration(uint16_t address)
+{
+    if (!_detected || !Adafruit_BNO055::isFullyCalibrated()) return false;
+    adafruit_bno055_offsets_t offsets;
+    if (!Adafruit_BNO055::getSensorOffsets(offsets)) return false;
+    StoredCalibration stored;
+    make_stored(stored, offsets);
+    EEPROM.put(address, stored);
+    _saved = true;
+    return true;
+}
+
+bool robo::BNO055::autosave(uint32_t now, bool allow_config)
+{
+    if (!_detected) return false;
+    if (_save_state != save_check && int32_t(now - _save_wait) < 0) return false;
+    switch (_save_state) {
+    case save_check:
+        if (now - _last_check < autosave_interval) return false;
+        _last_check = now;
+        _calib_stat = read_reg(reg::calib_stat);
+        if (_saved || _calib_stat != calib_stat_full || !allow_config) return false;
+        // オフセットのレジスタはCONFIGモードでしか読めない
+        write_reg(reg::opr_mode, opr_mode_config);
+        _save_wait = now + config_switch_ms;
+        _save_index = 0;
+        _save_state = save_read;
+        return false;
+    case save_read: {
+        uint8_t buff[2];
+        const bool ok = read_regs(reg::accel_offset_x_lsb + 2 * _save_index, buff, 2);
+        if (ok) _save_offsets.*offset_fields[_save_index++] = int16_t((uint16_t(buff[1]) << 8) | buff[0]);
+        if (ok && _save_index < offset_count) return false;
+        // 読み終わったか、読めなかった => NDOFモードに戻す
+        write_reg(reg::opr_mode, opr_mode_ndof);
+        _save_wait = now + resume_ms;
+        _save_state = save_resume;
+        return false;
+    }
+    case save_resume:
+        // 読めなかったときは、次に較正の状態を確かめたときに読み直す
+        _save_state = _save_index < offset_count ? save_check : save_write;
+        _save_index = 0;
+        return false;
+    case save_write: {
+        // 前のバイトを書き終わるまで(3.3ms)は待たずに戻る
+        if (!eeprom_is_ready()) return false;
+        StoredCalibration stored;
+        make_stored(stored, _save_offsets);
+        EEPROM.update(robo::profile::eeprom::bno055_calibration + _save_index,
+            reinterpret_cast<const uint8_t *>(&stored)[_save_index]);
+        if (++_save_index < sizeof(stored)) return false;
+        _saved = true;
+        _save_state = save_check;
+        return true;
+    }
+    }
+    return false;
+}
+
+void robo::BNO055::calibration_to_string(char *dst)
+{
+    if (!_detected) {
+        strcpy_P(dst, PSTR("no bno"));
+        return;
+    }
+    // CALIB_STATは上位から2ビットずつシステム・ジャイロ・加速度・地磁気
+    sprintf_P(dst, PSTR("S%uG%uA%uM%u%s"),
+        _calib_stat >> 6, (_calib_stat >> 4) & 3, (_calib_stat >> 2) & 3, _calib_stat & 3,
+        _saved ? "W" : _restored ? "R" : "");
+}
+
+float robo::BNO055::euler_to_direction(float dir_degree)
+{
+    return (
         (0 <= dir_degree && dir_degree <= 180)
         ? dir_degree
         : dir_degree - 360
     ) * -PI / 180;
-    return dir_radian;
+}
+
+float robo::BNO055::get_geomag_direction()
+{
+    if (!_detected) { return 0.; }
+    float dir_degree = Adafruit_BNO055::getVector(Adafruit_BNO055::VECTOR_EULER).x();
+    return euler_to_direction(dir_degree);
 }
 void robo::BNO055::get_geomag_direction(float *dst)
 {
@@ -27,11 +329,28 @@ void robo::BNO055::get_geomag_direction(float *dst)
         return;
     }
     float dir_degree = Adafruit_BNO055::getVector(Adafruit_BNO055::VECTOR_EULER).x();
-    res = (
-        (0 <= dir_degree && dir_degree <= 180)
-        ? dir_degree
-        : dir_degree - 360
-    ) * -PI / 180;
+    res = euler_to_direction(dir_degree);
+}
+
+robo::Angle robo::BNO055::euler_to_angle(int16_t heading_16)
+{
+    // 5760(360度)を65536にする。右回りが正なので符号を反転する
+    return robo::Angle::from_raw(uint16_t(-(int32_t(heading_16) * 512 / 45)));
+}
+
+robo::Angle robo::BNO055::get_heading()
+{
+    if (!_detected) return robo::Angle();
+    // CONFIGモードの間はフュージョンの出力が止まる
+    if (_save_state == save_read || _save_state == save_resume) return _heading;
+    Wire.beginTransmission(_address);
+    Wire.write(reg::euler_h_lsb);
+    if (Wire.endTransmission() != 0) return robo::Angle();
+    if (Wire.requestFrom(_address, uint8_t(2)) != 2) return robo::Angle();
+    const uint8_t lsb = Wire.read();
+    const uint8_t msb = Wire.read();
+    _heading = euler_to_angle(int16_t((uint16_t(msb) << 8) | lsb));
+    return _heading;
 }
 
 bool robo::BNO055::detected()
@@ -15,6 +15,9 @@
 #include <Adafruit_BNO055.h>
 #include <utility/imumaths.h>
 
+#include "angle.h"
+#include "boot.h"
+#include "profile.h"
 #include "util.h"
 
 /**
@@ -26,12 +29,30 @@ namespace robo {
 /**
  * @class BNO055
  * @brief Adafruit_BNO055の子クラス
+ * @details
+ *  起動するたびに較正し直すと、機体を動かして較正が終わるまで数秒以上かかり、その間は方向がずれる。
+ *  そこで、較正が終わったときのオフセットと半径をEEPROMに保存しておき、次の起動時に書き戻す。
+ *  EEPROMの値は、先頭の識別子、形式のバージョン、CRC-8で確かめ、どれかが合わなければ使わない。
+ *
+ *  Adafruit_BNO055::begin()は合わせて0.7秒ほどdelay()で待つ。init_step()は同じ手順を、
+ *  待ち時間の間は戻ってくる状態機械で行うので、robo::Bootで他のデバイスと並べて起動できる。
+ *  autosave()も同じように、較正値を読んでEEPROMに書く手順を1回の呼び出しで1歩ずつ進める。
  */
 class BNO055 final : public virtual Adafruit_BNO055
 {
 private:
+    //! I2Cアドレス
+    const uint8_t _address;
     //! bnoを検知したかどうか
     bool _detected = false;
+    //! init_step()の手順の番号
+    uint8_t _init_state = 0;
+    //! init_step()で次の手順に進める時刻(ミリ秒)
+    uint32_t _init_wait = 0;
+    //! init_step()で応答を待ち始めた時刻(ミリ秒)
+    uint32_t _init_since = 0;
+    //! init_step()でEEPROMの較正値を書き戻すかどうか
+    bool _init_restore = true;
     //! 最新の、ジャイロセンサーで算出した方向
     float _last_gyro_dir = 0;
     /**
@@ -39,15 +60,119 @@ private:
      * @details `0`が指す向きの、最初の向きとのズレ
      */
     float _geomag_diff = 0;
+    //! EEPROMから較正値を書き戻したかどうか
+    bool _restored = false;
+    //! この起動中にEEPROMへ較正値を保存したかどうか
+    bool _saved = false;
+    //! autosave()で最後に較正の状態を確かめた時刻(ミリ秒)
+    uint32_t _last_check = 0;
+    //! autosave()で最後に読んだ較正の状態(CALIB_STATレジスタの値)
+    uint8_t _calib_stat = 0;
+    //! autosave()の手順の番号
+    uint8_t _save_state = 0;
+    //! autosave()で次に読むオフセット、または次に書くEEPROMのバイトの番号
+    uint8_t _save_index = 0;
+    //! autosave()で次の手順に進める時刻(ミリ秒)
+    uint32_t _save_wait = 0;
+    //! autosave()で読んだ較正値
+    adafruit_bno055_offsets_t _save_offsets;
+    //! 最後に読めた方向(autosave()がCONFIGモードにしている間はこれを返す)
+    robo::Angle _heading;
+
+    void write_reg(uint8_t reg, uint8_t value);
+    uint8_t read_reg(uint8_t reg);
+    bool read_regs(uint8_t reg, uint8_t *dst, uint8_t len);
+    static bool read_calibration(uint16_t address, adafruit_bno055_offsets_t &dst);
 
 public:
-    using Adafruit_BNO055::Adafruit_BNO055;
+    /**
+     * @brief Construct a new BNO055 object
+     * @param[in] sensor_id Adafruit_Sensorのセンサー番号
+     * @param[in] address I2Cアドレス
+     */
+    BNO055(int32_t sensor_id = -1, uint8_t address = 0x28)
+        : Adafruit_BNO055(sensor_id, address), _address(address) {}
+
+    /**
+     * @brief オイラー角のx成分(度数法)を方向(ラジアン)に変換する
+     * @param[in] dir_degree BNO055が返すオイラー角のx成分。0以上360未満
+     * @return 方向。-PI以上PI以下で、反時計回りが正
+     */
+    static float euler_to_direction(float dir_degree);
+    /**
+     * @brief オイラー角のx成分(1/16度単位のレジスタの値)を方向に変換する
+     * @param[in] heading_16 BNO055のEUL_Headingレジスタの値(0以上5760未満、右回りが正)
+     * @return 方向。反時計回りが正
+     */
+    static robo::Angle euler_to_angle(int16_t heading_16);
+
+    //! EEPROMに保存する較正値の形式のバージョン。形式を変えたら上げる
+    static constexpr uint8_t calibration_version = 1;
 
     /**
      * @brief bno055のセットアップを行う
+     * @param[in] restore trueならEEPROMに保存した較正値を書き戻す
      * @note 全体のsetup内で呼ばないと他の機能が使えない
      */
-    void setup();
+    void setup(bool restore = true);
+
+    /**
+     * @brief setup()と同じ起動処理を、待たずに1歩進める
+     * @param[in] now 現在時刻(ミリ秒)
+     * @param[in] restore trueならEEPROMに保存した較正値を書き戻す(最初の呼び出しのときだけ見る)
+     * @return InitStatus 起動処理の状態
+     * @details
+     *  robo::Bootから、init_readyかinit_failedを返すまで繰り返し呼ぶ。
+     *  最後にNDOFモードへ切り替えるときだけ、Adafruit_BNO055の状態を合わせるため30ms待つ。
+     */
+    robo::InitStatus init_step(uint32_t now, bool restore = true);
+
+    /**
+     * @brief EEPROMに保存した較正値を書き戻す
+     * @param[in] address EEPROMのアドレス
+     * @return bool 書き戻したらtrue。保存されていないか、壊れていたらfalse
+     */
+    bool restore_calibration(uint16_t address = robo::profile::eeprom::bno055_calibration);
+
+    /**
+     * @brief 今の較正値をEEPROMに保存する
+     * @param[in] address EEPROMのアドレス
+     * @return bool 保存したらtrue。較正が終わっていなければ保存しない
+     * @note 値が変わったバイトだけを書き込む(EEPROM.put())
+     * @warning 較正値を読むためにCONFIGモードに切り替えるので、60ミリ秒ほど戻らず、その間は方向も読めない。
+     *  EEPROMへの書き込みも、変わったバイトごとに3.3ミリ秒待つ。制御の途中ではautosave()を使う
+     */
+    bool save_calibration(uint16_t address = robo::profile::eeprom::bno055_calibration);
+
+    /**
+     * @brief 定期的に呼んで、較正が終わったら1度だけEEPROMに保存する
+     * @param[in] now 現在時刻(ミリ秒)
+     * @param[in] allow_config 較正値を読み始めてよいか(機体が止まっているときなどにtrue)
+     * @return bool この呼び出しで保存し終えたらtrue
+     * @details
+     *  較正の状態は1秒に1回読み、calibration_to_string()のために覚えておく。
+     *  1回の呼び出しでは、数バイトのI2Cの通信と、EEPROMの1バイトの書き込みまでしか行わない。
+     *  EEPROMの書き込みは終わるのを待たず、前のバイトが終わっていなければ次の呼び出しに回す。
+     *
+     *  較正値を読む間(100Hzで呼んで150ミリ秒ほど)はCONFIGモードになり、フュージョンの出力が止まる。
+     *  その間get_heading()は、CONFIGモードにする前に読めた方向を返す。
+     *  そのため、allow_configがfalseの間はCONFIGモードにしない(読み始めた後はfalseになっても続ける)。
+     */
+    bool autosave(uint32_t now, bool allow_config = true);
+
+    /**
+     * @brief 較正の状態を文字列にする
+     * @param[out] dst 書き込む先(10文字以上)
+     * @details "S3G3A3M3"のように、システム・ジャイロ・加速度・地磁気の較正の度合い(0-3)を並べる。
+     *  EEPROMから書き戻したときは末尾に'R'、この起動中に保存したときは'W'をつける。
+     *  I2Cでは読まず、autosave()が最後に読んだ状態を使う
+     */
+    void calibration_to_string(char *dst);
+
+    /** @brief EEPROMから較正値を書き戻したかどうか */
+    bool restored() const { return _restored; }
+    /** @brief この起動中にEEPROMへ較正値を保存したかどうか */
+    bool saved() const { return _saved; }
     /**
      * @brief 現在向いている方向をラジアンで取得
      * @return 現在向いている方向
@@ -60,6 +185,15 @@ public:
      * @note ラジアンの値は、0を最初の向きとして、そこから正回転が反時計回り
      */
     void get_geomag_direction(float *dst);
+    /**
+     * @brief 現在向いている方向を取得
+     * @return 現在向いている方向(見つからなければ0)
+     * @details
+     *  オイラー角のx成分のレジスタ(2バイト)だけを読み、浮動小数点数に変換しない。
+     *  起動したときの向きとの差は`get_heading() - offset`で求まる(1周で自然に折り返す)。
+     *  autosave()が較正値を読んでいる間は、I2Cで読まずに最後に読めた方向を返す
+     */
+    robo::Angle get_heading();
 
     /**
      * @fn bool detected()
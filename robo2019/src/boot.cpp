@@ -0,0 +1,60 @@
+#include <Arduino.h>
+#include "boot.h"
+
+void robo::Boot::start(uint32_t now)
+{
+    _start = now;
+    _done = false;
+    for (uint8_t i = 0; i < _count; i++) {
+        _devices[i].status = init_pending;
+        _devices[i].elapsed = 0;
+    }
+    poll(now);
+}
+
+bool robo::Boot::poll(uint32_t now)
+{
+    if (_done) return true;
+    bool done = true;
+    const uint32_t elapsed = now - _start;
+    for (uint8_t i = 0; i < _count; i++) {
+        BootDevice &device = _devices[i];
+        if (device.status != init_pending) continue;
+        device.status = device.callback(now);
+        if (device.status == init_pending && elapsed >= device.timeout) {
+            device.status = init_failed;
+        }
+        if (device.status == init_pending) {
+            done = false;
+        } else {
+            device.elapsed = elapsed > 0xffff ? 0xffff : elapsed;
+        }
+    }
+    _done = done;
+    return done;
+}
+
+bool robo::Boot::run(uint16_t budget)
+{
+    const uint32_t start = millis();
+    while (!poll(millis())) {
+        if (millis() - start >= budget) return false;
+    }
+    return true;
+}
+
+void robo::Boot::print_report(Print &out) const
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        const BootDevice &device = _devices[i];
+        out.print(F("boot "));
+        out.print(reinterpret_cast<const __FlashStringHelper *>(device.name));
+        out.print(' ');
+        out.print(
+            device.status == init_ready ? F("ready")
+            : device.status == init_failed ? F("failed")
+            : F("pending"));
+        out.print(' ');
+        out.println(device.elapsed);
+    }
+}
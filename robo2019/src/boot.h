@@ -0,0 +1,167 @@
+/**
+ * @file boot.h
+ * @brief 各デバイスの起動処理を少しずつ交互に進める、起動シーケンサーのクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_BOOT_H
+#define ROBO2019_BOOT_H
+
+#ifdef ARDUINO
+
+#include <Print.h>
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/** @brief デバイスの起動処理の状態 */
+enum InitStatus : uint8_t {
+    //! 起動中
+    init_pending,
+    //! 使える
+    init_ready,
+    //! 見つからないか、時間内に起動しなかった
+    init_failed,
+};
+
+/**
+ * @class BootDevice
+ * @brief 起動シーケンサーで起動するデバイス
+ * @details 起動にかかった時間もここに記録される
+ */
+class BootDevice
+{
+public:
+    /**
+     * @brief 起動処理を1歩進める
+     * @param now 現在時刻(ミリ秒)
+     * @return 起動処理の状態
+     * @note 待つ必要があるときはdelay()せずにinit_pendingを返し、次に呼ばれたときに時刻を確かめる
+     */
+    using Callback = InitStatus (*)(uint32_t now);
+
+    //! デバイスの名前(PROGMEMの文字列)
+    const char *const name;
+    //! 起動処理
+    const Callback callback;
+    //! この時間(ミリ秒)までに起動しなければinit_failedにする
+    const uint16_t timeout;
+
+    //! 起動処理の状態
+    InitStatus status = init_pending;
+    //! 起動が終わるまでの時間(ミリ秒)
+    uint16_t elapsed = 0;
+
+    /**
+     * @brief Construct a new BootDevice object
+     * @param[in] name デバイスの名前(PROGMEMの文字列。F()はグローバル変数の初期化に使えない)
+     * @param[in] callback 起動処理
+     * @param[in] timeout この時間(ミリ秒)までに起動しなければinit_failedにする
+     */
+    BootDevice(const char *name, Callback callback, uint16_t timeout = 2000)
+        : name(name), callback(callback), timeout(timeout) {}
+};
+
+/**
+ * @class Boot
+ * @brief 起動シーケンサー
+ * @details
+ *  BNO055やLCDの起動処理には、合わせて1秒以上の決まった待ち時間がある。1つずつ順に起動すると、
+ *  試合中にリセットされたとき、その間ずっと機体が止まったままになる。
+ *  そこで各デバイスの起動処理を、待ち時間の間は戻ってくる状態機械(BootDevice::Callback)にし、
+ *  poll()を呼ぶたびにまだ起動していないデバイスを1歩ずつ進める。
+ *  poll()はloop()の中で呼べるので、起動の遅いデバイスを待たずに制御を始められる。
+ *  起動していないデバイスは、それぞれのクラスが「見つからない」ときと同じように振る舞う。
+ * @note
+ *  ```C++
+ *  robo::InitStatus init_bno055(uint32_t now) { return bno055.init_step(now); }
+ *  const char bno055_name[] PROGMEM = "bno055";
+ *  robo::BootDevice devices[] = {
+ *      robo::BootDevice(bno055_name, init_bno055, 1500),
+ *  };
+ *  robo::Boot boot(devices);
+ *  void setup() { boot.start(millis()); }
+ *  void loop() {
+ *      if (!boot.done() && boot.poll(millis())) boot.print_report(Serial);
+ *      // 制御
+ *  }
+ *  ```
+ */
+class Boot
+{
+private:
+    BootDevice *const _devices;
+    const uint8_t _count;
+    uint32_t _start;
+    bool _done;
+
+public:
+    /**
+     * @brief Construct a new Boot object
+     * @param[in] devices デバイスの配列
+     * @param[in] count デバイスの数
+     */
+    Boot(BootDevice *devices, uint8_t count) : _devices(devices), _count(count), _start(0), _done(false) {}
+    /**
+     * @brief Construct a new Boot object
+     * @param[in] devices デバイスの配列
+     */
+    template<uint8_t N>
+    Boot(BootDevice (&devices)[N]) : Boot(devices, N) {}
+
+    /**
+     * @brief 起動を始める
+     * @param[in] now 現在時刻(ミリ秒)
+     * @details 各デバイスの起動処理を1歩ずつ進める
+     */
+    void start(uint32_t now);
+
+    /**
+     * @brief まだ起動していないデバイスの起動処理を1歩ずつ進める
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return bool すべてのデバイスの起動が終わったら(init_readyかinit_failedなら)true
+     */
+    bool poll(uint32_t now);
+
+    /**
+     * @brief 決めた時間の間だけpoll()を繰り返す
+     * @param[in] budget 待つ時間の上限(ミリ秒)
+     * @return bool すべてのデバイスの起動が終わったらtrue
+     * @details setup()の中で、制御を始める前に最低限待ちたいときに使う
+     */
+    bool run(uint16_t budget);
+
+    /** @brief すべてのデバイスの起動が終わったかどうか */
+    bool done() const { return _done; }
+
+    /**
+     * @brief デバイスを取得する
+     * @param[in] index デバイスの番号
+     * @return デバイス
+     */
+    const BootDevice &operator[](uint8_t index) const { return _devices[index]; }
+
+    //! デバイスの数
+    uint8_t size() const { return _count; }
+
+    /**
+     * @brief 各デバイスの起動にかかった時間を出力する
+     * @param[out] out 出力先
+     * @details 1デバイス1行で "boot <名前> <ready|failed|pending> <ms>"
+     */
+    void print_report(Print &out) const;
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_BOOT_H */
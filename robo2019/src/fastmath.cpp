@@ -0,0 +1,128 @@
+#include <Arduino.h>
+#include "fastmath.h"
+
+namespace {
+    // atan(k / 32)を1周65536の角度にしたもの (k = 0..32)
+    const uint16_t atan_table[33] PROGMEM = {
+        0, 326, 651, 975, 1297, 1617, 1933, 2246,
+        2555, 2860, 3159, 3453, 3742, 4025, 4302, 4572,
+        4836, 5094, 5344, 5589, 5826, 6058, 6282, 6500,
+        6712, 6917, 7117, 7310, 7498, 7679, 7856, 8026,
+        8192,
+    };
+
+    // hypotの折れ線近似の係数(256倍)。max(c * 長い方, a * 長い方 + b * 短い方)
+    constexpr uint16_t hypot_c = 260, hypot_a = 226, hypot_b = 130;
+
+    // atan(t)の2次の近似(0 <= t <= 1、ラジアン)
+    inline float atan_fast(float t)
+    {
+        return t * (float(PI / 4) + 0.273f * (1 - t));
+    }
+
+    // atan(t)の9次の近似(0 <= t <= 1、ラジアン、Abramowitz & Stegun 4.4.49)
+    inline float atan_precise(float t)
+    {
+        const float t2 = t * t;
+        return t * (0.9998660f + t2 * (-0.3302995f + t2 * (0.1801410f + t2 * (-0.0851330f + t2 * 0.0208351f))));
+    }
+
+    // 1/8周に折りたたんでatanを求め、元の象限に戻す
+    template<float (*Atan)(float)>
+    float atan2_octant(float y, float x)
+    {
+        const float ax = fabs(x), ay = fabs(y);
+        if (ax == 0 && ay == 0) return 0;
+        float a = ay <= ax ? Atan(ay / ax) : float(PI / 2) - Atan(ax / ay);
+        if (x < 0) a = float(PI) - a;
+        return y < 0 ? -a : a;
+    }
+
+    // atan(t)の表引き(tは1を32768とする、0..32768、戻り値は1周65536)
+    inline uint16_t atan_q15_precise(uint16_t t)
+    {
+        const uint8_t i = t >> 10;
+        const uint16_t f = t & 0x3ff;
+        const uint16_t a = pgm_read_word(&atan_table[i]);
+        if (f == 0) return a;
+        const uint16_t b = pgm_read_word(&atan_table[i + 1]);
+        return a + uint16_t((uint32_t(b - a) * f + 512) >> 10);
+    }
+
+    // atan(t)の2次の近似(tは1を32768とする、戻り値は1周65536)。0.273 rad = 2847
+    inline uint16_t atan_q15_fast(uint16_t t)
+    {
+        return uint16_t((uint32_t(t) * (8192 + ((uint32_t(2847) * (32768 - t)) >> 15))) >> 15);
+    }
+
+    template<uint16_t (*Atan)(uint16_t)>
+    robo::Angle iatan2_octant(int16_t y, int16_t x)
+    {
+        const uint16_t ax = abs(int32_t(x)), ay = abs(int32_t(y));
+        if (ax == 0 && ay == 0) return robo::Angle();
+        // 比は四捨五入する(切り捨てると、角度が軸の方に偏る)
+        uint16_t a = ay <= ax
+            ? Atan(uint16_t(((uint32_t(ay) << 15) + ax / 2) / ax))
+            : robo::Angle::quarter_turn - Atan(uint16_t(((uint32_t(ax) << 15) + ay / 2) / ay));
+        if (x < 0) a = robo::Angle::half_turn - a;
+        const robo::Angle result = robo::Angle::from_raw(a);
+        return y < 0 ? -result : result;
+    }
+}
+
+uint16_t robo::fastmath::isqrt(uint32_t n)
+{
+    uint32_t root = 0, bit = 1UL << 30;
+    while (bit > n) bit >>= 2;
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+float robo::fastmath::atan2_precise(float y, float x)
+{
+    return atan2_octant<atan_precise>(y, x);
+}
+
+float robo::fastmath::atan2_fast(float y, float x)
+{
+    return atan2_octant<atan_fast>(y, x);
+}
+
+float robo::fastmath::hypot_fast(float x, float y)
+{
+    const float ax = fabs(x), ay = fabs(y);
+    const float l = max(ax, ay), s = min(ax, ay);
+    return max(l * (hypot_c / 256.0f), l * (hypot_a / 256.0f) + s * (hypot_b / 256.0f));
+}
+
+void robo::fastmath::sincos_table(float rad, float &s, float &c)
+{
+    const robo::Angle a = robo::Angle::from_radians(rad);
+    s = a.sin() * (1.0f / 32767);
+    c = a.cos() * (1.0f / 32767);
+}
+
+robo::Angle robo::fastmath::iatan2_precise(int16_t y, int16_t x)
+{
+    return iatan2_octant<atan_q15_precise>(y, x);
+}
+
+robo::Angle robo::fastmath::iatan2_fast(int16_t y, int16_t x)
+{
+    return iatan2_octant<atan_q15_fast>(y, x);
+}
+
+uint16_t robo::fastmath::ihypot_fast(int16_t x, int16_t y)
+{
+    const uint16_t ax = abs(int32_t(x)), ay = abs(int32_t(y));
+    const uint32_t l = max(ax, ay), s = min(ax, ay);
+    return uint16_t(max(l * hypot_c, l * hypot_a + s * hypot_b) >> 8);
+}
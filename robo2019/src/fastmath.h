@@ -0,0 +1,189 @@
+/**
+ * @file fastmath.h
+ * @brief atan2, hypot, sin/cosの近似計算
+ */
+
+#pragma once
+
+#ifndef ROBO2019_FASTMATH_H
+#define ROBO2019_FASTMATH_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "angle.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @namespace fastmath
+ * @brief libmのatan2/sqrt/sin/cosより速い近似計算
+ * @details
+ *  AVRには浮動小数点数の演算器がないため、libmのatan2やsin/cosは1回で数千サイクルかかる。
+ *  ここでは精度を3段階(Accuracy)から選べるようにし、精度の要らないところでは速い近似を使う。
+ *  精度はテンプレート引数で選び、省略したときはROBO2019_FASTMATH_ACCURACY(既定はprecise)になる。
+ *
+ *  | 関数                  | exact       | precise                   | fast                        |
+ *  | --------------------- | ----------- | ------------------------- | --------------------------- |
+ *  | atan2 (float)         | libm        | 9次の多項式 (1.2e-5 rad)   | 2次の近似 (4e-3 rad)         |
+ *  | hypot (float)         | libm hypot  | sqrt(x * x + y * y)       | 折れ線の近似 (相対誤差2%)     |
+ *  | sincos (float)        | libm        | robo::Angleの表 (2e-4)     | preciseと同じ               |
+ *  | iatan2 (int16_t)      | libm        | 表と線形補間 (2e-4 rad)    | 2次の近似 (4e-3 rad)         |
+ *  | ihypot (int16_t)      | 整数のsqrt  | 整数のsqrt                 | 折れ線の近似 (相対誤差2%)     |
+ *
+ *  括弧の中は最大の誤差の目安。実際の値はexamples/fastmathで確かめられる(extras/host_test.pyでも、この値に収まるか調べる)。
+ * @note
+ *  ```C++
+ *  float a = robo::fastmath::atan2(y, x);                     // 既定の精度
+ *  float b = robo::fastmath::atan2<robo::fastmath::fast>(y, x);
+ *  robo::Angle c = robo::fastmath::iatan2(pos_y, pos_x);      // 浮動小数点数を使わない
+ *  ```
+ */
+namespace fastmath {
+
+/** @brief 近似の精度 */
+enum Accuracy : uint8_t {
+    //! libmをそのまま使う
+    exact,
+    //! 誤差2e-4程度まで。センサーの値を扱うにはこれで十分
+    precise,
+    //! 誤差2%程度まで。モーターの出力を決めるだけならこれで十分
+    fast,
+};
+
+#ifndef ROBO2019_FASTMATH_ACCURACY
+#define ROBO2019_FASTMATH_ACCURACY precise
+#endif
+
+//! 精度を省略したときの精度
+constexpr Accuracy default_accuracy = ROBO2019_FASTMATH_ACCURACY;
+
+/**
+ * @brief 整数の平方根(切り捨て)
+ * @param[in] n 値
+ * @return uint16_t floor(sqrt(n))
+ */
+uint16_t isqrt(uint32_t n);
+
+/** @brief atan2を9次の多項式で近似する(誤差1.2e-5 rad) */
+float atan2_precise(float y, float x);
+/** @brief atan2を2次の式で近似する(誤差4e-3 rad) */
+float atan2_fast(float y, float x);
+/** @brief hypotを折れ線で近似する(相対誤差2%) */
+float hypot_fast(float x, float y);
+/** @brief sin/cosをrobo::Angleの表から引く(誤差2e-4) */
+void sincos_table(float rad, float &s, float &c);
+/** @brief atan2を表と線形補間で求める(誤差2e-4 rad) */
+robo::Angle iatan2_precise(int16_t y, int16_t x);
+/** @brief atan2を2次の式で近似する(誤差4e-3 rad) */
+robo::Angle iatan2_fast(int16_t y, int16_t x);
+/** @brief hypotを折れ線で近似する(相対誤差2%) */
+uint16_t ihypot_fast(int16_t x, int16_t y);
+
+/**
+ * @brief 点(x, y)の偏角
+ * @tparam A 精度
+ * @return float 偏角(ラジアン、-PI..PI)
+ */
+template<Accuracy A = default_accuracy>
+inline float atan2(float y, float x)
+{
+    return A == exact ? ::atan2(y, x) : A == precise ? atan2_precise(y, x) : atan2_fast(y, x);
+}
+
+/**
+ * @brief 点(x, y)の原点からの距離
+ * @tparam A 精度
+ * @return float sqrt(x * x + y * y)
+ */
+template<Accuracy A = default_accuracy>
+inline float hypot(float x, float y)
+{
+    return A == exact ? ::hypot(x, y) : A == precise ? float(::sqrt(x * x + y * y)) : hypot_fast(x, y);
+}
+
+/**
+ * @brief sinとcosを一度に求める
+ * @tparam A 精度
+ * @param[in] rad 角度(ラジアン、-2PI..2PI)
+ * @param[out] s sin(rad)
+ * @param[out] c cos(rad)
+ */
+template<Accuracy A = default_accuracy>
+inline void sincos(float rad, float &s, float &c)
+{
+    if (A == exact) {
+        s = ::sin(rad);
+        c = ::cos(rad);
+    } else {
+        sincos_table(rad, s, c);
+    }
+}
+
+/**
+ * @brief 点(x, y)の偏角を浮動小数点数を使わずに求める
+ * @tparam A 精度
+ * @return robo::Angle 偏角((0, 0)なら0)
+ */
+template<Accuracy A = default_accuracy>
+inline robo::Angle iatan2(int16_t y, int16_t x)
+{
+    return A == exact ? robo::Angle::from_radians(::atan2(float(y), float(x)))
+        : A == precise ? iatan2_precise(y, x) : iatan2_fast(y, x);
+}
+
+/**
+ * @brief 点(x, y)の原点からの距離を浮動小数点数を使わずに求める
+ * @tparam A 精度
+ * @return uint16_t 距離(exactとpreciseは切り捨て)
+ */
+template<Accuracy A = default_accuracy>
+inline uint16_t ihypot(int16_t x, int16_t y)
+{
+    return A == fast ? ihypot_fast(x, y) : isqrt(uint32_t(int32_t(x) * x) + uint32_t(int32_t(y) * y));
+}
+
+/**
+ * @brief sinとcosを一度に表から引く
+ * @param[in] angle 角度
+ * @param[out] s sinの値を32767倍したもの
+ * @param[out] c cosの値を32767倍したもの
+ */
+inline void sincos(robo::Angle angle, int16_t &s, int16_t &c)
+{
+    s = angle.sin();
+    c = angle.cos();
+}
+
+/**
+ * @brief robo::Vector2Dなどに計算方法を渡すためのポリシー
+ * @tparam A 精度
+ */
+template<Accuracy A>
+struct Policy {
+    //! 精度
+    static constexpr Accuracy accuracy = A;
+    static float atan2(float y, float x) { return fastmath::atan2<A>(y, x); }
+    static float hypot(float x, float y) { return fastmath::hypot<A>(x, y); }
+    static void sincos(float rad, float &s, float &c) { fastmath::sincos<A>(rad, s, c); }
+};
+
+template<Accuracy A>
+constexpr Accuracy Policy<A>::accuracy;
+
+} // namespace fastmath
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_FASTMATH_H */
@@ -0,0 +1,188 @@
+/**
+ * @file fixed.h
+ * @brief 固定小数点数の型
+ */
+
+#pragma once
+
+#ifndef ROBO2019_FIXED_H
+#define ROBO2019_FIXED_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <ArxTypeTraits.h>
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Fixed
+ * @brief 固定小数点数
+ * @tparam Raw 値を入れる符号付き整数型
+ * @tparam Wide 掛け算・割り算の途中の値を入れる、Rawの2倍の幅の符号付き整数型
+ * @tparam Frac 小数部のビット数
+ * @details
+ *  値は`raw / 2^Frac`を表す。AVRには浮動小数点数の演算器がないため、floatの代わりに使うと
+ *  足し算・引き算は整数と同じ速さ、掛け算・割り算も整数の掛け算・割り算1回で済む。
+ *
+ *  - 掛け算・割り算・floatからの変換は、最も近い値に丸める(ちょうど半分は0から遠い方)。
+ *  - 結果が表せる範囲を超えたときは、最大値か最小値に飽和させる(0での割り算も同じ)。
+ *  - 演算はすべてconstexprなので、定数どうしの計算はコンパイル時に済む。
+ * @note
+ *  ```C++
+ *  constexpr robo::Q8_8 gain = 1.5f;        // コンパイル時に384になる
+ *  robo::Q8_8 power = gain * robo::Q8_8(20); // 30
+ *  int8_t p = power.to_int();
+ *  ```
+ */
+template<typename Raw, typename Wide, uint8_t Frac>
+class Fixed
+{
+private: // static part
+    static_assert(std::is_signed<Raw>::value && std::is_signed<Wide>::value, "must be signed integer types");
+    static_assert(sizeof(Wide) >= 2 * sizeof(Raw), "Wide must be twice as wide as Raw");
+    static_assert(Frac < 8 * sizeof(Raw), "too many fraction bits");
+
+public:
+    //! 小数部のビット数
+    static constexpr uint8_t frac_bits = Frac;
+    //! 1を表すrawの値
+    static constexpr Wide one = Wide(1) << Frac;
+    //! rawの最大値
+    static constexpr Raw raw_max = Raw(~(Wide(1) << (8 * sizeof(Raw) - 1)));
+    //! rawの最小値
+    static constexpr Raw raw_min = Raw(-raw_max - 1);
+
+    /**
+     * @brief 表せる範囲に収める
+     * @param[in] v 途中の値(rawの単位)
+     */
+    static constexpr Raw saturate(Wide v) { return v > raw_max ? raw_max : v < raw_min ? raw_min : Raw(v); }
+
+private:
+    Raw _raw;
+
+    struct RawTag {};
+    constexpr Fixed(Raw raw, RawTag) : _raw(raw) {}
+
+    // 2^shiftで割って丸める(0から遠い方へ)
+    static constexpr Wide round_shift(Wide v, uint8_t shift)
+    {
+        return shift == 0 ? v
+            : v >= 0 ? (v + (Wide(1) << (shift - 1))) >> shift
+            : -((-v + (Wide(1) << (shift - 1))) >> shift);
+    }
+    // 割って丸める(0から遠い方へ)。bは0でないこと
+    static constexpr Wide round_div(Wide a, Wide b)
+    {
+        return (a >= 0) == (b >= 0)
+            ? (abs_wide(a) + abs_wide(b) / 2) / abs_wide(b)
+            : -((abs_wide(a) + abs_wide(b) / 2) / abs_wide(b));
+    }
+    static constexpr Wide abs_wide(Wide v) { return v < 0 ? -v : v; }
+    static constexpr Raw from_int(Wide v)
+    {
+        return v > (raw_max >> Frac) ? raw_max : v < (raw_min >> Frac) ? raw_min : Raw(v * one);
+    }
+    static constexpr Raw from_float(float v)
+    {
+        return v >= float(raw_max) / one ? raw_max
+            : v <= float(raw_min) / one ? raw_min
+            : Raw(v >= 0 ? v * one + 0.5f : v * one - 0.5f);
+    }
+
+public:
+    /** @brief 0で初期化 */
+    constexpr Fixed() : _raw(0) {}
+    /** @brief 整数から作る(範囲を超えたら飽和) */
+    template<typename I, typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+    constexpr Fixed(I v) : _raw(from_int(Wide(v))) {}
+    /** @brief floatから作る(最も近い値に丸め、範囲を超えたら飽和) */
+    constexpr Fixed(float v) : _raw(from_float(v)) {}
+    /** @brief doubleから作る(AVRではfloatと同じ) */
+    constexpr Fixed(double v) : _raw(from_float(float(v))) {}
+
+    /**
+     * @brief rawの値から作る
+     * @param[in] raw 値 * 2^Frac
+     */
+    static constexpr Fixed from_raw(Raw raw) { return Fixed(raw, RawTag()); }
+    /**
+     * @brief 32767倍した値(robo::Angle::sin()など)から作る
+     * @param[in] q15 値 * 32767
+     */
+    static constexpr Fixed from_q15(int16_t q15)
+    {
+        return Fixed(saturate(round_div(Wide(q15) * one, 32767)), RawTag());
+    }
+
+    /** @brief 値 * 2^Frac */
+    constexpr Raw raw() const { return _raw; }
+    /** @brief 最も近い整数(ちょうど半分は0から遠い方) */
+    constexpr Wide to_int() const { return round_shift(_raw, Frac); }
+    /** @brief floatに変換する */
+    constexpr float to_float() const { return float(_raw) / one; }
+    /** @brief floatに変換する */
+    constexpr explicit operator float() const { return to_float(); }
+
+    constexpr Fixed operator+() const { return *this; }
+    constexpr Fixed operator-() const { return Fixed(saturate(-Wide(_raw)), RawTag()); }
+    Fixed &operator+=(Fixed rh) { return *this = *this + rh; }
+    Fixed &operator-=(Fixed rh) { return *this = *this - rh; }
+    Fixed &operator*=(Fixed rh) { return *this = *this * rh; }
+    Fixed &operator/=(Fixed rh) { return *this = *this / rh; }
+
+    // 左右どちらが整数やfloatでも使えるよう、演算子はfriendにする
+    friend constexpr Fixed operator+(Fixed lh, Fixed rh) { return Fixed(saturate(Wide(lh._raw) + rh._raw), RawTag()); }
+    friend constexpr Fixed operator-(Fixed lh, Fixed rh) { return Fixed(saturate(Wide(lh._raw) - rh._raw), RawTag()); }
+    friend constexpr Fixed operator*(Fixed lh, Fixed rh)
+    {
+        return Fixed(saturate(round_shift(Wide(lh._raw) * rh._raw, Frac)), RawTag());
+    }
+    friend constexpr Fixed operator/(Fixed lh, Fixed rh)
+    {
+        return Fixed(
+            rh._raw == 0 ? (lh._raw >= 0 ? raw_max : raw_min) : saturate(round_div(Wide(lh._raw) * one, rh._raw)),
+            RawTag());
+    }
+
+    friend constexpr bool operator==(Fixed lh, Fixed rh) { return lh._raw == rh._raw; }
+    friend constexpr bool operator!=(Fixed lh, Fixed rh) { return lh._raw != rh._raw; }
+    friend constexpr bool operator<(Fixed lh, Fixed rh) { return lh._raw < rh._raw; }
+    friend constexpr bool operator>(Fixed lh, Fixed rh) { return lh._raw > rh._raw; }
+    friend constexpr bool operator<=(Fixed lh, Fixed rh) { return lh._raw <= rh._raw; }
+    friend constexpr bool operator>=(Fixed lh, Fixed rh) { return lh._raw >= rh._raw; }
+};
+
+template<typename Raw, typename Wide, uint8_t Frac>
+constexpr uint8_t Fixed<Raw, Wide, Frac>::frac_bits;
+template<typename Raw, typename Wide, uint8_t Frac>
+constexpr Wide Fixed<Raw, Wide, Frac>::one;
+template<typename Raw, typename Wide, uint8_t Frac>
+constexpr Raw Fixed<Raw, Wide, Frac>::raw_max;
+template<typename Raw, typename Wide, uint8_t Frac>
+constexpr Raw Fixed<Raw, Wide, Frac>::raw_min;
+
+//! 整数部8ビット(符号を含む)、小数部8ビットの固定小数点数(-128..127.996、分解能1/256)
+using Q8_8 = Fixed<int16_t, int32_t, 8>;
+//! 整数部16ビット(符号を含む)、小数部16ビットの固定小数点数(-32768..32767.99998、分解能1/65536)
+using Q16_16 = Fixed<int32_t, int64_t, 16>;
+
+/** @brief 固定小数点数の型かどうか */
+template<typename T> struct is_fixed_point : std::false_type {};
+template<typename Raw, typename Wide, uint8_t Frac>
+struct is_fixed_point<Fixed<Raw, Wide, Frac>> : std::true_type {};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_FIXED_H */
@@ -0,0 +1,161 @@
+#include <Arduino.h>
+#include "goalie.h"
+
+namespace {
+    // 平行移動するときのモーター1-4の向き(Goalie::Moveの順)
+    const int8_t move_signs[][4] PROGMEM = {
+        {  1,  1,  1,  1 }, // forward
+        { -1, -1, -1, -1 }, // backward
+        { -1,  1,  1, -1 }, // left
+        {  1, -1, -1,  1 }, // right
+    };
+
+    // ラインや自分のゴールから戻るときのパワー
+    constexpr int8_t hold_power = 30;
+
+    using Step = robo::Maneuver::Step;
+
+    // 左のラインを踏んだ => 右に離れる
+    const Step escape_left[] PROGMEM = {
+        { {  hold_power, -hold_power, -hold_power,  hold_power }, 400, false },
+    };
+    // 右のラインを踏んだ => 左に離れる
+    const Step escape_right[] PROGMEM = {
+        { { -hold_power,  hold_power,  hold_power, -hold_power }, 400, false },
+    };
+    // 後ろのラインを踏んだ => 前に離れる
+    const Step escape_back[] PROGMEM = {
+        { {  hold_power,  hold_power,  hold_power,  hold_power }, 200, false },
+    };
+    // ボールを押し出して戻る(前進と後退はボールのy座標と60の差 * 10ms)
+    const Step push_script[] PROGMEM = {
+        { {  60,  60,  60,  60 }, 10, true },
+        { {   0,   0,   0,   0 }, 20, false },
+        { { -40, -40, -40, -40 }, 10, true },
+    };
+    // 回転の速さの範囲
+    constexpr int8_t rotate_min_power = 20, rotate_max_power = 30;
+}
+
+constexpr robo::Angle robo::Goalie::heading_tolerance;
+constexpr uint16_t robo::Goalie::push_min_y;
+constexpr uint16_t robo::Goalie::push_max_y;
+constexpr uint8_t robo::Goalie::push_frames;
+constexpr uint8_t robo::Goalie::lost_frames;
+constexpr uint8_t robo::Goalie::push_priority;
+constexpr uint8_t robo::Goalie::line_priority;
+
+const robo::Goalie::Config robo::Goalie::default_config = {
+    92,  // goal_near_y
+    103, // goal_far_y
+};
+
+robo::Goalie::Goalie(robo::Motor &motor, const Config &config, const robo::Interceptor::Config &intercept_config)
+: _config(config), _motor(motor), _maneuver(motor), _interceptor(intercept_config), _push_count(0), _lost_count(0), _holding(false), _own_goal(0) {}
+
+void robo::Goalie::move(Move move, int8_t power)
+{
+    int8_t p[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        p[i] = int8_t(pgm_read_byte(&move_signs[move][i])) * power;
+    }
+    _motor.set_all_motors(p[0], p[1], p[2], p[3]);
+}
+
+bool robo::Goalie::keep_heading(robo::Angle dir)
+{
+    if (dir.within(heading_tolerance)) return false;
+    // ずれの大きさ(半周で100)に比例させ、20-30に収める
+    const int8_t power = constrain(int8_t((uint32_t(dir.magnitude().raw()) * 100) >> 15), rotate_min_power, rotate_max_power);
+    _motor.set_rotate(dir > robo::Angle(), power);
+    return true;
+}
+
+bool robo::Goalie::keep_line(bool left, bool right, bool back, uint32_t now)
+{
+    // 白を読んでいる間は最初からやり直すので、最後に白を読んでから決めた時間だけ離れ続ける
+    if (left) {
+        _maneuver.start(escape_left, now, line_priority);
+    } else if (right) {
+        _maneuver.start(escape_right, now, line_priority);
+    } else if (back) {
+        _maneuver.start(escape_back, now, line_priority);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool robo::Goalie::keep_depth(const robo::openmv::FrameData &frame)
+{
+    if (_own_goal == 0 && frame.has_y_goal && frame.has_b_goal) {
+        // 後ろ側に見える方が自分のゴール
+        _own_goal = frame.y_goal.y > frame.b_goal.y ? 1 : 2;
+    }
+    const robo::openmv::Position *goal =
+        _own_goal == 1 ? frame.y_goal_pos() :
+        _own_goal == 2 ? frame.b_goal_pos() : NULL;
+    if (goal == NULL) return false;
+    if (goal->y > _config.goal_far_y) {
+        move(Move::backward, hold_power);
+    } else if (goal->y < _config.goal_near_y) {
+        move(Move::forward, hold_power);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void robo::Goalie::track_ball(const robo::openmv::FrameData &frame, uint32_t now)
+{
+    const int8_t power = _interceptor.update(frame.ball_pos(), now);
+    if (!frame.has_ball) {
+        if (_lost_count > lost_frames) {
+            _motor.stop();
+            _interceptor.reset();
+            _lost_count = 0;
+        } else {
+            _lost_count++;
+        }
+        return;
+    }
+    _lost_count = 0;
+    if (power != 0) {
+        // ボールが守備ラインを横切る位置へ横移動する
+        move(power > 0 ? Move::left : Move::right, abs(power));
+        _push_count = 0;
+        return;
+    }
+    const uint16_t y = frame.ball.y;
+    if (push_min_y <= y && y <= push_max_y) {
+        if (++_push_count > push_frames && push(y, now)) return;
+    }
+    _motor.stop();
+}
+
+bool robo::Goalie::push(uint16_t ball_y, uint32_t now)
+{
+    _push_count = 0;
+    return _maneuver.start(push_script, now, push_priority, abs(int16_t(ball_y) - 60));
+}
+
+void robo::Goalie::update(robo::Angle dir, bool left, bool right, bool back, const robo::openmv::FrameData &frame, uint32_t now)
+{
+    // ラインは押し出しの途中でも割り込む
+    keep_line(left, right, back, now);
+    if (_maneuver.update(now)) {
+        _holding = true;
+        return;
+    }
+    if (keep_heading(dir)) return;
+    if (keep_depth(frame)) {
+        _holding = true;
+        return;
+    }
+    if (_holding) {
+        // 戻り終わった => 一度止まってからボールを追う
+        _motor.stop();
+        _holding = false;
+    }
+    track_ball(frame, now);
+}
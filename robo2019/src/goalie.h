@@ -0,0 +1,180 @@
+/**
+ * @file goalie.h
+ * @brief ディフェンス(ゴールキーパー)の動きをまとめたクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_GOALIE_H
+#define ROBO2019_GOALIE_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "angle.h"
+#include "intercept.h"
+#include "maneuver.h"
+#include "motor.h"
+#include "openmv.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Goalie
+ * @brief ディフェンスの動き
+ * @details
+ *  次の優先順位で動く。
+ *  1. ラインを踏んだら離れる(keep_line)。押し出しの途中でも割り込む
+ *  2. ラインから離れたり、ボールを押し出したりしている途中(Maneuver)なら続ける
+ *  3. 正面からずれていたら回転して戻す(keep_heading)
+ *  4. 自分のゴールから離れすぎたり近づきすぎたりしたら戻る(keep_depth)
+ *  5. ボールが守備ラインを横切る位置に横移動し、ボールが正面の近くに止まっていたら押し出す(track_ball)
+ *
+ *  時間の決まった動きはrobo::Maneuverで再生するので、delay()で止まらない。
+ *
+ *  モーターへの出力はMotor::set_all_motors()を通し、文字列はスタック上のバッファで作るので、ヒープを使わない。
+ * @note
+ *  defence機のカメラは後ろ向きについているため、画像の座標は機体から見て上下左右が逆になる。
+ *  ボールのx座標が大きいほど機体の左に、ゴールのy座標が大きいほど機体の後ろにある。
+ */
+class Goalie
+{
+public:
+    /** @brief 平行移動の向き */
+    enum Move : uint8_t {
+        forward,
+        backward,
+        left,
+        right,
+    };
+
+    //! 正面とみなす角度の範囲(15度)
+    static constexpr robo::Angle heading_tolerance = robo::Angle::from_degrees(15);
+    //! ボールを押し出す距離の範囲(y座標)
+    static constexpr uint16_t push_min_y = 21, push_max_y = 40;
+    //! ボールが正面の近くにこのフレーム数より長くあったら押し出す
+    static constexpr uint8_t push_frames = 30;
+    //! ボールを見失ってから止まるまでのフレーム数
+    static constexpr uint8_t lost_frames = 6;
+    //! ボールを押し出す手順の優先度
+    static constexpr uint8_t push_priority = 1;
+    //! ラインから離れる手順の優先度
+    static constexpr uint8_t line_priority = 2;
+
+    /** @brief 調整用のパラメーター */
+    struct Config {
+        //! 自分のゴールのy座標がこれより小さければ近づきすぎ
+        uint16_t goal_near_y;
+        //! 自分のゴールのy座標がこれより大きければ離れすぎ
+        uint16_t goal_far_y;
+    };
+
+    //! 標準のパラメーター(移植前のdefence.inoの、ゴールの範囲92-103に合わせてある)
+    static const Config default_config;
+
+private:
+    const Config &_config;
+    robo::Motor &_motor;
+    robo::Maneuver _maneuver;
+    robo::Interceptor _interceptor;
+    uint8_t _push_count;
+    uint8_t _lost_count;
+    //! Maneuverやkeep_depthで動いている途中かどうか
+    bool _holding;
+    //! 自分のゴール(0: 未定, 1: 黄色, 2: 青色)
+    uint8_t _own_goal;
+
+public:
+    /**
+     * @brief Construct a new Goalie object
+     * @param[in] motor 出力先のモーター
+     * @param[in] config パラメーター(寿命はGoalieより長いこと)
+     * @param[in] intercept_config ボールが横切る位置の予測のパラメーター(寿命はGoalieより長いこと)
+     * @details パラメーターは参照で持つので、実行中に書き換えれば次の周期から使われる
+     */
+    Goalie(
+        robo::Motor &motor,
+        const Config &config = default_config,
+        const robo::Interceptor::Config &intercept_config = robo::Interceptor::default_config);
+
+    /**
+     * @brief 平行移動する
+     * @param[in] move 向き
+     * @param[in] power モーターのパワー
+     */
+    void move(Move move, int8_t power);
+
+    /**
+     * @brief 正面からずれていたら回転して戻す
+     * @param[in] dir 機体の向き(左回りが正、正面が0)
+     * @return bool 回転したらtrue
+     */
+    bool keep_heading(robo::Angle dir);
+
+    /**
+     * @brief ラインを踏んでいたら離れる
+     * @param[in] left 左のラインセンサーが白かどうか
+     * @param[in] right 右のラインセンサーが白かどうか
+     * @param[in] back 後ろのラインセンサーが白かどうか
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return bool 離れる手順を始めたらtrue
+     * @details 最後に白を読んでから、左右なら400ms、後ろなら200ms離れ続ける
+     */
+    bool keep_line(bool left, bool right, bool back, uint32_t now);
+
+    /**
+     * @brief 自分のゴールとの距離を保つ
+     * @param[in] frame OpenMVで読み取ったフレーム
+     * @return bool 動いたらtrue
+     * @details 両方のゴールが初めて見えたときに、後ろ側(y座標が大きい方)を自分のゴールとする
+     */
+    bool keep_depth(const robo::openmv::FrameData &frame);
+
+    /**
+     * @brief ボールが守備ラインを横切る位置に横移動し、正面の近くに止まっていたら押し出す
+     * @details 横切る位置はrobo::Interceptorで、ボールの速度から予測する
+     * @param[in] frame OpenMVで読み取ったフレーム
+     * @param[in] now 現在時刻(ミリ秒)
+     */
+    void track_ball(const robo::openmv::FrameData &frame, uint32_t now);
+
+    /**
+     * @brief ボールを押し出して元の位置に戻る手順を始める
+     * @param[in] ball_y ボールのy座標
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return bool 始めたらtrue(ラインから離れている途中なら始めない)
+     */
+    bool push(uint16_t ball_y, uint32_t now);
+
+    /**
+     * @brief 優先順位に従って1周期分動く
+     * @param[in] dir 機体の向き(左回りが正、正面が0)
+     * @param[in] left 左のラインセンサーが白かどうか
+     * @param[in] right 右のラインセンサーが白かどうか
+     * @param[in] back 後ろのラインセンサーが白かどうか
+     * @param[in] frame OpenMVで読み取ったフレーム
+     * @param[in] now 現在時刻(ミリ秒)
+     */
+    void update(robo::Angle dir, bool left, bool right, bool back, const robo::openmv::FrameData &frame, uint32_t now);
+
+    /** @brief ボールが横切る位置の予測 */
+    const robo::Interceptor &interceptor() const { return _interceptor; }
+
+    /** @brief ラインから離れたり、ボールを押し出したりしている途中かどうか */
+    bool maneuvering() const { return _maneuver.running(); }
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_GOALIE_H */
@@ -0,0 +1,78 @@
+#include <Arduino.h>
+#include "i2c_bus.h"
+
+void robo::I2CBus::request(uint8_t index, uint32_t deadline)
+{
+    if (index >= _count) return;
+    BusClient &client = _clients[index];
+    if (client.pending) {
+        if (int32_t(deadline - client.deadline) < 0) client.deadline = deadline;
+        return;
+    }
+    client.pending = true;
+    client.started = false;
+    client.deadline = deadline;
+    client.requested = micros();
+}
+
+bool robo::I2CBus::poll(uint32_t now)
+{
+    BusClient *selected = NULL;
+    BusClient *first = NULL;
+    // 優先度の高いもののうち、まだ期限の来ていないものの期限までの時間
+    uint32_t limit = 0xffffffffUL;
+    for (uint8_t i = 0; i < _count; i++) {
+        BusClient &client = _clients[i];
+        if (!client.pending) continue;
+        if (first == NULL) first = &client;
+        const int32_t slack = int32_t(client.deadline - now);
+        if (slack <= 0) {
+            if (client.cost <= limit) {
+                selected = &client;
+                break;
+            }
+        } else if (uint32_t(slack) < limit) {
+            limit = slack;
+        }
+    }
+    if (selected == NULL) selected = first;
+    if (selected == NULL) return false;
+
+    BusClient &client = *selected;
+    // 続きの通信の待ち時間は数えない
+    if (!client.started) {
+        const uint32_t wait = now - client.requested;
+        if (wait > client.max_wait) client.max_wait = wait > 0xffff ? 0xffff : wait;
+        client.started = true;
+    }
+    client.pending = client.callback(now);
+    const uint32_t exec = micros() - now;
+    if (exec > client.max_exec_time) client.max_exec_time = exec > 0xffff ? 0xffff : exec;
+    if (client.runs != 0xffff) ++client.runs;
+    return true;
+}
+
+void robo::I2CBus::reset_stats()
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        BusClient &client = _clients[i];
+        client.runs = 0;
+        client.max_exec_time = 0;
+        client.max_wait = 0;
+    }
+}
+
+void robo::I2CBus::print_stats(Print &out) const
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        const BusClient &client = _clients[i];
+        out.print(F("bus"));
+        out.print(i);
+        out.print(F(" runs:"));
+        out.print(client.runs);
+        out.print(F(" exec:"));
+        out.print(client.max_exec_time);
+        out.print(F(" wait:"));
+        out.println(client.max_wait);
+    }
+}
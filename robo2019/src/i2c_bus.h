@@ -0,0 +1,165 @@
+/**
+ * @file i2c_bus.h
+ * @brief 共有するI2Cバスの通信を、優先度と期限の順に1回ずつ行うスケジューラのクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_I2C_BUS_H
+#define ROBO2019_I2C_BUS_H
+
+#ifdef ARDUINO
+
+#include <Print.h>
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class BusClient
+ * @brief I2Cバスを使うデバイス
+ * @details 通信を待っている間の時間などの統計もここに記録される
+ */
+class BusClient
+{
+public:
+    /**
+     * @brief 1回分の通信
+     * @param now 現在時刻(micros())
+     * @return まだ続きがあればtrue(次のpoll()でまた呼ばれる)
+     * @note 長い通信は小分けにし、1回の呼び出しではcostを超えないようにする
+     */
+    using Callback = bool (*)(uint32_t now);
+
+    //! 1回分の通信
+    const Callback callback;
+    //! 1回分の通信にかかる時間の見積もり(マイクロ秒)
+    const uint16_t cost;
+
+    //! 通信を待っているかどうか
+    bool pending = false;
+    //! この時刻(micros())までに通信したい
+    uint32_t deadline = 0;
+    //! 通信を頼まれた時刻(micros())
+    uint32_t requested = 0;
+    //! 頼まれてから1回分でも通信したかどうか
+    bool started = false;
+    //! 通信した回数
+    uint16_t runs = 0;
+    //! 1回分の通信にかかった時間の最大値(マイクロ秒)
+    uint16_t max_exec_time = 0;
+    //! 頼まれてから最初の通信を始めるまでの時間の最大値(マイクロ秒)
+    uint16_t max_wait = 0;
+
+    /**
+     * @brief Construct a new BusClient object
+     * @param[in] callback 1回分の通信
+     * @param[in] cost 1回分の通信にかかる時間の見積もり(マイクロ秒)
+     */
+    BusClient(Callback callback, uint16_t cost) : callback(callback), cost(cost) {}
+};
+
+/**
+ * @class I2CBus
+ * @brief OpenMV、BNO055、LCDが共有するI2Cバスの通信の順番を決める
+ * @details
+ *  Wireの通信は終わるまで戻らないので、LCDに1行書くと数ミリ秒バスがふさがり、その間にカメラのフレームや向きを読めない。
+ *  そこで各デバイスの通信をBusClientとして並べ、poll()を呼ぶたびに1回分だけ通信する。
+ *  LCDのように長い通信は1文字ずつに小分けし、1回分を終えるたびにpoll()から戻る。
+ *  これにより、カメラや向きの読み込みは表示の通信に最大でも1回分(1文字分)しか待たされない。
+ *
+ *  次に通信するものは次の順で選ぶ。
+ *  1. 期限を過ぎたもののうち、配列で前にある(優先度の高い)もの。
+ *     ただし、それより優先度の高いものの期限までに終わらない(costが収まらない)ものは後回しにする
+ *  2. 期限を過ぎたものがなければ、待っているもののうち最も優先度の高いもの
+ * @note
+ *  ```C++
+ *  bool read_heading_now(uint32_t) { dir = bno055.get_heading(); return false; }
+ *  bool write_lcd(uint32_t) { return lcd.send_chunk(); }
+ *  robo::BusClient clients[] = {
+ *      robo::BusClient(read_heading_now, 400),
+ *      robo::BusClient(write_lcd, 1000),
+ *  };
+ *  robo::I2CBus bus(clients);
+ *  void read_heading(uint32_t) { bus.request(0, micros()); }
+ *  void loop() {
+ *      bus.poll(micros());
+ *      scheduler.run();
+ *  }
+ *  ```
+ */
+class I2CBus
+{
+private:
+    BusClient *const _clients;
+    const uint8_t _count;
+
+public:
+    /**
+     * @brief Construct a new I2CBus object
+     * @param[in] clients デバイスの配列。前にあるほど優先度が高い
+     * @param[in] count デバイスの数
+     */
+    I2CBus(BusClient *clients, uint8_t count) : _clients(clients), _count(count) {}
+    /**
+     * @brief Construct a new I2CBus object
+     * @param[in] clients デバイスの配列。前にあるほど優先度が高い
+     */
+    template<uint8_t N>
+    I2CBus(BusClient (&clients)[N]) : I2CBus(clients, N) {}
+
+    /**
+     * @brief 通信を頼む
+     * @param[in] index デバイスの番号
+     * @param[in] deadline この時刻(micros())までに通信したい。すぐに読みたいときは今の時刻
+     * @details すでに待っているときは、期限の早い方にする
+     */
+    void request(uint8_t index, uint32_t deadline);
+
+    /**
+     * @brief 待っている通信のうち1つを、1回分だけ進める
+     * @param[in] now 現在時刻(micros())
+     * @return bool 通信したらtrue
+     * @note loop()の中で呼び続ける
+     */
+    bool poll(uint32_t now);
+
+    /**
+     * @brief デバイスが通信を待っているかどうか
+     * @param[in] index デバイスの番号
+     */
+    bool pending(uint8_t index) const { return _clients[index].pending; }
+
+    /**
+     * @brief デバイスを取得する
+     * @param[in] index デバイスの番号
+     * @return デバイス
+     */
+    const BusClient &operator[](uint8_t index) const { return _clients[index]; }
+
+    //! デバイスの数
+    uint8_t size() const { return _count; }
+
+    /** @brief 各デバイスの統計をリセットする */
+    void reset_stats();
+
+    /**
+     * @brief 各デバイスの統計を出力する
+     * @param[out] out 出力先
+     * @details 1デバイス1行で "bus<番号> runs:<回数> exec:<us> wait:<us>"
+     */
+    void print_stats(Print &out) const;
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_I2C_BUS_H */
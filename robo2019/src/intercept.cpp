@@ -0,0 +1,113 @@
+#include <Arduino.h>
+#include "intercept.h"
+
+namespace {
+    // 前回の位置からこの時間(ミリ秒)より空いたら、速度を求め直す
+    constexpr uint16_t stale_ms = 250;
+    // 同じ位置をこの時間(ミリ秒)より短い間隔で読んだら、カメラの同じフレームとみなす
+    constexpr uint16_t same_frame_ms = 100;
+    // 縦方向の速度がこれより遅ければ(1/16ピクセル毎秒)、近づいていないとみなす
+    constexpr int16_t min_approach = 10 * 16;
+    // 1周期の間隔の上限(ミリ秒)。最初の周期や止まっていた後に、パワーが跳ねないようにする
+    constexpr uint16_t max_dt = 100;
+
+    int16_t clamp16(int32_t val)
+    {
+        return val > INT16_MAX ? INT16_MAX : val < -INT16_MAX ? -INT16_MAX : int16_t(val);
+    }
+}
+
+const robo::Interceptor::Config robo::Interceptor::default_config = {
+    60,   // guard_y
+    80,   // center_x
+    60,   // reach
+    7,    // dead_band
+    3,    // gain
+    20,   // min_power
+    40,   // max_power
+    400,  // max_accel
+    1000, // horizon_ms
+    150,  // full_speed
+};
+
+robo::Interceptor::Interceptor(const Config &config)
+: _config(config), _tracking(false), _x(0), _y(0), _vx(0), _vy(0),
+  _target(config.center_x), _power(0), _last_frame(0), _last_update(0) {}
+
+void robo::Interceptor::observe(const robo::openmv::Position &ball, uint32_t now)
+{
+    const int16_t x = int16_t(ball.x) * 16, y = int16_t(ball.y) * 16;
+    const uint32_t dt = now - _last_frame;
+    if (!_tracking || dt > stale_ms) {
+        _tracking = true;
+        _x = x;
+        _y = y;
+        _vx = _vy = 0;
+        _last_frame = now;
+        return;
+    }
+    if (dt == 0 || (x == _x && y == _y && dt < same_frame_ms)) return;
+    // 今回の速度を求め、前回までの値と半分ずつ混ぜる
+    // 機体が左に動くと画像上のボールは右(xが小さい方)にずれるので、その分を足す
+    const int32_t ego = int32_t(_power) * _config.full_speed * 16 / 100;
+    const int16_t vx = clamp16(int32_t(x - _x) * 1000 / int32_t(dt) + ego);
+    const int16_t vy = clamp16(int32_t(y - _y) * 1000 / int32_t(dt));
+    _vx += (vx - _vx) / 2;
+    _vy += (vy - _vy) / 2;
+    _x = x;
+    _y = y;
+    _last_frame = now;
+}
+
+int16_t robo::Interceptor::predict() const
+{
+    const int16_t guard = _config.guard_y * 16;
+    int32_t target = _x;
+    if (_vy > min_approach && _y < guard) {
+        // 守備ラインに届くまでの時間(ミリ秒)
+        const int32_t t = int32_t(guard - _y) * 1000 / _vy;
+        if (t <= _config.horizon_ms) target += int32_t(_vx) * t / 1000;
+    }
+    const int16_t px = int16_t(target / 16);
+    return constrain(px, _config.center_x - _config.reach, _config.center_x + _config.reach);
+}
+
+int8_t robo::Interceptor::profile(int16_t target, uint32_t dt) const
+{
+    const int16_t err = target - _config.center_x;
+    int16_t desired = 0;
+    if (abs(err) > _config.dead_band) {
+        desired = constrain(int16_t(abs(err) * _config.gain), _config.min_power, _config.max_power);
+        if (err < 0) desired = -desired;
+    }
+    const int16_t step = max(int16_t(1), int16_t(uint32_t(_config.max_accel) * dt / 1000));
+    int16_t next = constrain(desired, _power - step, _power + step);
+    // 動き出すときはmin_powerまで一度に上げる(それより小さいと車輪が回らない)
+    if (desired > 0 && 0 <= next && next < _config.min_power) next = _config.min_power;
+    if (desired < 0 && -_config.min_power < next && next <= 0) next = -_config.min_power;
+    return int8_t(next);
+}
+
+int8_t robo::Interceptor::update(const robo::openmv::Position *ball, uint32_t now)
+{
+    uint32_t dt = now - _last_update;
+    if (dt > max_dt) dt = max_dt;
+    _last_update = now;
+    if (ball != NULL) {
+        observe(*ball, now);
+        _target = predict();
+    } else {
+        if (_tracking && now - _last_frame > stale_ms) _tracking = false;
+        _target = _config.center_x;
+    }
+    _power = profile(_target, dt);
+    return _power;
+}
+
+void robo::Interceptor::reset()
+{
+    _tracking = false;
+    _vx = _vy = 0;
+    _target = _config.center_x;
+    _power = 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file intercept.h
+ * @brief ボールの速度からゴール前の守備ラインを横切る位置を予測し、そこへ横移動するクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_INTERCEPT_H
+#define ROBO2019_INTERCEPT_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "openmv.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Interceptor
+ * @brief ボールが守備ラインを横切る位置を予測し、横移動のパワーを決める
+ * @details
+ *  画像上のボールの位置を続けて読み、差分から速度を求めて指数移動平均でならす。
+ *  カメラは機体と一緒に動くので、前回決めたパワーから機体の横方向の速さを見積もって足し、フィールドに対するボールの速度にする。
+ *  ボールが機体に近づいている(yが増えている)ときは、守備ライン(y = guard_y)に届くまでの時間と
+ *  横方向の速度から、横切るx座標を予測する。近づいていないときは、今のx座標をそのまま目標にする。
+ *  目標と機体の正面(center_x)の差に比例したパワーで横移動し、パワーの変化は1秒あたりmax_accelまでに抑える。
+ *
+ *  位置は1/16ピクセル単位、速度は1/16ピクセル毎秒単位の整数で持ち、浮動小数点数は使わない。
+ * @note
+ *  defence機のカメラは後ろ向きについているため、x座標が大きいほど機体の左、y座標が小さいほど機体の前になる。
+ *  update()が返すパワーは正なら左、負なら右への横移動。
+ */
+class Interceptor
+{
+public:
+    /** @brief 調整用のパラメーター */
+    struct Config {
+        //! 守備ラインのy座標(機体の正面)
+        int16_t guard_y;
+        //! 機体の正面のx座標
+        int16_t center_x;
+        //! 目標のx座標をcenter_xからこの範囲に収める
+        int16_t reach;
+        //! 目標との差がこれ以下なら動かない
+        uint8_t dead_band;
+        //! 目標との差1ピクセルあたりのパワー
+        uint8_t gain;
+        //! 動くときのパワーの最小値
+        int8_t min_power;
+        //! パワーの最大値
+        int8_t max_power;
+        //! 1秒あたりのパワーの変化の最大値
+        uint16_t max_accel;
+        //! この時間(ミリ秒)より先に届く予測は使わない
+        uint16_t horizon_ms;
+        //! パワー100で横移動したときの、画像上の速さ(ピクセル毎秒)。0なら機体の動きを差し引かない
+        uint16_t full_speed;
+    };
+
+    //! 標準のパラメーター(移植前のdefence.inoの、正面の範囲73-87とパワー20-40に合わせてある)
+    static const Config default_config;
+
+private:
+    const Config &_config;
+    bool _tracking;
+    //! 位置(1/16ピクセル)
+    int16_t _x, _y;
+    //! 速度(1/16ピクセル毎秒)
+    int16_t _vx, _vy;
+    //! 予測した位置(ピクセル)
+    int16_t _target;
+    int8_t _power;
+    uint32_t _last_frame;
+    uint32_t _last_update;
+
+    void observe(const robo::openmv::Position &ball, uint32_t now);
+    int16_t predict() const;
+    int8_t profile(int16_t target, uint32_t dt) const;
+
+public:
+    /**
+     * @brief Construct a new Interceptor object
+     * @param[in] config パラメーター(寿命はInterceptorより長いこと)
+     */
+    Interceptor(const Config &config = default_config);
+
+    /**
+     * @brief 毎周期呼んで、横移動のパワーを決める
+     * @param[in] ball ボールの位置(見えていなければNULL)
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return int8_t 横移動のパワー(正なら左、負なら右)
+     * @details ボールが見えていないときは、パワーを0に向けて減らしていく
+     */
+    int8_t update(const robo::openmv::Position *ball, uint32_t now);
+
+    /** @brief 速度の推定をやめ、パワーを0にする */
+    void reset();
+
+    /** @brief ボールを追っているかどうか(速度の推定に使える位置がある) */
+    bool tracking() const { return _tracking; }
+    /** @brief 予測した位置(x座標、ピクセル) */
+    int16_t target() const { return _target; }
+    /** @brief 横方向の速度(ピクセル毎秒、左が正) */
+    int16_t vx() const { return _vx / 16; }
+    /** @brief 縦方向の速度(ピクセル毎秒、機体に近づくのが正) */
+    int16_t vy() const { return _vy / 16; }
+    /** @brief 前回決めたパワー */
+    int8_t power() const { return _power; }
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_INTERCEPT_H */
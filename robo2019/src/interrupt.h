@@ -10,6 +10,7 @@
 
 #ifdef ARDUINO
 
+#include "pin.h"
 #include "util.h"
 
 // https://www.arduino.cc/reference/en/language/functions/external-interrupts/attachinterrupt/
@@ -24,21 +25,50 @@ namespace robo {
  * @brief 割り込み用のテンプレートクラス(シングルトン)
  * @tparam in_pin 割り込みで監視するピン番号
  * @tparam mode 割り込みの監視モード。デフォルトはRISING
+ * @tparam debounce チャタリング除去の時間(マイクロ秒)。前のエッジからこれより短い間隔のエッジは無視する。0なら無効
+ * @tparam queue_size エッジを貯めておくキューの容量。2のべき乗
+ * @details
+ *  割り込みが起きるたびに、時刻とピンのレベルをキューに積む。
+ *  loop側でpop()して取り出せば、ポーリングの間に何度エッジがあっても取りこぼさない。
+ *  キューが満杯の間に起きたエッジはdropped()で数がわかる。
  */
-template<int in_pin, int mode=RISING>
-class Interrupt : public robo::SingletonBase<Interrupt<in_pin, mode>>
+template<int in_pin, int mode=RISING, uint16_t debounce=0, uint8_t queue_size=8>
+class Interrupt : public robo::SingletonBase<Interrupt<in_pin, mode, debounce, queue_size>>
 {
+public:
+    /**
+     * @brief 割り込みで記録されるエッジ
+     */
+    struct Edge
+    {
+        //! 割り込みが起きた時刻(micros())
+        uint32_t time;
+        //! 割り込み直後のピンのレベル
+        bool level;
+    };
+
 private:
     /**
      * @brief 状態記憶用の変数
      * @details 割り込みが発生するごとにtrue/falseが切り替わる
      */
     static volatile bool _state;
+    /**
+     * @brief changed()を最後に呼んでから割り込みが起きたかどうか
+     * @details 割り込みで立て、changed()で下ろす。回数と違って、何回起きても1周して元に戻ることがない
+     */
+    static volatile bool _changed;
+    //! キューが満杯で記録できなかったエッジの数
+    static volatile uint8_t _dropped;
+    //! 最後に受け付けたエッジの時刻
+    static volatile uint32_t _last_time;
+    //! 記録したエッジ
+    static robo::RingBuffer<Edge, queue_size> _edges;
 
     /**
      * @fn void callback()
      * @brief 割り込み発生時に呼び出される
-     * @details _stateを切り替える
+     * @details _stateを切り替え、エッジをキューに積む
      */
     static void callback();
 
@@ -59,14 +89,105 @@ public:
 
     /**
      * @fn bool changed()
-     * @brief 最後の呼び出しから_stateが変化したかどうか
-     * @return 変化していたらtrue
+     * @brief 最後の呼び出しから割り込みが起きたかどうか
+     * @return 1回以上起きていたらtrue
+     * @note 偶数回起きて_stateが元に戻っていても、何回起きていてもtrueになる
      */
     bool changed();
+
+    /**
+     * @fn bool pop(Edge &dst)
+     * @brief 記録されたエッジを古い順に1つ取り出す
+     * @param[out] dst 取り出したエッジ
+     * @return 取り出せたらtrue
+     */
+    bool pop(Edge &dst);
+
+    /**
+     * @fn uint8_t pending()
+     * @brief 取り出していないエッジの数
+     * @return エッジの数
+     */
+    uint8_t pending();
+
+    /**
+     * @fn uint8_t dropped()
+     * @brief キューが満杯で記録できなかったエッジの数
+     * @return エッジの数(255で止まる)
+     */
+    uint8_t dropped();
 };
 
 } // namespace robo
 
+// テンプレートのため、実装もヘッダーに書く
+#define ROBO2019_INTERRUPT_TEMPLATE \
+    template<int in_pin, int mode, uint16_t debounce, uint8_t queue_size>
+#define ROBO2019_INTERRUPT_CLASS \
+    robo::Interrupt<in_pin, mode, debounce, queue_size>
+
+ROBO2019_INTERRUPT_TEMPLATE volatile bool ROBO2019_INTERRUPT_CLASS::_state;
+ROBO2019_INTERRUPT_TEMPLATE volatile bool ROBO2019_INTERRUPT_CLASS::_changed;
+ROBO2019_INTERRUPT_TEMPLATE volatile uint8_t ROBO2019_INTERRUPT_CLASS::_dropped;
+ROBO2019_INTERRUPT_TEMPLATE volatile uint32_t ROBO2019_INTERRUPT_CLASS::_last_time;
+ROBO2019_INTERRUPT_TEMPLATE
+robo::RingBuffer<typename ROBO2019_INTERRUPT_CLASS::Edge, queue_size> ROBO2019_INTERRUPT_CLASS::_edges;
+
+ROBO2019_INTERRUPT_TEMPLATE void ROBO2019_INTERRUPT_CLASS::callback()
+{
+    const uint32_t now = micros();
+    if (debounce != 0) {
+        if (now - _last_time < debounce) return;
+        _last_time = now;
+    }
+    _state = !_state;
+    _changed = true;
+    if (!_edges.push(Edge{ now, robo::DigitalPin<in_pin>::read() }) && _dropped != 0xff) {
+        ++_dropped;
+    }
+}
+
+ROBO2019_INTERRUPT_TEMPLATE void ROBO2019_INTERRUPT_CLASS::setup()
+{
+    _state = false;
+    _changed = false;
+    _dropped = 0;
+    _last_time = micros() - debounce;
+    _edges.clear();
+    robo::DigitalPin<in_pin>::set_mode(INPUT);
+    attachInterrupt(digitalPinToInterrupt(in_pin), callback, mode);
+}
+
+ROBO2019_INTERRUPT_TEMPLATE bool ROBO2019_INTERRUPT_CLASS::state()
+{
+    return _state;
+}
+
+ROBO2019_INTERRUPT_TEMPLATE bool ROBO2019_INTERRUPT_CLASS::changed()
+{
+    if (!_changed) return false;
+    _changed = false;
+    return true;
+}
+
+ROBO2019_INTERRUPT_TEMPLATE bool ROBO2019_INTERRUPT_CLASS::pop(Edge &dst)
+{
+    return _edges.pop(dst);
+}
+
+ROBO2019_INTERRUPT_TEMPLATE uint8_t ROBO2019_INTERRUPT_CLASS::pending()
+{
+    return _edges.size();
+}
+
+ROBO2019_INTERRUPT_TEMPLATE uint8_t ROBO2019_INTERRUPT_CLASS::dropped()
+{
+    return _dropped;
+}
+
+#undef ROBO2019_INTERRUPT_TEMPLATE
+#undef ROBO2019_INTERRUPT_CLASS
+
 #else /* ARDUINO */
 
 #error This liblary is for Arduino.
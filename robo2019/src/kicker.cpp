@@ -0,0 +1,102 @@
+#include <Arduino.h>
+#include "kicker.h"
+
+namespace {
+#if ROBO2019_DIRECT_PORT
+    // キッカーのピンがOC1B(10番)ならTimer1でパルスを終わらせる
+    constexpr bool use_timer1 = robo::Kicker::Pin::pin == 10;
+#else
+    constexpr bool use_timer1 = false;
+#endif
+    // Timer1のプリスケーラ
+    constexpr uint16_t prescaler = 256;
+}
+
+const robo::Kicker::Config robo::Kicker::default_config = {
+    80, 100, // min_x, max_x
+    75, 90,  // min_y, max_y
+    3,       // hold_frames
+    30,      // pulse_ms
+    1000,    // recharge_ms
+};
+
+robo::Kicker::Kicker(const Config &config)
+: _config(config), _frames(0), _firing(false), _fired_at(0), _kicks(0) {}
+
+void robo::Kicker::setup()
+{
+    Pin::low();
+    Pin::set_mode(OUTPUT);
+#if ROBO2019_DIRECT_PORT
+    if (use_timer1) {
+        TCCR1A = 0;
+        TCCR1B = 0;
+    }
+#endif
+}
+
+void robo::Kicker::pulse_start()
+{
+#if ROBO2019_DIRECT_PORT
+    if (use_timer1) {
+        const uint32_t ticks = uint32_t(_config.pulse_ms) * (F_CPU / prescaler) / 1000;
+        TCCR1B = 0;
+        // 比較一致でセットするモードにして強制的に一致させ、ピンをHIGHにする
+        TCCR1A = _BV(COM1B1) | _BV(COM1B0);
+        TCCR1C = _BV(FOC1B);
+        // 以降は比較一致でハードウェアがLOWに戻す
+        TCCR1A = _BV(COM1B1);
+        TCNT1 = 0;
+        OCR1B = ticks > 0xffff ? 0xffff : uint16_t(ticks);
+        TCCR1B = _BV(CS12); // 1/256
+        return;
+    }
+#endif
+    Pin::high();
+}
+
+void robo::Kicker::pulse_end()
+{
+#if ROBO2019_DIRECT_PORT
+    if (use_timer1) {
+        TCCR1B = 0;
+        TCCR1A = 0;
+    }
+#endif
+    Pin::low();
+}
+
+void robo::Kicker::observe(const robo::openmv::Position *ball)
+{
+    const bool captured = ball != NULL
+        && _config.min_x <= ball->x && ball->x <= _config.max_x
+        && _config.min_y <= ball->y && ball->y <= _config.max_y;
+    if (!captured) {
+        _frames = 0;
+    } else if (_frames < 0xff) {
+        _frames++;
+    }
+}
+
+bool robo::Kicker::update(uint32_t now, bool armed)
+{
+    if (_firing && now - _fired_at >= _config.pulse_ms) {
+        pulse_end();
+        _firing = false;
+    }
+    if (!armed || !possession()) return false;
+    if (!kick(now)) return false;
+    // 同じボールで続けてキックしないよう、持っていたフレーム数を数え直す
+    _frames = 0;
+    return true;
+}
+
+bool robo::Kicker::kick(uint32_t now)
+{
+    if (_firing || !ready(now)) return false;
+    pulse_start();
+    _firing = true;
+    _fired_at = now;
+    _kicks++;
+    return true;
+}
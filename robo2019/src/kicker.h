@@ -0,0 +1,124 @@
+/**
+ * @file kicker.h
+ * @brief ボールを持ったことを判定し、止まらずにキッカーを動かすクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_KICKER_H
+#define ROBO2019_KICKER_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "openmv.h"
+#include "profile.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Kicker
+ * @brief キッカー(ソレノイド)のドライバー
+ * @details
+ *  ボールが捕捉範囲(Config::min_x-max_x, min_y-max_y)に決まったフレーム数続けて見えたら、ボールを持ったとみなす。
+ *  ボールを持っていて、前回のキックから充電の時間が過ぎていれば、update()を呼んだ周期のうちにキックする。
+ *
+ *  キックのパルスはTimer1で作る。ATmega328Pではキッカーのピン(10番、OC1B)をTimer1の比較一致で
+ *  ハードウェアがLOWに戻すので、loop()が遅れてもパルスの長さは変わらない。
+ *  それ以外のマイコンやピンでは、update()の中で時間を見てLOWに戻す。
+ *  どちらの場合もdelay()で待つことはない。
+ * @note
+ *  ATmega328PではTimer1を使うので、Servoライブラリや9, 10番ピンのanalogWrite()とは同時に使えない。
+ */
+class Kicker
+{
+public:
+    /** @brief 調整用のパラメーター */
+    struct Config {
+        //! 捕捉範囲(画像の座標)
+        uint16_t min_x, max_x, min_y, max_y;
+        //! 捕捉範囲にこのフレーム数続けて見えたら、ボールを持ったとみなす
+        uint8_t hold_frames;
+        //! パルスの長さ(ミリ秒、1000まで)
+        uint16_t pulse_ms;
+        //! キックしてから次にキックできるまでの時間(ミリ秒)
+        uint16_t recharge_ms;
+    };
+
+    //! 標準のパラメーター(offense機のカメラで、ボールが機体の正面に触れている範囲)
+    static const Config default_config;
+
+    //! キッカーのピン
+    using Pin = robo::profile::Kicker;
+
+private:
+    const Config &_config;
+    uint8_t _frames;
+    bool _firing;
+    uint32_t _fired_at;
+    uint16_t _kicks;
+
+    void pulse_start();
+    void pulse_end();
+
+public:
+    /**
+     * @brief Construct a new Kicker object
+     * @param[in] config パラメーター(寿命はKickerより長いこと)
+     */
+    Kicker(const Config &config = default_config);
+
+    /**
+     * @brief ピンとタイマーのセットアップを行う
+     * @note 全体のsetup内で呼ばないと他の機能が使えない
+     */
+    void setup();
+
+    /**
+     * @brief 新しいフレームを読んだら呼んで、ボールを持っているかどうかを更新する
+     * @param[in] ball ボールの位置(見えていなければNULL)
+     */
+    void observe(const robo::openmv::Position *ball);
+
+    /**
+     * @brief 毎周期呼んで、ボールを持っていればキックし、パルスを終わらせる
+     * @param[in] now 現在時刻(ミリ秒)
+     * @param[in] armed falseならボールを持っていてもキックしない
+     * @return bool この呼び出しでキックしたらtrue
+     */
+    bool update(uint32_t now, bool armed = true);
+
+    /**
+     * @brief ボールを持っているかどうかに関係なくキックする
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return bool キックしたらtrue(充電中なら何もしない)
+     */
+    bool kick(uint32_t now);
+
+    /** @brief ボールを持っているかどうか */
+    bool possession() const { return _frames >= _config.hold_frames; }
+    /** @brief パルスを出している途中かどうか */
+    bool firing() const { return _firing; }
+    /**
+     * @brief 充電が終わっているかどうか
+     * @param[in] now 現在時刻(ミリ秒)
+     */
+    bool ready(uint32_t now) const { return _kicks == 0 || now - _fired_at >= _config.recharge_ms; }
+    /** @brief キックした回数 */
+    uint16_t kicks() const { return _kicks; }
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_KICKER_H */
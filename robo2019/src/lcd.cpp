@@ -1,12 +1,144 @@
 #include <Arduino.h>
+#include <Wire.h>
 #include "lcd.h"
 
+namespace {
+    // PCF8574のビット(LiquidCrystal_I2Cと同じ配線)
+    constexpr uint8_t pin_en = 0x04;
+    constexpr uint8_t pin_backlight = 0x08;
+
+    // HD44780のコマンド
+    constexpr uint8_t cmd_clear = 0x01;
+    constexpr uint8_t cmd_entry_mode = 0x04 | 0x02; // 左から右へ
+    constexpr uint8_t cmd_display = 0x08 | 0x04;    // 表示オン、カーソルなし
+    constexpr uint8_t cmd_function = 0x20;          // 4ビット、5x8ドット
+    constexpr uint8_t cmd_function_2line = 0x08;
+    constexpr uint8_t cmd_ddram = 0x80;
+
+    // init_step()の手順
+    enum : uint8_t {
+        init_probe,     // PCF8574が応答するか確かめる
+        init_wake1,     // 8ビットモードにする(3回)
+        init_wake2,
+        init_wake3,
+        init_4bit,      // 4ビットモードにする
+        init_configure, // 行数や表示を設定し、消去する
+        init_entry,     // 書き込む向きを設定する
+        init_done,
+        init_error,
+    };
+}
+
+//implementations of robo::LCD
+constexpr uint16_t robo::LCD::queue_command;
+
 robo::LCD::LCD(uint8_t addr, uint8_t cols, uint8_t rows)
-: LiquidCrystal_I2C(addr, cols, rows) {}
+: LiquidCrystal_I2C(addr, cols, rows), _addr(addr), _rows(rows) {}
 
 void robo::LCD::setup()
 {
     LiquidCrystal_I2C::init();
     LiquidCrystal_I2C::backlight();
     LiquidCrystal_I2C::setCursor(0, 0);
+}
+
+void robo::LCD::write_nibble(uint8_t nibble)
+{
+    const uint8_t data = (nibble & 0xf0) | pin_backlight;
+    Wire.beginTransmission(_addr);
+    Wire.write(data | pin_en);
+    Wire.endTransmission();
+    Wire.beginTransmission(_addr);
+    Wire.write(data);
+    Wire.endTransmission();
+}
+
+robo::InitStatus robo::LCD::init_step(uint32_t now)
+{
+    if (_init_state == init_done) return robo::init_ready;
+    if (_init_state == init_error) return robo::init_failed;
+    if (_init_state != init_probe && int32_t(now - _init_wait) < 0) return robo::init_pending;
+    switch (_init_state) {
+    case init_probe:
+        _muted = true;
+        Wire.begin();
+        Wire.beginTransmission(_addr);
+        if (Wire.endTransmission() != 0) {
+            _init_state = init_error;
+            return robo::init_failed;
+        }
+        LiquidCrystal_I2C::backlight();
+        // 電源を入れてから40ms以上待つ
+        _init_wait = now + 50;
+        _init_state = init_wake1;
+        break;
+    case init_wake1:
+    case init_wake2:
+        write_nibble(0x30);
+        _init_wait = now + 5;
+        _init_state++;
+        break;
+    case init_wake3:
+        write_nibble(0x30);
+        _init_wait = now + 1;
+        _init_state = init_4bit;
+        break;
+    case init_4bit:
+        write_nibble(0x20);
+        _init_wait = now + 1;
+        _init_state = init_configure;
+        break;
+    case init_configure:
+        LiquidCrystal_I2C::command(cmd_function | (_rows > 1 ? cmd_function_2line : 0));
+        LiquidCrystal_I2C::command(cmd_display);
+        LiquidCrystal_I2C::command(cmd_clear);
+        // 消去には1.52msかかる
+        _init_wait = now + 2;
+        _init_state = init_entry;
+        break;
+    case init_entry:
+        LiquidCrystal_I2C::command(cmd_entry_mode);
+        _muted = false;
+        _init_state = init_done;
+        return robo::init_ready;
+    }
+    return robo::init_pending;
+}
+
+void robo::LCD::setCursor(uint8_t col, uint8_t row)
+{
+    static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+    if (_muted) return;
+    if (row >= _rows) row = _rows - 1;
+    if (row > 3) row = 3;
+    const uint8_t cmd = cmd_ddram | (col + row_offsets[row]);
+    if (_queue != NULL) {
+        _queue->push(queue_command | cmd);
+        return;
+    }
+    LiquidCrystal_I2C::command(cmd);
+}
+
+size_t robo::LCD::write(uint8_t value)
+{
+    if (_muted) return 1;
+    if (_queue != NULL) return _queue->push(value) ? 1 : 0;
+    return LiquidCrystal_I2C::write(value);
+}
+
+bool robo::LCD::send_chunk()
+{
+    if (_queue == NULL) return false;
+    if (_muted) {
+        _queue->clear();
+        return false;
+    }
+    uint16_t entry;
+    if (!_queue->pop(entry)) return false;
+    if (entry & queue_command) {
+        LiquidCrystal_I2C::command(uint8_t(entry));
+    } else {
+        LiquidCrystal_I2C::write(uint8_t(entry));
+    }
+    return !_queue->empty();
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 
 #include <LiquidCrystal_I2C.h>
 
+#include "boot.h"
+#include "util.h"
+
 /**
  * @brief 自作ライブラリの機能をまとめたもの
  */
@@ -15,9 +18,38 @@ namespace robo
 
 /**
  * @brief LiquidCrystal_I2Cのラッパ
+ * @details
+ *  LiquidCrystal_I2C::init()は、HD44780の初期化の前に合わせて1秒以上delay()で待つ。
+ *  init_step()は同じ初期化を、待ち時間の間は戻ってくる状態機械で行うので、robo::Bootで他のデバイスと並べて起動できる。
+ *  init_step()で起動している間と、LCDが見つからなかったときは、書き込みを捨てる。
+ *
+ *  set_queue()でキューを渡すと、setCursor()とwrite()はI2Cで送らずにキューに積むだけになる。
+ *  積んだものはsend_chunk()で1つずつ送るので、robo::I2CBusからカメラなどの読み込みの合間に少しずつ送れる。
  */
 struct LCD : public LiquidCrystal_I2C
 {
+    /**
+     * @brief 送る前の書き込みのキュー
+     * @details 下位8ビットが文字かコマンド、queue_commandのビットが立っていればコマンド
+     */
+    using Queue = robo::RingBuffer<uint16_t, 64>;
+    //! キューの要素がコマンドであることを示すビット
+    static constexpr uint16_t queue_command = 0x100;
+
+private:
+    const uint8_t _addr;
+    const uint8_t _rows;
+    //! init_step()の手順の番号
+    uint8_t _init_state = 0;
+    //! init_step()で次の手順に進める時刻(ミリ秒)
+    uint32_t _init_wait = 0;
+    //! init_step()で起動している途中か、LCDが見つからなかった(書き込みを捨てる)
+    bool _muted = false;
+    //! 送る前の書き込み(NULLならすぐに送る)
+    Queue *_queue = NULL;
+
+    void write_nibble(uint8_t nibble);
+
 public:
     /**
      * @brief Construct a new LCD object
@@ -31,6 +63,49 @@ public:
      * @brief 全体のセットアップ内で呼び出すと便利な関数
      */
     void setup();
+
+    /**
+     * @brief setup()と同じ初期化を、待たずに1歩進める
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return InitStatus 初期化の状態
+     * @details robo::Bootから、init_readyかinit_failedを返すまで繰り返し呼ぶ
+     */
+    robo::InitStatus init_step(uint32_t now);
+
+    /**
+     * @brief カーソルを動かす
+     * @param[in] col 列
+     * @param[in] row 行
+     * @note init_step()で初期化したときも使えるよう、行数はコンストラクタで渡した値を使う
+     */
+    void setCursor(uint8_t col, uint8_t row);
+
+    /**
+     * @brief 書き込みをキューに積むようにする
+     * @param[in] queue キュー(NULLならすぐに送るように戻す)
+     * @note キューは呼び出し側が持つので、使わないスケッチはSRAMを使わない
+     */
+    void set_queue(Queue *queue) { _queue = queue; }
+
+    /**
+     * @brief キューに積んだ書き込みを1つ送る
+     * @return bool まだキューに残っていればtrue
+     * @details 1文字(I2Cで6回の送信)だけ送って戻る。起動していないときはキューを捨てる
+     */
+    bool send_chunk();
+
+    /**
+     * @brief キューに積んだ書き込みを捨てる
+     * @note 前の表示を送り切る前に書き直すときに使う
+     */
+    void discard_queue() { if (_queue != NULL) _queue->clear(); }
+
+    /**
+     * @brief 1文字書き込む
+     * @return size_t 書き込んだ(キューに積んだ)文字数。キューが満杯なら0
+     */
+    size_t write(uint8_t value) override;
+    using Print::write;
 };
 
 } // namespace robo
\ No newline at end of file
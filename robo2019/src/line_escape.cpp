@@ -0,0 +1,51 @@
+#include <Arduino.h>
+#include "line_escape.h"
+
+namespace {
+    // 各センサーが白を読んだときに離れる向き(機体の相対座標系、コンパイル時の定数)
+    constexpr robo::V2_float away_from_left(0, -1);
+    constexpr robo::V2_float away_from_right(0, 1);
+    constexpr robo::V2_float away_from_back(1, 0);
+}
+
+robo::LineEscape::LineEscape(uint16_t hold_ms, uint16_t hold_mm, uint16_t full_speed)
+: _hold_ms(hold_ms), _hold_mm(hold_mm), _full_speed(full_speed),
+  _active(false), _first(0), _dir(0), _travelled(0), _last_update(0), _last_white(0) {}
+
+bool robo::LineEscape::update(uint8_t white, const robo::V2_float &velocity, uint32_t now)
+{
+    const uint32_t dt = now - _last_update;
+    _last_update = now;
+    if (white) {
+        if (!_active) {
+            // 最初に白を読んだ => 離れる方向を決める
+            _active = true;
+            _first = white;
+            robo::V2_float away;
+            if (white & left) away += away_from_left;
+            if (white & right) away += away_from_right;
+            if (white & back) away += away_from_back;
+            const float speed = velocity.mag();
+            if (speed > 1) {
+                away -= velocity / speed;
+            }
+            // 左右が同時に白で、止まっていた => 後ろに下がる
+            _dir = (away == robo::V2_float()) ? PI : away.angle();
+        }
+        _last_white = now;
+        _travelled = 0;
+        return true;
+    }
+    if (!_active) return false;
+    // 速さ(0-100程度) * full_speed / 100 (mm/s) * dt (ms) / 1000
+    _travelled += velocity.mag() * _full_speed * dt / 100000.0f;
+    if (now - _last_white >= _hold_ms || (_hold_mm != 0 && _travelled >= _hold_mm)) {
+        _active = false;
+    }
+    return _active;
+}
+
+robo::move_info::Escape *robo::LineEscape::make_info(int8_t speed) const
+{
+    return new robo::move_info::Escape(_dir, speed, _first);
+}
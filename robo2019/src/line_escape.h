@@ -0,0 +1,109 @@
+/**
+ * @file line_escape.h
+ * @brief ラインを踏んだときに離れる方向を決め、離れ終わるまで覚えておくクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_LINE_ESCAPE_H
+#define ROBO2019_LINE_ESCAPE_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "move_info.h"
+#include "vec2d.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class LineEscape
+ * @brief ラインから離れる動きを管理する
+ * @details
+ *  その時のラインセンサーの値だけで方向を決めると、機体がラインをまたいですべてのセンサーが白になったときや、
+ *  最初に反応したセンサーが先に黒に戻ったときに、反対側(フィールドの外)に進んでしまう。
+ *  そこで、最初に白を読んだセンサーと、その直前に進んでいた方向から離れる方向を決めて覚えておき、
+ *  すべてのセンサーが黒に戻ってからも、決めた時間か距離だけ同じ方向に進み続ける。
+ *  - 最初に白を読んだセンサーから遠ざかる向き(左なら右、右なら左、後ろなら前)
+ *  - 直前に進んでいた向きの逆(ラインに向かって進んできたので)
+ *  の2つの単位ベクトルを足した方向に進む。
+ */
+class LineEscape
+{
+public:
+    /** @brief ラインセンサーの位置(ビットマスク) */
+    enum Side : uint8_t {
+        left = 1,
+        right = 2,
+        back = 4,
+    };
+
+private:
+    const uint16_t _hold_ms;
+    const uint16_t _hold_mm;
+    const uint16_t _full_speed;
+    bool _active;
+    uint8_t _first;
+    float _dir;
+    float _travelled;
+    uint32_t _last_update;
+    uint32_t _last_white;
+
+public:
+    /**
+     * @brief Construct a new LineEscape object
+     * @param[in] hold_ms すべてのセンサーが黒に戻ってから、離れ続ける時間(ミリ秒)
+     * @param[in] hold_mm すべてのセンサーが黒に戻ってから、離れ続ける距離(mm)。0なら時間だけで決める
+     * @param[in] full_speed 速さ100で進んだときの実際の速さ(mm/s)。距離の見積もりに使う
+     * @details hold_msとhold_mmのどちらかが過ぎたら離れ終わる
+     */
+    LineEscape(uint16_t hold_ms = 150, uint16_t hold_mm = 0, uint16_t full_speed = 1000);
+
+    /**
+     * @brief 毎周期呼んで、状態を更新する
+     * @param[in] white 白を読んだラインセンサー(Sideのビットマスク)
+     * @param[in] velocity 今の機体の速度ベクトル(MoveInfo::velocity())
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return bool ラインから離れている途中ならtrue
+     */
+    bool update(uint8_t white, const robo::V2_float &velocity, uint32_t now);
+
+    /** @brief ラインから離れている途中かどうか */
+    bool active() const { return _active; }
+    /** @brief 最初に白を読んだラインセンサー(Sideのビットマスク) */
+    uint8_t first() const { return _first; }
+    /** @brief 離れる方向(ラジアン) */
+    float direction() const { return _dir; }
+
+    /**
+     * @brief 離れる方向を上書きする
+     * @param[in] dir 方向(ラジアン)
+     * @details ペナルティエリアの前など、センサー以外の情報で方向がわかる場合に使う
+     */
+    void set_direction(float dir) { _dir = dir; }
+
+    /**
+     * @brief 離れる動きを作る
+     * @param[in] speed 速さ
+     * @return move_info::Escape* 作った動き。deleteは呼び出し側で行う
+     */
+    robo::move_info::Escape *make_info(int8_t speed) const;
+
+    /** @brief 離れている途中の状態を解除する */
+    void reset() { _active = false; }
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_LINE_ESCAPE_H */
@@ -10,6 +10,7 @@
 
 #ifdef ARDUINO
 
+#include "pin.h"
 #include "util.h"
 
 /**
@@ -19,19 +20,16 @@
 namespace robo {
 
 /**
- * @class LineSensor
- * @brief ラインセンサー操作用のクラス
+ * @class LineSensorBase
+ * @brief ラインセンサーの、ピン番号によらない部分
  * @note robo::Sensorはutil.h内
  */
-class LineSensor : public robo::Sensor
+class LineSensorBase : public robo::Sensor
 {
 public:
     //! センサーの値がこれ以上であれば白
     static int white_border;
 
-    //! センサーのピン
-    const uint8_t in_pin;
-
     /**
      * @fb bool iswhite(int c)
      * @brief 値が白色か判別する
@@ -39,16 +37,22 @@ public:
      * @return 白色かどうか
      */
     static bool iswhite(int c);
+};
 
-    LineSensor() = delete;
-    /**
-     * @brief コンストラクタ
-     * @param[in] i ラインセンサーのピン番号
-     */
-    LineSensor(uint8_t i) : in_pin(i) {}
+/**
+ * @class LineSensor
+ * @brief ラインセンサー操作用のクラス
+ * @tparam in_pin ラインセンサーをつないだアナログピンの番号
+ */
+template<uint8_t in_pin>
+class LineSensor : public robo::LineSensorBase
+{
+public:
+    //! センサーのピン
+    using Pin = robo::AnalogPin<in_pin>;
 
-    void setup() override;
-    int read() override;
+    void setup() override { Pin::setup(); }
+    int read() override { return Pin::read(); }
 };
 
 } // namespace robo
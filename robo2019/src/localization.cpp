@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include "localization.h"
+#include "fastmath.h"
+
+namespace {
+    // 移動平均で target に近づける
+    int16_t approach(int16_t current, int16_t target, uint8_t shift)
+    {
+        return current + int16_t((int32_t(target) - current) / (int32_t(1) << shift));
+    }
+}
+
+// 目安の値。実際の機体で測り直すこと
+const uint16_t robo::Localizer::default_range_table[] PROGMEM = {
+    0, 80, 170, 270, 390, 540, 730, 980, 1320, 1800, 2500, 3500,
+};
+const uint8_t robo::Localizer::default_range_size =
+    sizeof(robo::Localizer::default_range_table) / sizeof(robo::Localizer::default_range_table[0]);
+
+robo::Localizer::Localizer(const uint16_t *range_table, uint8_t range_size, uint8_t range_step, uint8_t smoothing)
+: _range_table(range_table), _range_size(range_size), _range_step(range_step),
+  _smoothing(smoothing), _pose{0, 0, 0, 255} {}
+
+robo::Localizer::Localizer(uint8_t smoothing)
+: Localizer(default_range_table, default_range_size, 8, smoothing) {}
+
+uint16_t robo::Localizer::range(uint16_t px) const
+{
+    const uint16_t i = px / _range_step;
+    if (i >= _range_size - 1) return pgm_read_word(&_range_table[_range_size - 1]);
+    const uint16_t a = pgm_read_word(&_range_table[i]);
+    const uint16_t b = pgm_read_word(&_range_table[i + 1]);
+    return a + uint16_t(uint32_t(b - a) * (px - i * _range_step) / _range_step);
+}
+
+bool robo::Localizer::measure(
+    const robo::openmv::Position &goal_pos, int16_t goal_x, robo::Angle heading,
+    int16_t &x, int16_t &y, uint16_t &dist
+) const
+{
+    // 機体の相対座標系でのゴールの位置(ピクセル)。openmv::pos2dirと同じ向き
+    const int16_t f = int16_t(goal_pos.y) - int16_t(robo::openmv::center.y);
+    const int16_t l = int16_t(robo::openmv::center.x) - int16_t(goal_pos.x);
+    const uint32_t r_sq = int32_t(f) * f + int32_t(l) * l;
+    if (r_sq == 0) return false;
+    const uint16_t r = robo::fastmath::isqrt(r_sq);
+    // 掛け算があふれないよう、フィールドより十分大きい値で抑える
+    dist = min(range(r), uint16_t(8000));
+    // 相対座標系でのゴールまでのベクトル(mm)
+    const int32_t vf = int32_t(f) * dist / r;
+    const int32_t vl = int32_t(l) * dist / r;
+    // 機体の向きだけ回してフィールドの座標系に直す
+    const int32_t c = heading.cos(), s = heading.sin();
+    const int16_t gx = int16_t(robo::Angle::unscale(vf * c - vl * s));
+    const int16_t gy = int16_t(robo::Angle::unscale(vf * s + vl * c));
+    x = goal_x - gx;
+    y = -gy;
+    return true;
+}
+
+bool robo::Localizer::update(
+    const robo::openmv::Position *y_goal_pos, const robo::openmv::Position *b_goal_pos, robo::Angle heading
+)
+{
+    int16_t yx, yy, bx, by;
+    uint16_t yd, bd;
+    const bool y_ok = y_goal_pos != NULL && measure(*y_goal_pos, robo::field::goal_x, heading, yx, yy, yd);
+    const bool b_ok = b_goal_pos != NULL && measure(*b_goal_pos, -robo::field::goal_x, heading, bx, by, bd);
+    int16_t x, y;
+    if (y_ok && b_ok) {
+        // 近いゴールほど重くする(重みは相手のゴールまでの距離)
+        const int32_t w = int32_t(yd) + bd;
+        if (w == 0) {
+            x = (yx + bx) / 2;
+            y = (yy + by) / 2;
+        } else {
+            x = int16_t((int32_t(yx) * bd + int32_t(bx) * yd) / w);
+            y = int16_t((int32_t(yy) * bd + int32_t(by) * yd) / w);
+        }
+    } else if (y_ok) {
+        x = yx; y = yy;
+    } else if (b_ok) {
+        x = bx; y = by;
+    } else {
+        miss();
+        return false;
+    }
+    if (!valid()) {
+        // 推定がない、または古すぎる => 平均をとらずに置き換える
+        _pose.x = x;
+        _pose.y = y;
+    } else {
+        _pose.x = approach(_pose.x, x, _smoothing);
+        _pose.y = approach(_pose.y, y, _smoothing);
+    }
+    _pose.goals = uint8_t(y_ok) + uint8_t(b_ok);
+    _pose.age = 0;
+    return true;
+}
+
+bool robo::Localizer::update(const robo::openmv::Frame &frame, robo::Angle heading)
+{
+    return update(frame.y_goal_pos, frame.b_goal_pos, heading);
+}
+
+void robo::Localizer::miss()
+{
+    if (_pose.age != 255) _pose.age++;
+}
+
+int16_t robo::Localizer::margin() const
+{
+    return min(
+        int16_t(robo::field::half_length - abs(_pose.x)),
+        int16_t(robo::field::half_width - abs(_pose.y))
+    );
+}
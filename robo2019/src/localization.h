@@ -0,0 +1,161 @@
+/**
+ * @file localization.h
+ * @brief ゴールの見え方と機体の向きから、フィールド上の位置を推定する機能
+ */
+
+#pragma once
+
+#ifndef ROBO2019_LOCALIZATION_H
+#define ROBO2019_LOCALIZATION_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "angle.h"
+#include "openmv.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @brief フィールドの寸法(mm)
+ * @details
+ *  フィールドの座標系は、中心を原点とし、黄色のゴールの方向をx、そこから左に90度の方向をyとする。
+ *  BNO055の方向が0のとき、機体の相対座標系と向きが一致する。
+ */
+namespace field {
+    //! 中心から白線(縦方向)までの距離
+    constexpr int16_t half_length = 1095;
+    //! 中心から白線(横方向)までの距離
+    constexpr int16_t half_width = 790;
+    //! 中心からゴールの奥までの距離
+    constexpr int16_t goal_x = 1170;
+}
+
+/**
+ * @class Localizer
+ * @brief ゴールの位置とBNO055の方向から、フィールド上の機体の位置を推定する
+ * @details
+ *  見えているゴールそれぞれについて、画像の中心からのピクセル数を距離の表で実際の距離に直し、
+ *  ゴールの方向と機体の向きからゴールを基準にした機体の位置を求める。
+ *  両方のゴールが見えているときは、近い方のゴールほど重くして平均する(遠いほど距離の誤差が大きいため)。
+ *  結果は指数移動平均でならす。
+ *  計算はすべて整数で行い、sin/cosはrobo::Angleの表から引く。ATmega328Pで1回0.2ms程度。
+ * @note
+ *  フレームにはゴールの大きさが含まれないため、距離は画像の中心からの距離だけで決める。
+ *  鏡の形や取り付けの高さを変えたときは、距離の表を測り直すこと。
+ */
+class Localizer
+{
+public:
+    /** @brief 推定した位置 */
+    struct Pose {
+        //! x座標(mm)
+        int16_t x;
+        //! y座標(mm)
+        int16_t y;
+        //! 最後の推定に使ったゴールの数(0なら推定できていない)
+        uint8_t goals;
+        //! 最後にゴールが見えてからのupdate()の回数(255で止まる)
+        uint8_t age;
+    };
+
+    //! 距離の表の既定値(PROGMEM)。画像の中心から8ピクセルごとの、実際の距離(mm)
+    static const uint16_t default_range_table[];
+    //! default_range_tableの要素数
+    static const uint8_t default_range_size;
+
+private:
+    const uint16_t *const _range_table;
+    const uint8_t _range_size;
+    const uint8_t _range_step;
+    const uint8_t _smoothing;
+    Pose _pose;
+
+public:
+    /**
+     * @brief Construct a new Localizer object
+     * @param[in] range_table 距離の表(PROGMEM)。i番目が画像の中心からi * range_stepピクセルの距離(mm)
+     * @param[in] range_size 距離の表の要素数
+     * @param[in] range_step 距離の表の間隔(ピクセル)
+     * @param[in] smoothing 移動平均の強さ。新しい値を1 / 2^smoothingの重みで混ぜる
+     */
+    Localizer(const uint16_t *range_table, uint8_t range_size, uint8_t range_step, uint8_t smoothing = 2);
+    /**
+     * @brief 既定の距離の表を使う
+     * @param[in] smoothing 移動平均の強さ。新しい値を1 / 2^smoothingの重みで混ぜる
+     */
+    Localizer(uint8_t smoothing = 2);
+
+    /**
+     * @brief 画像上の距離を実際の距離に直す
+     * @param[in] px 画像の中心からのピクセル数
+     * @return uint16_t 距離(mm)
+     */
+    uint16_t range(uint16_t px) const;
+
+    /**
+     * @brief ゴール1つから、機体の位置を求める
+     * @param[in] goal_pos ゴールのカメラ上の座標
+     * @param[in] goal_x ゴールのフィールド上のx座標(yは0)
+     * @param[in] heading 機体の向き(左回りが正)
+     * @param[out] x 機体のx座標(mm)
+     * @param[out] y 機体のy座標(mm)
+     * @param[out] dist ゴールまでの距離(mm)
+     * @return bool ゴールが画像の中心と重なっていて方向がわからない場合はfalse
+     */
+    bool measure(const robo::openmv::Position &goal_pos, int16_t goal_x, robo::Angle heading,
+        int16_t &x, int16_t &y, uint16_t &dist) const;
+
+    /**
+     * @brief 位置の推定を更新する
+     * @param[in] y_goal_pos 黄色のゴールのカメラ上の座標(見えていなければNULL)
+     * @param[in] b_goal_pos 青色のゴールのカメラ上の座標(見えていなければNULL)
+     * @param[in] heading 機体の向き(左回りが正)
+     * @return bool ゴールが見えて推定を更新できたらtrue
+     */
+    bool update(const robo::openmv::Position *y_goal_pos, const robo::openmv::Position *b_goal_pos, robo::Angle heading);
+
+    /**
+     * @brief 位置の推定を更新する
+     * @param[in] frame OpenMVから読み取ったフレーム
+     * @param[in] heading BNO055で取得した機体の向き
+     * @return bool ゴールが見えて推定を更新できたらtrue
+     */
+    bool update(const robo::openmv::Frame &frame, robo::Angle heading);
+
+    /**
+     * @brief ゴールが見えなかったことを記録する(ageだけを進める)
+     */
+    void miss();
+
+    /** @brief 推定した位置 */
+    const Pose &pose() const { return _pose; }
+
+    /**
+     * @brief 推定が使えるかどうか
+     * @param[in] max_age 最後にゴールが見えてから何回までのupdate()/miss()を許すか
+     * @return bool 推定できていて、max_age回以内にゴールが見えていればtrue
+     */
+    bool valid(uint8_t max_age = 30) const { return _pose.goals != 0 && _pose.age <= max_age; }
+
+    /**
+     * @brief 白線までの最短距離
+     * @return int16_t 距離(mm)。フィールドの外にいると推定されるときは負
+     */
+    int16_t margin() const;
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_LOCALIZATION_H */
@@ -0,0 +1,42 @@
+#include <Arduino.h>
+#include "maneuver.h"
+
+robo::Maneuver::Maneuver(robo::Motor &motor)
+: _motor(motor), _script(NULL), _length(0), _index(0), _priority(0), _scale(1), _step_start(0), _duration(0) {}
+
+void robo::Maneuver::begin_step(uint32_t now)
+{
+    Step step;
+    memcpy_P(&step, &_script[_index], sizeof(Step));
+    _step_start = now;
+    _duration = step.scaled ? uint32_t(step.ms) * _scale : step.ms;
+    _motor.set_all_motors(step.power[0], step.power[1], step.power[2], step.power[3]);
+}
+
+bool robo::Maneuver::start_P(const Step *script, uint8_t length, uint32_t now, uint8_t priority, uint16_t scale)
+{
+    if (length == 0) return false;
+    if (running() && priority < _priority) return false;
+    _script = script;
+    _length = length;
+    _index = 0;
+    _priority = priority;
+    _scale = scale;
+    begin_step(now);
+    return true;
+}
+
+bool robo::Maneuver::update(uint32_t now)
+{
+    if (!running()) return false;
+    // 1周期の間に複数のステップが過ぎることもある
+    while (now - _step_start >= _duration) {
+        const uint32_t end = _step_start + _duration;
+        if (++_index >= _length) {
+            _script = NULL;
+            return false;
+        }
+        begin_step(end);
+    }
+    return true;
+}
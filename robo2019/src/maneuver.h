@@ -0,0 +1,130 @@
+/**
+ * @file maneuver.h
+ * @brief 決まった時間ずつモーターを動かす手順を、止まらずに進めるクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_MANEUVER_H
+#define ROBO2019_MANEUVER_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "motor.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Maneuver
+ * @brief モーターの出力と時間の組(Step)を順に再生する
+ * @details
+ *  delay()で待つ代わりに、毎周期update()を呼ぶと、時間が過ぎたステップから次に進む。
+ *  待っている間もボールやライン、方向を読めるので、より優先度の高い手順で途中から置き換えられる。
+ *  手順(Stepの配列)はPROGMEMに置く。
+ * @note
+ *  ```C++
+ *  const robo::Maneuver::Step script[] PROGMEM = {
+ *      { {  60,  60,  60,  60 }, 10, true },  // 前進(10ms * scale)
+ *      { {   0,   0,   0,   0 }, 20, false }, // 20ms止まる
+ *      { { -40, -40, -40, -40 }, 10, true },  // 後退(10ms * scale)
+ *  };
+ *  maneuver.start(script, millis(), 1, 25);
+ *  // loop()の中で
+ *  if (maneuver.update(millis())) return;
+ *  ```
+ */
+class Maneuver
+{
+public:
+    /** @brief 手順の1ステップ */
+    struct Step {
+        //! モーター1-4のパワー(Motor::set_all_motors()の順)
+        int8_t power[4];
+        //! 続ける時間(ミリ秒)
+        uint16_t ms;
+        //! trueならstart()のscaleをmsに掛ける
+        bool scaled;
+    };
+
+private:
+    robo::Motor &_motor;
+    const Step *_script;
+    uint8_t _length;
+    uint8_t _index;
+    uint8_t _priority;
+    uint16_t _scale;
+    uint32_t _step_start;
+    uint32_t _duration;
+
+    void begin_step(uint32_t now);
+
+public:
+    /**
+     * @brief Construct a new Maneuver object
+     * @param[in] motor 出力先のモーター
+     */
+    Maneuver(robo::Motor &motor);
+
+    /**
+     * @brief 手順を始める(ステップ数を指定する版)
+     * @param[in] script 手順(PROGMEMのポインタ)
+     * @param[in] length ステップ数
+     * @param[in] now 現在時刻(ミリ秒)
+     * @param[in] priority 優先度。再生中の手順より低ければ始めない
+     * @param[in] scale Step::scaledのステップの時間に掛ける値
+     * @return bool 始めたらtrue
+     * @details 同じ優先度なら置き換える(同じ手順なら最初からやり直す)
+     */
+    bool start_P(const Step *script, uint8_t length, uint32_t now, uint8_t priority = 0, uint16_t scale = 1);
+
+    /**
+     * @brief 手順を始める
+     * @tparam N ステップ数
+     * @param[in] script 手順(PROGMEMの配列)
+     * @param[in] now 現在時刻(ミリ秒)
+     * @param[in] priority 優先度。再生中の手順より低ければ始めない
+     * @param[in] scale Step::scaledのステップの時間に掛ける値
+     * @return bool 始めたらtrue
+     */
+    template<uint8_t N>
+    bool start(const Step (&script)[N], uint32_t now, uint8_t priority = 0, uint16_t scale = 1)
+    {
+        return start_P(script, N, now, priority, scale);
+    }
+
+    /**
+     * @brief 毎周期呼んで、時間が過ぎたステップを進める
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return bool 再生中ならtrue
+     * @details 最後のステップが終わってもモーターは止めない(次の出力は呼び出し側で決める)
+     */
+    bool update(uint32_t now);
+
+    /** @brief 再生を途中でやめる(モーターは止めない) */
+    void abort() { _script = NULL; }
+
+    /** @brief 再生中かどうか */
+    bool running() const { return _script != NULL; }
+    /** @brief 再生中の手順の優先度 */
+    uint8_t priority() const { return _priority; }
+    /** @brief 再生中のステップの番号 */
+    uint8_t step() const { return _index; }
+    /** @brief 再生中の手順 */
+    const Step *script() const { return _script; }
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_MANEUVER_H */
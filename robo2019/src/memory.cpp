@@ -0,0 +1,98 @@
+#include <Arduino.h>
+#include "memory.h"
+
+// avr-libcのリンカが用意するシンボル
+extern char __data_start, __bss_end, __heap_start;
+extern char *__brkval;
+
+namespace {
+    char *heap_top_max = &__heap_start;
+
+    char *heap_top()
+    {
+        return __brkval == NULL ? &__heap_start : __brkval;
+    }
+
+    char *stack_pointer()
+    {
+        return reinterpret_cast<char *>(SP);
+    }
+}
+
+static_assert(robo::memory::canary == 0xc5, "update the literal in robo_memory_paint");
+
+// スタックを使わずに.bssの末尾(_end)からスタックの底(__stack)までを塗りつぶす。
+// .init3はスタックポインタの設定後、.data/.bssの初期化前に実行される
+void robo_memory_paint() __attribute__((naked, used, section(".init3")));
+void robo_memory_paint()
+{
+    __asm__ volatile (
+        "    ldi r30, lo8(_end)    \n"
+        "    ldi r31, hi8(_end)    \n"
+        "    ldi r24, 0xc5         \n"
+        "    ldi r25, hi8(__stack) \n"
+        "    rjmp 2f               \n"
+        "1:  st Z+, r24            \n"
+        "2:  cpi r30, lo8(__stack) \n"
+        "    cpc r31, r25          \n"
+        "    brlo 1b               \n"
+        "    breq 1b               \n"
+    );
+}
+
+void robo::memory::update()
+{
+    char *top = heap_top();
+    if (top > heap_top_max) heap_top_max = top;
+}
+
+uint16_t robo::memory::static_size()
+{
+    return &__bss_end - &__data_start;
+}
+
+uint16_t robo::memory::heap_used()
+{
+    return heap_top() - &__heap_start;
+}
+
+uint16_t robo::memory::heap_high_water()
+{
+    update();
+    return heap_top_max - &__heap_start;
+}
+
+uint16_t robo::memory::free_now()
+{
+    return stack_pointer() - heap_top();
+}
+
+uint16_t robo::memory::stack_free_min()
+{
+    update();
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(heap_top_max);
+    const uint8_t *end = reinterpret_cast<const uint8_t *>(stack_pointer());
+    uint16_t count = 0;
+    while (p < end && *p == canary) {
+        ++p;
+        ++count;
+    }
+    return count;
+}
+
+size_t robo::memory::print_info(Print &out)
+{
+    // このための一時バッファを取らないよう、直接出力する
+    size_t n = 0;
+    n += out.print(F("mem static:"));
+    n += out.print(static_size());
+    n += out.print(F(" heap:"));
+    n += out.print(heap_used());
+    n += out.print('/');
+    n += out.print(heap_high_water());
+    n += out.print(F(" free:"));
+    n += out.print(free_now());
+    n += out.print(F(" stack_free_min:"));
+    n += out.println(stack_free_min());
+    return n;
+}
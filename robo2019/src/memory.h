@@ -0,0 +1,88 @@
+/**
+ * @file memory.h
+ * @brief SRAMの使用状況の監視
+ */
+
+#pragma once
+
+#ifndef ROBO2019_MEMORY_H
+#define ROBO2019_MEMORY_H
+
+#ifdef ARDUINO
+
+#include <Print.h>
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @brief SRAMの使用状況を監視する機能をまとめたもの
+ * @details
+ *  起動直後(.init3)にヒープの先頭からスタックの底までを`canary`で塗りつぶしておき、
+ *  塗られたまま残っているバイト数からスタックの最大使用量を求める。
+ *  ヒープの最大使用量はupdate()を呼んだときの値の最大値。
+ *  `loop()`の中でupdate()を呼んでおき、ログを出すときにprint_info()などで表示するとよい。
+ */
+namespace memory {
+    //! スタック領域を塗りつぶす値
+    constexpr uint8_t canary = 0xc5;
+
+    /**
+     * @brief ヒープの最大使用量を更新する
+     * @note ヒープを使う処理の後に呼ぶと正確になる。毎ループ呼んでも負担はほとんどない
+     */
+    void update();
+
+    /**
+     * @brief 静的に確保された領域(.data + .bss)のサイズ
+     * @return バイト数
+     */
+    uint16_t static_size();
+
+    /**
+     * @brief 現在のヒープ使用量
+     * @return バイト数
+     */
+    uint16_t heap_used();
+
+    /**
+     * @brief ヒープ使用量の最大値(最高水位)
+     * @return バイト数
+     */
+    uint16_t heap_high_water();
+
+    /**
+     * @brief 現在の空き容量(ヒープの末尾からスタックポインタまで)
+     * @return バイト数
+     */
+    uint16_t free_now();
+
+    /**
+     * @brief 起動してからの、ヒープとスタックの間の空き容量の最小値
+     * @return バイト数
+     * @details ヒープの最高水位から上に向かって、塗られたまま残っているバイトを数える。
+     *  0に近いほどスタックとヒープの衝突(リセットの原因)が起こりやすい
+     */
+    uint16_t stack_free_min();
+
+    /**
+     * @brief 使用状況を1行で出力する
+     * @param[out] out 出力先
+     * @return size_t 出力した文字数
+     * @details "mem static:<byte> heap:<byte>/<byte> free:<byte> stack_free_min:<byte>"
+     */
+    size_t print_info(Print &out);
+} // namespace memory
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_MEMORY_H */
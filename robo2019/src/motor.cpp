@@ -1,29 +1,41 @@
 #include <Arduino.h>
 #include "motor.h"
 
-uint8_t robo::Motor::power_str(char *dst, uint8_t pin, int8_t power)
+//implementations of robo::Motor
+const robo::Motor::Config robo::Motor::default_config = {
+    0, // slew_rate
+    0, // dead_band
+};
+
+size_t robo::Motor::print_power(Print &out, uint8_t pin, int8_t power)
 {
-    if (dst == NULL)
-        return 0;
-    return sprintf_P(
-        dst,
-        PSTR("%1d%c%03d"),
-        pin,
-        power < 0 ? 'F' : 'R',
-        abs(power));
+    // "%1d%c%03d"と同じ
+    const uint8_t p = abs(power);
+    out.write('0' + pin % 10);
+    out.write(power < 0 ? 'F' : 'R');
+    out.write('0' + p / 100);
+    out.write('0' + p / 10 % 10);
+    out.write('0' + p % 10);
+    return 5;
+}
+
+size_t robo::Motor::power_str(char *dst, size_t size, uint8_t pin, int8_t power)
+{
+    robo::BufferPrint out(dst, size);
+    robo::Motor::print_power(out, pin, power);
+    return out.length();
 }
 
 void robo::Motor::power_str(String *dst, uint8_t pin, int8_t power)
 {
-    char buffer[8] = "";
-    robo::Motor::power_str(buffer, pin, power);
-    *dst = String(buffer);
+    if (dst == NULL) return;
+    *dst = robo::Motor::power_str(pin, power);
 }
 
 String robo::Motor::power_str(uint8_t pin, int8_t power)
 {
-    char buffer[8] = "";
-    robo::Motor::power_str(buffer, pin, power);
+    char buffer[6] = "";
+    robo::Motor::power_str(buffer, sizeof(buffer), pin, power);
     return String(buffer);
 }
 
@@ -45,17 +57,58 @@ bool robo::Motor::_update(uint8_t pin, int8_t power)
     return true;
 }
 
+void robo::Motor::_send(uint8_t pin, int8_t power)
+{
+    if (!_update(pin, power)) return;
+    robo::Motor::print_power(*_port, pin, power);
+    _port->write('\n');
+}
+
+void robo::Motor::_set_target(uint8_t pin, int8_t power)
+{
+    int8_t &target = _targets[pin - 1];
+    // ±1のような小さな変化で、毎回6バイトを送らないようにする。
+    // 目標の変化に対して判断するので、決めた目標には必ずたどり着く
+    if (power != 0 && abs(power - target) < _config.dead_band) return;
+    target = power;
+    if (_config.slew_rate != 0) return;
+    _send(pin, power);
+}
+
 void robo::Motor::stop()
 {
     _port->print(F("1F000\n2F000\n3F000\n4F000\n"));
     memset(_powers, 0, 4);
+    memset(_targets, 0, 4);
+}
+
+void robo::Motor::update(uint32_t dt)
+{
+    if (_config.slew_rate == 0) return;
+    // 止まっていたときも、1回で変える量は1秒分まで
+    if (dt > 1000000UL) dt = 1000000UL;
+    // 1に満たない変化量と100マイクロ秒に満たない時間は次に持ち越す(切り捨てると、周期が短いほど遅くなる)
+    dt += _slew_dt_rem;
+    _slew_dt_rem = dt % 100;
+    const uint32_t acc = uint32_t(_config.slew_rate) * (dt / 100) + _slew_rem;
+    const uint32_t step = acc / 10000;
+    _slew_rem = acc - step * 10000;
+    if (step == 0) return;
+    const int16_t max_step = step > 200 ? 200 : int16_t(step);
+    for (uint8_t pin = 1; pin <= 4; pin++) {
+        const int8_t power = _powers[pin - 1];
+        int16_t diff = int16_t(_targets[pin - 1]) - power;
+        if (diff > max_step) diff = max_step;
+        if (diff < -max_step) diff = -max_step;
+        _send(pin, power + diff);
+    }
 }
 
 int8_t robo::Motor::get_power(uint8_t pin) const { return _powers[pin - 1]; }
 
-uint8_t robo::Motor::get_power_str(char *dst, uint8_t pin)
+size_t robo::Motor::get_power_str(char *dst, size_t size, uint8_t pin) const
 {
-    return robo::Motor::power_str(dst, pin, get_power(pin));
+    return robo::Motor::power_str(dst, size, pin, get_power(pin));
 }
 
 void robo::Motor::get_power_str(String *dst, uint8_t pin)
@@ -70,30 +123,14 @@ String robo::Motor::get_power_str(uint8_t pin) const
 
 void robo::Motor::set_one_motor(uint8_t pin, int8_t power)
 {
-    if (!_update(pin, power))
-        return;
-    char buffer[8] = "";
-    robo::Motor::power_str(buffer, pin, power);
-    _port->println(buffer);
+    _set_target(pin, power);
 }
 
 void robo::Motor::set_all_motors(int8_t m1, int8_t m2, int8_t m3, int8_t m4, bool maximize)
 {
-    char buffer[32] = "";
-    char *buf_ptr = buffer;
     int8_t ps[] = { m1, m2, m3, m4 };
     if (maximize) robo::Motor::scale_powers(ps, 100);
-    for (int pin = 1; pin <= 4; pin++)
-    {
-        int8_t &p = ps[pin - 1];
-        if (!_update(pin, p))
-            continue;
-        robo::Motor::power_str(buf_ptr, pin, p);
-        buf_ptr[5] = '\n';
-        buf_ptr += 6;
-    }
-    buf_ptr[0] = '\0';
-    _port->print(buffer);
+    for (uint8_t pin = 1; pin <= 4; pin++) _set_target(pin, ps[pin - 1]);
 }
 
 void robo::Motor::set_velocity(const float &vx, const float &vy, bool maximize)
@@ -119,28 +156,25 @@ void robo::Motor::set_dir_and_speed(const float &dir, int8_t speed, bool maximiz
     set_velocity(speed * cos(dir), speed * sin(dir), maximize);
 }
 
+void robo::Motor::set_dir_and_speed(robo::Angle dir, int8_t speed, bool maximize)
+{
+    // maximizeのときは向きだけが使われるので、丸めの誤差が小さくなるよう大きさを100にする
+    const int32_t mag = maximize ? 100 : speed;
+    set_velocity(robo::Angle::unscale(mag * dir.cos()), robo::Angle::unscale(mag * dir.sin()), maximize);
+}
+
 void robo::Motor::set_rotate(bool clockwise, int8_t speed)
 {
     int8_t d = clockwise ? 1 : -1;
     set_left_right(speed * d, -speed * d);
 }
 
-uint8_t robo::Motor::info(char *dst)
+size_t robo::Motor::printTo(Print &out) const
 {
-    if (dst == NULL) return 0;
-    char *ptr = dst;
+    size_t n = 0;
     for (uint8_t pin = 1; pin <= 4; pin++) {
-        ptr += get_power_str(ptr, pin);
-        if (pin == 4) continue;
-        strcat(ptr, ", ");
-        ptr += 2;
+        if (pin != 1) n += out.write(", ", 2);
+        n += robo::Motor::print_power(out, pin, get_power(pin));
     }
-    return ptr - dst;
-}
-
-String robo::Motor::info()
-{
-    char buff[32] = "";
-    info(buff);
-    return String(buff);
+    return n;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #ifdef ARDUINO
 
 #include <Print.h>
+#include "util.h"
 #include "vec2d.h"
 
 /**
@@ -18,20 +19,51 @@ namespace robo
 
 /**
  * @brief MCB操作用のクラス
- * @details モーターの配置についてはREADMEを参照
+ * @details
+ *  モーターの配置についてはREADMEを参照。
+ *  printTo(Print&)で現在のパワーを出力するので、`Serial.println(motor)`でバッファを使わずに表示できる。
+ *
+ *  Configでslew_rateを設定すると、set_all_motors()などは目標のパワーを決めるだけになり、
+ *  update()を呼ぶたびに、経過時間に応じた量だけ目標に近づけてMCBに送る。
+ *  全速の後退から全速の前進へ一度に切り替えると、車輪が滑ったり電圧が下がったりするため。
+ *  dead_bandを設定すると、目標のパワーの変化が小さいときは無視して送らない(0にするときは必ず従う)。
+ *  目標に近づけている途中のパワーは必ず送るので、決めた目標には必ずたどり着く。
  */
-class Motor
+class Motor : public Printable
 {
+public: // types
+    /**
+     * @brief パワーの変え方の設定
+     */
+    struct Config {
+        //! 1秒あたりに変えられるパワーの大きさ。0なら制限せず、すぐに送る
+        uint16_t slew_rate;
+        //! 目標のパワーの変化がこれ未満なら無視する(0にするときは必ず従う)。1以下ならすべての変化に従う
+        uint8_t dead_band;
+    };
+
+    //! 標準の設定(制限せず、すべての変化を送る)
+    static const Config default_config;
+
 public: // static functions
+    /**
+     * @brief パワー設定用の文字列を出力する
+     * @param[out] out 出力先
+     * @param[in] pin モーターのピン番号
+     * @param[in] power モーターのパワー
+     * @return size_t 出力した文字数(5文字)
+     */
+    static size_t print_power(Print &out, uint8_t pin, int8_t power);
+
     /**
      * @brief パワー設定用の文字列を取得する
      * @param[out] dst パワー設定用の文字列
+     * @param[in] size dstの容量('\0'を含む)。6以上なら切り詰めない
      * @param[in] pin モーターのピン番号
      * @param[in] power モーターのパワー
-     * @return uint8_t 書き込んだ文字数
-     * @note dstには少なくとも6文字を格納する容量が必要。容量チェックは行っていないため、注意すること。
+     * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
      */
-    static uint8_t power_str(char *dst, uint8_t pin, int8_t power);
+    static size_t power_str(char *dst, size_t size, uint8_t pin, int8_t power);
 
     /**
      * @brief パワー設定用の文字列を取得する
@@ -63,8 +95,15 @@ public: // static functions
     static void scale_powers(int8_t (&powers)[4], int8_t max_val);
 
 private: // variables
-    //! モーターのパワー
+    const Config &_config;
+    //! MCBに送ったモーターのパワー
     int8_t _powers[4];
+    //! 目標のパワー
+    int8_t _targets[4];
+    //! update()で使い切れなかった変化量(1/10000)。周期によらずslew_rateの速さにするため持ち越す
+    uint16_t _slew_rem;
+    //! update()で使い切れなかった時間(マイクロ秒、100未満)
+    uint8_t _slew_dt_rem;
     //! MCBがつながっているシリアルポート
     Print *_port;
 
@@ -77,36 +116,72 @@ private:
      */
     bool _update(uint8_t pin, int8_t power);
 
+    /**
+     * @brief 目標のパワーを設定する
+     * @param[in] pin モーターのピン番号
+     * @param[in] power 目標のパワー
+     * @details
+     *  今の目標との差がdead_band未満なら、0にするとき以外は無視する。
+     *  slew_rateが0ならすぐに送り、そうでなければupdate()で送る
+     */
+    void _set_target(uint8_t pin, int8_t power);
+
+    /**
+     * @brief パワーが変わっていれば送る
+     * @param[in] pin モーターのピン番号
+     * @param[in] power モーターのパワー
+     */
+    void _send(uint8_t pin, int8_t power);
+
 public:
     /**
      * @brief Construct a new Motor object
      * @note シリアルポートがSerialであるものとして初期化
      */
-    Motor() : _powers{0, 0, 0, 0}, _port(NULL) {
-        _port = &Serial;
-    }
+    Motor() : Motor(&Serial) {}
     /**
      * @brief Construct a new Motor object
      * @param serial MCBがつながっているシリアルポート
+     * @param config パワーの変え方の設定
      */
-    Motor(Print *port) : _powers{0, 0, 0, 0}, _port(port) {}
+    Motor(Print *port, const Config &config = default_config)
+        : _config(config), _powers{0, 0, 0, 0}, _targets{0, 0, 0, 0}, _slew_rem(0), _slew_dt_rem(0), _port(port) {}
 
-    /** @brief 停止させる */
+    /**
+     * @brief 停止させる
+     * @note slew_rateによらず、すぐに止める
+     */
     void stop();
 
+    /**
+     * @brief 経過時間に応じた量だけ、パワーを目標に近づけて送る
+     * @param[in] dt 前回呼んでからの時間(マイクロ秒)。robo::Taskに渡されるdtをそのまま使う
+     * @note slew_rateを設定したときは、制御の周期ごとに呼ばないとパワーが変わらない
+     */
+    void update(uint32_t dt);
+
     /**
      * @brief モーターのパワーを取得する
      * @param[in] pin モーターのピン番号
-     * @return int8_t モーターのパワー
+     * @return int8_t MCBに送ったモーターのパワー
      */
     int8_t get_power(uint8_t pin) const;
 
+    /**
+     * @brief 目標のパワーを取得する
+     * @param[in] pin モーターのピン番号
+     * @return int8_t 最後に設定した目標のパワー
+     */
+    int8_t get_target(uint8_t pin) const { return _targets[pin - 1]; }
+
     /**
      * @brief モーターのパワーの文字列表示を取得する
      * @param[out] dst 結果の文字列を保存するポインター
+     * @param[in] size dstの容量('\0'を含む)
      * @param[in] pin モーターのピン番号
+     * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
      */
-    uint8_t get_power_str(char *dst, uint8_t pin);
+    size_t get_power_str(char *dst, size_t size, uint8_t pin) const;
 
     /**
      * @brief モーターのパワーの文字列表示を取得する
@@ -174,6 +249,15 @@ public:
      */
     void set_dir_and_speed(const float &dir, int8_t speed, bool maximize = false);
 
+    /**
+     * @brief 方向と速さで機体の平行移動のベクトルを設定する
+     * @param[in] dir ベクトルの方向
+     * @param[in] speed 速度
+     * @param[in] maximize パワーを最大化するかどうか(デフォルトはfalse)
+     * @details sin/cosを表から引くので、ラジアンで指定するより速い。maxmize=trueの場合、speedは無視される。
+     */
+    void set_dir_and_speed(robo::Angle dir, int8_t speed, bool maximize = false);
+
     /**
      * @brief 機体が回転するようにパワーを設定する
      * @param[in] clockwise 回転の方向(時計回りかどうか)
@@ -183,17 +267,33 @@ public:
 
     /**
      * @brief 現在のパワーを見やすい文字列で出力する
+     * @param[out] out 出力先
+     * @return size_t 出力した文字数
+     * @details "1R000, 2R000, 3R000, 4R000"をバッファを介さずにoutに直接書き込む
+     */
+    size_t printTo(Print &out) const override;
+
+    /**
+     * @brief 現在のパワーを見やすい文字列で取得する
+     * @param[out] dst 文字列を書き込む先
+     * @param[in] size dstの容量('\0'を含む)。28以上なら切り詰めない
+     * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
+     */
+    size_t info(char *dst, size_t size) const { return robo::print_to_buffer(dst, size, *this); }
+
+    /**
+     * @brief 現在のパワーを見やすい文字列で取得する
      * @param[out] dst 文字列を書き込む先
-     * @return uint8_t 書き込んだ文字数
-     * @note バッファオーバーランの可能性あり。少なくとも27文字分の容量が必要
+     * @return size_t 書き込もうとした文字数。N以上なら切り詰めている
      */
-    uint8_t info(char *dst);
+    template<size_t N>
+    size_t info(char (&dst)[N]) const { return info(dst, N); }
 
     /**
      * @brief 現在のパワーを見やすい文字列で取得する
      * @return String 結果の文字列
      */
-    String info();
+    String info() const { return robo::print_to_string(*this); }
 };
 
 } // namespace robo
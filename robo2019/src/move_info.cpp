@@ -4,21 +4,18 @@
 //implementations of robo::move_info::Stop
 void robo::move_info::Stop::apply(robo::Motor & motor)
 {
-    motor.stop();
+    // 制御の周期ごとに呼ばれるので、止まっているときは送らない(19200bpsで24バイトは約12.5ミリ秒)
+    for (uint8_t pin = 1; pin <= 4; pin++) {
+        if (motor.get_power(pin) != 0 || motor.get_target(pin) != 0) {
+            motor.stop();
+            return;
+        }
+    }
 }
 
-uint8_t robo::move_info::Stop::to_string(char * dst)
+size_t robo::move_info::Stop::printTo(Print & out) const
 {
-    if (dst == NULL) return 0;
-    strcat_P(dst, PSTR("MoveInfo: Stop"));
-    return 14;
-}
-
-String robo::move_info::Stop::to_string()
-{
-    char buffer[16] = "";
-    to_string(buffer);
-    return String(buffer);
+    return out.print(F("MoveInfo: Stop"));
 }
 
 //implementations of robo::move_info::Translate
@@ -33,22 +30,12 @@ void robo::move_info::Translate::apply(robo::Motor & motor)
     motor.set_velocity(vec, maximize);
 }
 
-uint8_t robo::move_info::Translate::to_string(char * dst)
+size_t robo::move_info::Translate::printTo(Print & out) const
 {
-    if (dst == NULL) return 0;
-    char * ptr = dst;
-    strcat_P(ptr, PSTR("MoveInfo: Translate("));
-    ptr += 20; // len("MoveInfo: Translate(") == 20
-    ptr += vec.to_string(ptr);
-    ptr += sprintf_P(ptr, PSTR(", %s)"), maximize ? PSTR("true") : PSTR("false"));
-    return ptr - dst;
-}
-
-String robo::move_info::Translate::to_string()
-{
-    char buffer[64] = "";
-    to_string(buffer);
-    return String(buffer);
+    size_t n = out.print(F("MoveInfo: Translate("));
+    n += vec.printTo(out);
+    n += out.print(maximize ? F(", true)") : F(", false)"));
+    return n;
 }
 
 //implementations of robo::move_info::Rotate
@@ -60,20 +47,36 @@ void robo::move_info::Rotate::apply(robo::Motor & motor)
     motor.set_rotate(clockwise, speed);
 }
 
-uint8_t robo::move_info::Rotate::to_string(char * dst)
+size_t robo::move_info::Rotate::printTo(Print & out) const
+{
+    size_t n = out.print(clockwise ? F("MoveInfo: Rotate(true, ") : F("MoveInfo: Rotate(false, "));
+    n += out.print(speed);
+    n += out.print(')');
+    return n;
+}
+
+//implementations of robo::move_info::Escape
+robo::move_info::Escape::Escape(const float dir, const int8_t speed, const uint8_t first)
+: dir(dir), speed(speed), first(first) {}
+
+void robo::move_info::Escape::apply(robo::Motor & motor)
+{
+    motor.set_dir_and_speed(dir, speed);
+}
+
+size_t robo::move_info::Escape::printTo(Print & out) const
 {
-    if (dst == NULL) return 0;
-    return sprintf_P(
-        dst,
-        PSTR("MoveInfo: Rotate(%s, %d)"),
-        clockwise ? PSTR("true") : PSTR("false"),
-        speed
-    );
+    size_t n = out.print(F("MoveInfo: Escape("));
+    n += out.print(dir, 2);
+    n += out.print(F(", "));
+    n += out.print(speed);
+    n += out.print(F(", 0x"));
+    n += out.print(first, HEX);
+    n += out.print(')');
+    return n;
 }
 
-String robo::move_info::Rotate::to_string()
+robo::V2_float robo::move_info::Escape::velocity() const
 {
-    char buffer[64] = "";
-    to_string(buffer);
-    return String(buffer);
+    return robo::V2_float::from_polar_coord(dir, speed);
 }
@@ -8,6 +8,7 @@
 
 #include "vec2d.h"
 #include "motor.h"
+#include "util.h"
 
 /**
  * @brief 自作ライブラリの機能をまとめたもの
@@ -21,20 +22,52 @@ namespace robo
 namespace move_info
 {
 
-    class MoveInfo
+    /**
+     * @brief 移動情報の基底クラス
+     * @details printTo(Print&)を実装しているので、`Serial.println(*m_info)`でバッファを使わずに出力できる
+     */
+    class MoveInfo : public Printable
     {
     public:
+        virtual ~MoveInfo() = default;
         virtual void apply(robo::Motor &motor) = 0;
-        virtual uint8_t to_string(char *dst) = 0;
-        virtual String to_string() = 0;
+        /**
+         * @brief 文字列表現を出力する
+         * @param[out] out 出力先
+         * @return size_t 出力した文字数
+         */
+        size_t printTo(Print &out) const override = 0;
+        /**
+         * @brief 文字列表現を返す
+         * @param[out] dst 書き込む先
+         * @param[in] size dstの容量('\0'を含む)
+         * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
+         */
+        size_t to_string(char *dst, size_t size) const { return robo::print_to_buffer(dst, size, *this); }
+        /**
+         * @brief 文字列表現を返す
+         * @param[out] dst 書き込む先
+         * @return size_t 書き込もうとした文字数。N以上なら切り詰めている
+         */
+        template<size_t N>
+        size_t to_string(char (&dst)[N]) const { return to_string(dst, N); }
+        /**
+         * @brief 文字列表現を返す
+         * @return String 文字列
+         */
+        String to_string() const { return robo::print_to_string(*this); }
+        /**
+         * @brief この動きでの機体の速度ベクトル
+         * @return robo::V2_float 速度ベクトル。回転や停止では(0, 0)
+         */
+        virtual robo::V2_float velocity() const { return robo::V2_float(0, 0); }
     };
 
     class Stop final : public MoveInfo
     {
     public:
         void apply(robo::Motor &motor) override;
-        uint8_t to_string(char *dst) override;
-        String to_string() override;
+        size_t printTo(Print &out) const override;
     };
 
     class Translate final : public MoveInfo
@@ -48,8 +81,8 @@ namespace move_info
         Translate(const robo::V2_float &vec, bool maximize = false);
 
         void apply(robo::Motor &motor) override;
-        uint8_t to_string(char *dst) override;
-        String to_string() override;
+        size_t printTo(Print &out) const override;
+        robo::V2_float velocity() const override { return vec; }
     };
 
     class Rotate final : public MoveInfo
@@ -62,8 +95,34 @@ namespace move_info
         Rotate(const bool clockwise, const int8_t speed);
 
         void apply(robo::Motor &motor) override;
-        uint8_t to_string(char *dst) override;
-        String to_string() override;
+        size_t printTo(Print &out) const override;
+    };
+
+    /**
+     * @brief ラインから離れる動き
+     * @details
+     *  動きとしてはTranslateと同じだが、他の動きを上書きしていることがログでわかるよう別のクラスにしている。
+     *  robo::LineEscapeが作る。
+     */
+    class Escape final : public MoveInfo
+    {
+    private:
+        const float dir;
+        const int8_t speed;
+        const uint8_t first;
+
+    public:
+        /**
+         * @brief Construct a new Escape object
+         * @param dir 進む方向(ラジアン)
+         * @param speed 速さ
+         * @param first 最初に白を読んだラインセンサー(robo::LineEscape::Sideのビットマスク)
+         */
+        Escape(const float dir, const int8_t speed, const uint8_t first);
+
+        void apply(robo::Motor &motor) override;
+        size_t printTo(Print &out) const override;
+        robo::V2_float velocity() const override;
     };
 
 } // namespace move_info
@@ -0,0 +1,219 @@
+/**
+ * @file offense_strategy.h
+ * @brief offense.inoの動きの決め方(Context、条件、各状態での動き、状態と遷移の表)
+ * @details
+ *  robo::Strategyに渡す表と、そこから呼ぶ関数をまとめたもの。
+ *  offense.inoのほか、extras/host_test/test_strategy.cppとexamples/latency、examples/benchmarkからも読み込み、
+ *  実機と同じ表で遷移や遅延、実行時間を確かめる。robo2019.hには含めない。
+ *
+ *  次のものを定義してから読み込むこと(offense.inoでは、パラメーターやline_escapeの定義の後)。
+ *  - param::max_speed, param::rotate_gain, param::rotate_base と、それを添字にとるparams
+ *  - front_range (robo::Angle)
+ *  - line_escape (robo::LineEscape)
+ *  - m_info (reset()でrobo::move_info::MoveInfo *を受け取り、boolと->で今の動きを返す)
+ *  - USE_USSを定義したときは、uss::left, uss::right, uss::backとHPI
+ */
+
+#pragma once
+
+#ifndef ROBO2019_OFFENSE_STRATEGY_H
+#define ROBO2019_OFFENSE_STRATEGY_H
+
+#ifdef ARDUINO
+
+#include "angle.h"
+#include "fastmath.h"
+#include "line_escape.h"
+#include "localization.h"
+#include "move_info.h"
+#include "openmv.h"
+#include "orbit.h"
+#include "strategy.h"
+
+// 推定した位置で、白線までこれより近づいたら離れる(mm)
+constexpr int16_t boundary_margin = 150;
+// 白線からこれより離れたら、離れるのをやめる(mm)
+constexpr int16_t safe_margin = 250;
+
+// 動きを決めるための材料
+struct Context {
+    // ラインセンサーが白を読んだかどうか
+    bool w_left, w_right, w_back;
+    // BNO055で取得した現在の方向
+    robo::Angle bno_dir;
+    // ボールの座標(OpenMVが見つけていなかったらNULL)
+    robo::openmv::Position *ball_pos;
+    // 黄色のゴールが見えているかどうか
+    bool y_goal_seen;
+    // 黄色のゴールの方向
+    robo::Angle y_goal_dir;
+    // ゴールから推定したフィールド上の位置(mm)が使えるかどうか
+    bool pose_valid;
+    // ゴールから推定したフィールド上の位置(mm)
+    int16_t pose_x, pose_y;
+    // 推定した位置から白線までの距離(mm)
+    int16_t margin;
+    // ラインから離れている途中かどうか(line_escapeが決める)
+    bool escaping;
+    // 推定した位置から、白線を離れる方向
+    robo::Angle escape_dir;
+    // escape_dirやline_escapeの方向を、線を踏んでいる間(escaping)に決めたかどうか
+    bool escape_dir_on_line;
+};
+
+/**
+ * @brief センサーの最新の値からContextを作る
+ * @param[out] c 作ったContext
+ * @param[in] w_left, w_right, w_back ラインセンサーが白を読んだかどうか
+ * @param[in] bno_dir BNO055で取得した現在の方向
+ * @param[in] frame OpenMVで最後に読んだフレーム(まだなければNULL)
+ * @param[in] localizer ゴールから推定した位置
+ * @param[in] now 現在時刻(ミリ秒)
+ * @details line_escapeも進める(直前に決めた動きの速度ベクトルから、どちらに進んで線を踏んだかを覚える)
+ */
+void update_context(Context &c, bool w_left, bool w_right, bool w_back, robo::Angle bno_dir,
+    const robo::openmv::Frame *frame, const robo::Localizer &localizer, uint32_t now)
+{
+    const uint8_t white = (w_left ? robo::LineEscape::left : 0)
+        | (w_right ? robo::LineEscape::right : 0)
+        | (w_back ? robo::LineEscape::back : 0);
+    c.escaping = line_escape.update(white, m_info ? m_info->velocity() : robo::V2_float(0, 0), now);
+    c.w_left = w_left;
+    c.w_right = w_right;
+    c.w_back = w_back;
+    c.bno_dir = bno_dir;
+    c.ball_pos = frame ? frame->ball_pos : NULL;
+    //　黄色のゴールの座標
+    robo::openmv::Position *y_goal_pos = frame ? frame->y_goal_pos : NULL;
+    c.y_goal_seen = y_goal_pos != NULL;
+    c.y_goal_dir = y_goal_pos ? robo::openmv::pos2angle(*y_goal_pos) : robo::Angle();
+    // 60fpsで12フレーム(0.2秒)より古い推定は使わない
+    c.pose_valid = localizer.valid(12);
+    c.pose_x = localizer.pose().x;
+    c.pose_y = localizer.pose().y;
+    c.margin = localizer.margin();
+}
+
+// 状態の番号(statesの添字)
+enum : uint8_t {
+    IDLE,   // 何もすることがないため停止
+    ESCAPE, // 線から離れる(アウトオブバウンズ対策)
+    ROTATE, // 正面を向く(姿勢制御)
+    CHASE,  // ボールを追う
+};
+
+// 条件(Contextだけを見て判断する)
+namespace guard {
+    // 線を踏んだ(離れ終わるまでtrue)
+    bool on_line(const Context &c) { return c.escaping; }
+    // 線を踏む前に、推定した位置で白線に近づいたことがわかった
+    bool near_boundary(const Context &c) { return c.pose_valid && c.margin < boundary_margin; }
+    // 線を踏んでおらず、白線からも十分離れている
+    bool safe(const Context &c) { return !on_line(c) && !(c.pose_valid && c.margin < safe_margin); }
+    // 左右どちらかわからないが、正面を向いていない
+    bool facing_away(const Context &c) { return !c.bno_dir.within(front_range); }
+    // 正面を向いた(境目で回転と移動を繰り返さないよう、facing_awayより狭くとる)
+    bool facing_front(const Context &c) { return c.bno_dir.within(front_range / 2); }
+    bool ball_seen(const Context &c) { return c.ball_pos != NULL; }
+    bool ball_lost(const Context &c) { return c.ball_pos == NULL; }
+
+    bool safe_facing_away(const Context &c) { return safe(c) && facing_away(c); }
+    bool safe_ball_seen(const Context &c) { return safe(c) && ball_seen(c); }
+    bool facing_front_ball_seen(const Context &c) { return facing_front(c) && ball_seen(c); }
+}
+
+// 線から離れる方向を決める
+void update_escape_dir(Context &c) {
+    c.escape_dir_on_line = c.escaping;
+    if (!c.escaping) {
+        // 線を踏む前 => 推定した位置からフィールドの中心に向かう
+        c.escape_dir = robo::fastmath::iatan2(-c.pose_y, -c.pose_x) - c.bno_dir;
+        return;
+    }
+    // 線を踏んだ => 基本はline_escapeが、最初に踏んだセンサーと直前の進行方向から決める
+    if (c.y_goal_seen && c.y_goal_dir.within(front_range)) {
+        // ゴールが前にある => 前にペナルティエリアがある
+        line_escape.set_direction(PI);
+        return;
+    }
+    // ペナルティエリア以外
+    //#define USE_USS
+    #ifdef USE_USS
+    #define BIND(_name_) e_ ## _name_ = uss::_name_.read()
+    uint16_t BIND(left), BIND(right), BIND(back);
+    #undef BIND
+    line_escape.set_direction((e_back < e_right && e_back < e_left)
+        ? 0.0 // 後ろの壁が一番近い => 前に進む
+        : e_left < e_right ? -HPI : HPI); // 左の方が近い ? 右に進む : 左に進む
+    #endif /* USE_USS */
+}
+
+// 各状態での動き
+namespace action {
+    void stop(Context &) {
+        m_info.reset(new robo::move_info::Stop());
+    }
+
+    void escape(Context &c) {
+        // 白線に近づいてESCAPEに入った後で線を踏んだときは、ESCAPEに入り直さない(enterが呼ばれない)ので、ここで決め直す
+        if (c.escaping != c.escape_dir_on_line) update_escape_dir(c);
+        if (c.escaping) {
+            // センサーが黒に戻っても、line_escapeが決めた時間・距離だけ同じ方向に進み続ける
+            m_info.reset(line_escape.make_info(params[param::max_speed]));
+            return;
+        }
+        m_info.reset(new robo::move_info::Translate(
+            robo::V2_float::from_polar_coord(c.escape_dir, params[param::max_speed])
+        ));
+    }
+
+    void rotate(Context &c) {
+        float adir = c.bno_dir.magnitude().to_radians();
+        // パラメーターの範囲(0..100)ではPI * 100 + 100まで届くので、int8_tにする前に0..100に収める
+        const float speed = constrain(adir * params[param::rotate_gain] + params[param::rotate_base], 0.0f, 100.0f);
+        m_info.reset(new robo::move_info::Rotate(c.bno_dir > robo::Angle(), int8_t(speed)));
+        // (adir - 0) / (PI - 0) * (100 - 20) + 20
+        // -> adir * 25 + 40
+    }
+
+    void chase(Context &c) {
+        // 最短滞在時間の間に見失ったら、直前の動きを続ける
+        if (c.ball_pos == NULL) return;
+        // ボールの方向と距離から、回り込む速度ベクトルを表で引く(表はextras/gen_orbit.pyで生成)
+        // 表は最大100で作ってあるので、max_speedの割合に縮める
+        m_info.reset(new robo::move_info::Translate(
+            robo::orbit::lookup(*c.ball_pos).to_vec() * (params[param::max_speed] / 100.0f)));
+    }
+}
+
+// 状態の表(添字は状態の番号と揃える)
+const robo::strategy::State<Context> states[] PROGMEM = {
+    /* IDLE   */ { action::stop, NULL, 0 },
+    /* ESCAPE */ { update_escape_dir, action::escape, 100 },
+    /* ROTATE */ { NULL, action::rotate, 30 },
+    /* CHASE  */ { NULL, action::chase, 30 },
+};
+
+// 遷移の表(前にあるほど優先度が高い)
+const robo::strategy::Transition<Context> transitions[] PROGMEM = {
+    // 線を踏んだら、何をしていても離れる
+    { robo::strategy::any, ESCAPE, guard::on_line, true },
+    { robo::strategy::any, ESCAPE, guard::near_boundary, true },
+    { ESCAPE, ROTATE, guard::safe_facing_away, false },
+    { ESCAPE, CHASE, guard::safe_ball_seen, false },
+    { ESCAPE, IDLE, guard::safe, false },
+    { ROTATE, CHASE, guard::facing_front_ball_seen, false },
+    { ROTATE, IDLE, guard::facing_front, false },
+    { CHASE, ROTATE, guard::facing_away, false },
+    { CHASE, IDLE, guard::ball_lost, false },
+    { IDLE, ROTATE, guard::facing_away, false },
+    { IDLE, CHASE, guard::ball_seen, false },
+};
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_OFFENSE_STRATEGY_H */
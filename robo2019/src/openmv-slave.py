@@ -5,14 +5,25 @@ OpenMV内部で動かすPythonプログラム
 import pyb, ustruct
 import sensor, image, time
 
+# I2Cのアドレス。Arduino側のrobo::profileに合わせる
+#   0x12: 全方位カメラ(robo::profile::openmv_address)
+#   0x13: 前向きのカメラ(robo::profile::openmv_front_address)
+i2c_address = 0x12
+
 # Color Tracking Thresholds
 #   (L Min, L Max, A Min, A Max, B Min, B Max)
+# 送る順に並べる。Noneのものは探さず、見つからなかったものとして送る
 thresholds = [
     (   30,    60,    40,    80,    40,    60), # orange ball
     (   10,    75,     0,    30,    25,    50), # yellow goal
-    #(   10,    25,   -15,    15,   -40,   -10)  # blue goal
+    None, #(   10,    25,   -15,    15,   -40,   -10)  # blue goal
 ]
 
+# 前回見つけたblobの周りをこれだけ広げた範囲だけを探す(ピクセル)
+track_margin = 16
+# 範囲を絞って探し続けても、このフレーム数ごとに1回は全体を探す(より大きなblobが現れたときのため)
+full_search_interval = 30
+
 # https://docs.openmv.io/library/omv.sensor.html
 sensor.reset()
 sensor.set_pixformat(sensor.RGB565)
@@ -25,14 +36,13 @@ sensor.set_auto_exposure(False, 5000)
 sensor.set_auto_whitebal(False)
 clock = time.clock()
 
+width, height = sensor.width(), sensor.height()
+full_roi = (0, 0, width, height)
+
 default_value = 0xffff
 
 # https://docs.openmv.io/library/pyb.I2C.html
-bus = pyb.I2C(2, mode=pyb.I2C.SLAVE, addr=0x12)
-
-
-def blob_code_filter(blobs, code):
-    return filter(lambda b: b.code() == code, blobs)
+bus = pyb.I2C(2, mode=pyb.I2C.SLAVE, addr=i2c_address)
 
 
 def find_biggest_blob(blobs):
@@ -51,8 +61,51 @@ def get_blob_pos(blob):
     return (blob.cx(), blob.cy())
 
 
-def blob_of_code(blobs, code):
-    return get_blob_pos(find_biggest_blob(blob_code_filter(blobs, code)))
+def track_roi(blob):
+    # blobの周りをtrack_marginだけ広げ、画像からはみ出さないようにする
+    x = max(0, blob.x() - track_margin)
+    y = max(0, blob.y() - track_margin)
+    w = min(width, blob.x() + blob.w() + track_margin) - x
+    h = min(height, blob.y() + blob.h() + track_margin) - y
+    return (x, y, w, h)
+
+
+def find_in(img, threshold, roi):
+    # https://docs.openmv.io/library/omv.image.html#class-image-image-object
+    return find_biggest_blob(img.find_blobs(
+        [threshold],
+        roi=roi,
+        pixels_threshold=5,
+        #area_threshold=5,
+    ))
+
+
+class Tracker:
+    """
+    1つのものを、前回見つけた位置の周りだけで探す
+    見失ったら同じフレームで全体を探し直し、それでもなければ次のフレームも全体を探す
+    """
+
+    def __init__(self, threshold):
+        self.threshold = threshold
+        self.roi = None
+        self.frames = 0
+
+    def find(self, img):
+        if self.threshold is None:
+            return None
+        self.frames += 1
+        blob = None
+        if self.roi is not None and self.frames < full_search_interval:
+            blob = find_in(img, self.threshold, self.roi)
+        if blob is None:
+            blob = find_in(img, self.threshold, full_roi)
+            self.frames = 0
+        self.roi = track_roi(blob) if blob else None
+        return blob
+
+
+trackers = [Tracker(threshold) for threshold in thresholds]
 
 
 def send_nums(*nums, i2c_bus=bus):
@@ -71,17 +124,11 @@ def send_nums(*nums, i2c_bus=bus):
 while True:
     clock.tick()
     img = sensor.snapshot()
-    # https://docs.openmv.io/library/omv.image.html#class-image-image-object
-    blobs = img.find_blobs(
-        thresholds,
-        pixels_threshold=5,
-        #area_threshold=5,
-    )
 
-    ba_x, ba_y = blob_of_code(blobs, 1)
-    yg_x, yg_y = blob_of_code(blobs, 2)
-    bg_x, bg_y = blob_of_code(blobs, 3)
-    send_nums(ba_x, ba_y, yg_x, yg_y, bg_x, bg_y)
-    #print(clock.fps())
+    ba_x, ba_y = get_blob_pos(trackers[0].find(img))
+    yg_x, yg_y = get_blob_pos(trackers[1].find(img))
+    bg_x, bg_y = get_blob_pos(trackers[2].find(img))
+    # 測ったフレームレート(0.1fps単位)も送り、Arduino側で読み込みの間隔や古さの判断に使う
+    fps10 = min(int(clock.fps() * 10), default_value - 1)
+    send_nums(ba_x, ba_y, yg_x, yg_y, bg_x, bg_y, fps10)
     bus.recv(1, timeout=10000)
-
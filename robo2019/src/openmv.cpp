@@ -1,6 +1,26 @@
 #include <Arduino.h>
 #include "openmv.h"
 
+size_t robo::openmv::print_positions(
+    Print & out,
+    const robo::openmv::Position * ball_pos,
+    const robo::openmv::Position * y_goal_pos,
+    const robo::openmv::Position * b_goal_pos)
+{
+    size_t n = 0;
+    #define WRITE(_name_) \
+    n += out.print(F(#_name_ " pos: ")); \
+    if (_name_ ## _pos != NULL) n += _name_ ## _pos->printTo(out); \
+    n += out.print('\n');
+
+    WRITE(ball)
+    WRITE(y_goal)
+    WRITE(b_goal)
+
+    #undef WRITE
+    return n;
+}
+
 //implementations of robo::openmv::Frame
 #define POS_ARGS(_name_) uint16_t _name_ ## _x, uint16_t _name_ ## _y
 #define INIT_POS(_name_) _name_ ## _pos(new Position(_name_ ## _x, _name_ ## _y))
@@ -25,25 +45,14 @@ robo::openmv::Frame::~Frame()
     #undef DELETE
 }
 
-uint8_t robo::openmv::Frame::to_string(char * dst)
+size_t robo::openmv::Frame::printTo(Print & out) const
 {
-    if (dst == NULL) return 0;
-    char *ptr = dst;
-    #define WRITE(_name_) \
-    ptr += sprintf_P(ptr, PSTR(#_name_ " pos: ")); \
-    if (_name_ ## _pos != NULL) ptr += _name_ ## _pos->to_string(ptr); \
-    *(ptr++) = '\n';
-
-    WRITE(ball)
-    WRITE(y_goal)
-    WRITE(b_goal)
-
-    #undef WRITE
-    *ptr = '\0';
-    return ptr - dst;
+    return robo::openmv::print_positions(out, ball_pos, y_goal_pos, b_goal_pos);
 }
 
 //implementations of robo::openmv::Reader
+constexpr uint8_t robo::openmv::Reader::frame_size;
+
 robo::openmv::Reader::Reader(uint8_t addr, TwoWire & wire) : _wire(wire), address(addr) {}
 
 void robo::openmv::Reader::pass_data(uint8_t size)
@@ -51,45 +60,252 @@ void robo::openmv::Reader::pass_data(uint8_t size)
     for (uint8_t i = 0; i < size; i++) _wire.read();
 }
 
-uint16_t robo::openmv::Reader::read_2byte()
-{
-    return _wire.read() | (_wire.read() << 8);
-}
-
-robo::openmv::Position * robo::openmv::Reader::read_pos()
+robo::openmv::Position * robo::openmv::Reader::decode_pos(const uint8_t * data)
 {
     constexpr uint16_t default_value = 0xffff;
-    uint16_t x = read_2byte();
-    uint16_t y = read_2byte();
+    uint16_t x = data[0] | (data[1] << 8);
+    uint16_t y = data[2] | (data[3] << 8);
     if (x == default_value && y == default_value) return NULL;
     return new robo::openmv::Position(x, y);
 }
 
+robo::openmv::Frame * robo::openmv::Reader::decode_frame(const uint8_t (&data)[frame_size])
+{
+    robo::openmv::Position
+        *ball_pos = decode_pos(data),
+        *y_goal_pos = decode_pos(data + 4),
+        *b_goal_pos = decode_pos(data + 8);
+    if (ball_pos == NULL && y_goal_pos == NULL && b_goal_pos == NULL) return NULL;
+    return new robo::openmv::Frame(ball_pos, y_goal_pos, b_goal_pos);
+}
+
 void robo::openmv::Reader::setup()
 {
     _wire.begin();
 }
 
-robo::openmv::Frame * robo::openmv::Reader::read_frame()
+robo::InitStatus robo::openmv::Reader::init_step(uint32_t now)
+{
+    if (!_init_started) {
+        setup();
+        _init_started = true;
+        _init_wait = now;
+    }
+    if (int32_t(now - _init_wait) < 0) return robo::init_pending;
+    uint8_t data[frame_size];
+    if (read_data(data)) return robo::init_ready;
+    _init_wait = now + 20;
+    return robo::init_pending;
+}
+
+bool robo::openmv::Reader::decode_pos(const uint8_t * data, robo::openmv::Position & dst)
 {
-    constexpr uint8_t req_size = 3 * 4;
-    uint8_t res_size = _wire.requestFrom(address, req_size);
-    robo::openmv::Frame *frame = NULL;
-    robo::openmv::Position *ball_pos, *y_goal_pos, *b_goal_pos;
-    if (res_size != req_size) {
+    constexpr uint16_t default_value = 0xffff;
+    dst.x = data[0] | (data[1] << 8);
+    dst.y = data[2] | (data[3] << 8);
+    return dst.x != default_value || dst.y != default_value;
+}
+
+bool robo::openmv::Reader::decode_frame(const uint8_t (&data)[frame_size], robo::openmv::FrameData & dst)
+{
+    dst.has_ball = decode_pos(data, dst.ball);
+    dst.has_y_goal = decode_pos(data + 4, dst.y_goal);
+    dst.has_b_goal = decode_pos(data + 8, dst.b_goal);
+    return !dst.empty();
+}
+
+bool robo::openmv::Reader::read_data(uint8_t (&data)[frame_size])
+{
+    uint8_t res_size = _wire.requestFrom(address, frame_size);
+    bool ok = res_size == frame_size;
+    if (ok) {
+        for (uint8_t &d : data) d = _wire.read();
+        _fps10 = data[12] | (data[13] << 8);
+    } else {
         pass_data(res_size);
-        goto FINAL;
     }
-    ball_pos = read_pos();
-    y_goal_pos = read_pos();
-    b_goal_pos = read_pos();
-    if (ball_pos == NULL && y_goal_pos == NULL && b_goal_pos == NULL) goto FINAL;
-    frame = new robo::openmv::Frame(ball_pos, y_goal_pos, b_goal_pos);
-    // goto FINAL;
-    FINAL:
     _wire.beginTransmission(address);
     _wire.write(1);
     _wire.endTransmission();
-    return frame;
+    return ok;
+}
+
+robo::openmv::Frame * robo::openmv::Reader::read_frame()
+{
+    uint8_t data[frame_size];
+    if (!read_data(data)) return NULL;
+    return decode_frame(data);
+}
+
+bool robo::openmv::Reader::read_frame(robo::openmv::FrameData & dst)
+{
+    uint8_t data[frame_size];
+    if (!read_data(data)) {
+        dst = FrameData();
+        return false;
+    }
+    return decode_frame(data, dst);
+}
+
+bool robo::openmv::Reader::receive_frame(robo::openmv::FrameData & dst)
+{
+    uint8_t data[frame_size];
+    if (!read_data(data)) return false;
+    decode_frame(data, dst);
+    return true;
+}
+
+//implementations of robo::openmv::Calibration
+robo::Angle robo::openmv::Calibration::direction(const robo::openmv::Position & pos) const
+{
+    const int16_t dx = int16_t(center.x - pos.x);
+    if (per_pixel == robo::Angle()) {
+        return mount + robo::fastmath::iatan2(dx, int16_t(pos.y - center.y));
+    }
+    return mount + per_pixel * dx;
+}
+
+//implementations of robo::openmv::Camera
+uint16_t robo::openmv::Camera::age(uint32_t now) const
+{
+    if (!has_frame) return 0xffff;
+    const uint32_t elapsed = now - last_frame;
+    return elapsed > 0xffff ? 0xffff : uint16_t(elapsed);
+}
+
+uint8_t robo::openmv::Camera::confidence(uint32_t now) const
+{
+    const uint16_t a = age(now);
+    const uint16_t max_age = calibration.max_age;
+    if (a >= max_age) return 0;
+    // 読み込んだばかりならcalibration.confidence、max_ageで0になるよう直線的に下げる
+    return uint8_t(uint32_t(calibration.confidence) * (max_age - a) / max_age);
+}
+
+uint16_t robo::openmv::Camera::period() const
+{
+    const uint16_t fps10 = reader.fps10();
+    // 1fps未満は測り始めの値なので使わない
+    if (fps10 < 10) return calibration.period;
+    return uint16_t(10000 / fps10);
+}
+
+//implementations of robo::openmv::Sighting
+size_t robo::openmv::Sighting::printTo(Print & out) const
+{
+    if (!seen) return out.print('-');
+    size_t n = out.print(dir.to_degrees());
+    n += out.print(F("deg cam"));
+    n += out.print(source);
+    n += out.print(F(" conf:"));
+    n += out.print(confidence);
+    n += out.print(F(" age:"));
+    n += out.print(age);
+    return n;
+}
+
+//implementations of robo::openmv::Observation
+size_t robo::openmv::Observation::printTo(Print & out) const
+{
+    size_t n = 0;
+    #define WRITE(_name_) \
+    n += out.print(F(#_name_ ": ")); \
+    n += _name_.printTo(out); \
+    n += out.print('\n');
+
+    WRITE(ball)
+    WRITE(y_goal)
+    WRITE(b_goal)
+
+    #undef WRITE
+    return n;
+}
+
+//implementations of robo::openmv::MultiReader
+namespace {
+    // 見えているカメラのうち、確からしさが最も高いものに置き換える
+    void choose(robo::openmv::Sighting & dst, const robo::openmv::Camera & camera, uint8_t index,
+        const robo::openmv::Position * pos, uint8_t confidence, uint16_t age)
+    {
+        if (pos == NULL || confidence == 0) return;
+        if (dst.seen && dst.confidence >= confidence) return;
+        dst.seen = true;
+        dst.source = index;
+        dst.confidence = confidence;
+        dst.age = age;
+        dst.pos = *pos;
+        dst.dir = camera.calibration.direction(*pos);
+    }
+}
+
+void robo::openmv::MultiReader::setup()
+{
+    for (uint8_t i = 0; i < _count; i++) _cameras[i].reader.setup();
 }
 
+bool robo::openmv::MultiReader::poll(uint32_t now)
+{
+    // 読み込む時刻を最も過ぎているカメラを選ぶ
+    Camera *selected = NULL;
+    uint32_t most_late = 0;
+    uint8_t due = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        Camera &camera = _cameras[i];
+        const int32_t late = int32_t(now - camera.last_poll) - camera.period();
+        if (late < 0) continue;
+        due++;
+        if (selected == NULL || uint32_t(late) > most_late) {
+            selected = &camera;
+            most_late = late;
+        }
+    }
+    if (selected == NULL) return false;
+
+    Camera &camera = *selected;
+    camera.last_poll = now;
+    if (camera.reader.receive_frame(camera.frame)) {
+        camera.has_frame = true;
+        camera.last_frame = now;
+        if (camera.frames != 0xffff) camera.frames++;
+    } else {
+        // 前のフレームは残し、古くなるにつれて確からしさを下げる
+        if (camera.misses != 0xffff) camera.misses++;
+    }
+    return due > 1;
+}
+
+bool robo::openmv::MultiReader::fuse(robo::openmv::Observation & dst, uint32_t now) const
+{
+    dst = robo::openmv::Observation();
+    for (uint8_t i = 0; i < _count; i++) {
+        const Camera &camera = _cameras[i];
+        const uint8_t confidence = camera.confidence(now);
+        if (confidence == 0) continue;
+        const uint16_t age = camera.age(now);
+        choose(dst.ball, camera, i, camera.frame.ball_pos(), confidence, age);
+        choose(dst.y_goal, camera, i, camera.frame.y_goal_pos(), confidence, age);
+        choose(dst.b_goal, camera, i, camera.frame.b_goal_pos(), confidence, age);
+    }
+    return dst.ball.seen || dst.y_goal.seen || dst.b_goal.seen;
+}
+
+void robo::openmv::MultiReader::print_stats(Print & out, uint32_t now) const
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        const Camera &camera = _cameras[i];
+        out.print(F("cam"));
+        out.print(i);
+        out.print(F(" 0x"));
+        out.print(camera.reader.address, HEX);
+        out.print(F(" frames:"));
+        out.print(camera.frames);
+        out.print(F(" misses:"));
+        out.print(camera.misses);
+        out.print(F(" fps:"));
+        out.print(camera.reader.fps10() / 10);
+        out.print('.');
+        out.print(camera.reader.fps10() % 10);
+        out.print(F(" age:"));
+        out.println(camera.age(now));
+    }
+}
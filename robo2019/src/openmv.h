@@ -9,6 +9,10 @@
 
 #include <Wire.h>
 
+#include "angle.h"
+#include "boot.h"
+#include "fastmath.h"
+#include "util.h"
 #include "vec2d.h"
 
 /**
@@ -22,13 +26,25 @@ namespace openmv {
     /** @brief ボールのカメラ視点の座標を表すエイリアス */
     using Position = robo::Vector2D<uint16_t>;
 
-    //! カメラの座標系で中心の位置
-    const Position center{90, 70};
+    //! カメラの座標系で中心の位置(コンパイル時の定数)
+    constexpr Position center{90, 70};
+
+    /**
+     * @brief 見つかったものの座標を1行ずつ出力する
+     * @param[out] out 出力先
+     * @param[in] ball_pos ボールの座標(なければNULL)
+     * @param[in] y_goal_pos 黄色のゴールの座標(なければNULL)
+     * @param[in] b_goal_pos 青色のゴールの座標(なければNULL)
+     * @return size_t 出力した文字数
+     * @details "ball pos: (x, y)\n" "y_goal pos: (x, y)\n" "b_goal pos: (x, y)\n"。なければ座標は空
+     */
+    size_t print_positions(
+        Print &out, const Position *ball_pos, const Position *y_goal_pos, const Position *b_goal_pos);
 
     /**
      * @brief カメラが読み取った情報を表現するクラス
      */
-    class Frame {
+    class Frame final : public Printable {
     public:
         /**
          * @brief ボールの座標
@@ -78,22 +94,88 @@ namespace openmv {
          */
         ~Frame();
 
+        /**
+         * @brief Frameの文字列表現を出力する
+         * @param[out] out 出力先
+         * @return size_t 出力した文字数
+         * @details バッファを介さずにoutに直接書き込む。形式はprint_positions()を参照
+         */
+        size_t printTo(Print &out) const override;
+
         /**
          * @brief Frameの文字列表現を取得
          * @param[out] dst 文字列を書き込む先
-         * @return uint8_t 書き込んだ文字数
-         * @note バッファオーバーランを起こす可能性があるので注意。容量は最大で70文字程度食う。
+         * @param[in] size dstの容量('\0'を含む)
+         * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
          */
-        uint8_t to_string(char *dst);
+        size_t to_string(char *dst, size_t size) const { return robo::print_to_buffer(dst, size, *this); }
+
+        /**
+         * @brief Frameの文字列表現を取得
+         * @param[out] dst 文字列を書き込む先
+         * @return size_t 書き込もうとした文字数。N以上なら切り詰めている
+         */
+        template<size_t N>
+        size_t to_string(char (&dst)[N]) const { return to_string(dst, N); }
+    };
+
+    /**
+     * @brief 座標を値で持つフレーム
+     * @details Frameと違ってヒープを使わないので、毎周期読み直しても断片化しない
+     */
+    class FrameData {
+    public:
+        //! ボールの座標
+        Position ball;
+        //! 黄色のゴールの座標
+        Position y_goal;
+        //! 青色のゴールの座標
+        Position b_goal;
+        //! ボールが見つかったかどうか
+        bool has_ball;
+        //! 黄色のゴールが見つかったかどうか
+        bool has_y_goal;
+        //! 青色のゴールが見つかったかどうか
+        bool has_b_goal;
+
+        /** @brief 何も見つかっていない状態で初期化 */
+        FrameData() : has_ball(false), has_y_goal(false), has_b_goal(false) {}
+
+        //! ボールの座標(見つかっていなければNULL)
+        const Position *ball_pos() const { return has_ball ? &ball : NULL; }
+        //! 黄色のゴールの座標(見つかっていなければNULL)
+        const Position *y_goal_pos() const { return has_y_goal ? &y_goal : NULL; }
+        //! 青色のゴールの座標(見つかっていなければNULL)
+        const Position *b_goal_pos() const { return has_b_goal ? &b_goal : NULL; }
+        //! 何も見つかっていないかどうか
+        bool empty() const { return !has_ball && !has_y_goal && !has_b_goal; }
+
+        /**
+         * @brief 文字列表現を出力する
+         * @param[out] out 出力先
+         * @return size_t 出力した文字数
+         * @details 形式はFrameと同じ。Printに渡すときは`robo::printable(data)`を使う
+         */
+        size_t printTo(Print &out) const { return print_positions(out, ball_pos(), y_goal_pos(), b_goal_pos()); }
     };
 
     /**
      * @brief OpenMVが送る情報をI2C通信で読み取るクラス
      */
     class Reader {
+    public: // static variables
+        //! 1フレームのデータサイズ(バイト)。x, yが2バイトずつの座標3つ分と、2バイトのフレームレート
+        static constexpr uint8_t frame_size = 3 * 4 + 2;
+
     private: // variables
         //! 通信で使うI2Cバス
         TwoWire &_wire;
+        //! init_step()でI2Cをセットアップしたかどうか
+        bool _init_started = false;
+        //! init_step()で次にフレームを要求する時刻(ミリ秒)
+        uint32_t _init_wait = 0;
+        //! 最後に受け取ったフレームレート(0.1fps単位)
+        uint16_t _fps10 = 0;
 
     public:
         //! OpenMVのI2Cアドレス
@@ -115,18 +197,27 @@ namespace openmv {
         void pass_data(uint8_t size);
 
         /**
-         * @brief 2バイト読んで1つの値にする
-         * @return uint16_t 読んだ値
-         * @details 先に読み込んだ1バイトが下8ビット、次に読み込んだ1バイトが上8ビットになる
+         * @brief 座標のデータ1つを解読する
+         * @param[in] data 4バイトのデータ。x, yの順に2バイトずつ、下位バイトが先
+         * @return Position* 解読したデータのポインタ
+         * @details オブジェクトが見つからなかった場合に送られるデータだった場合、NULLを返す
          */
-        uint16_t read_2byte();
+        static Position* decode_pos(const uint8_t *data);
 
         /**
-         * @brief 座標のデータ1つを読み込む
-         * @return Position* 読み込んだデータのポインタ
-         * @details オブジェクトが見つからなかった場合に送られるデータをOpenMVから受け取った場合、NULLを返す
+         * @brief 座標のデータ1つを解読する
+         * @param[in] data 4バイトのデータ。x, yの順に2バイトずつ、下位バイトが先
+         * @param[out] dst 解読した座標
+         * @return bool オブジェクトが見つかっていたらtrue
          */
-        Position* read_pos();
+        static bool decode_pos(const uint8_t *data, Position &dst);
+
+        /**
+         * @brief 1フレーム分のデータを受け取り、次のフレームを要求する
+         * @param[out] data 受け取ったデータ
+         * @return bool 受け取れたらtrue
+         */
+        bool read_data(uint8_t (&data)[frame_size]);
 
     public:
         /**
@@ -134,21 +225,294 @@ namespace openmv {
          */
         void setup();
 
+        /**
+         * @brief OpenMVが測ったフレームレート
+         * @return uint16_t 最後に受け取ったフレームのフレームレート(0.1fps単位)。受け取っていなければ0
+         * @details 何も見つからなかったフレームでも更新する
+         */
+        uint16_t fps10() const { return _fps10; }
+
+        /**
+         * @brief OpenMVが起動して、フレームを送ってくるまで待つ処理を1歩進める
+         * @param[in] now 現在時刻(ミリ秒)
+         * @return InitStatus 起動処理の状態
+         * @details
+         *  OpenMVはスクリプトが動き出すまで応答しないので、20msごとにフレームを要求し、
+         *  1フレーム受け取れたらinit_readyを返す。robo::Bootから繰り返し呼ぶ。
+         */
+        robo::InitStatus init_step(uint32_t now);
+
+        /**
+         * @brief OpenMVから受け取ったデータをFrameに解読する
+         * @param[in] data 受け取ったデータ
+         * @return Frame* 解読したFrameのポインタ
+         * @note オブジェクトが一つもなかった場合はNULL
+         */
+        static Frame* decode_frame(const uint8_t (&data)[frame_size]);
+
+        /**
+         * @brief OpenMVから受け取ったデータをFrameDataに解読する
+         * @param[in] data 受け取ったデータ
+         * @param[out] dst 解読したフレーム
+         * @return bool オブジェクトが1つでもあればtrue
+         */
+        static bool decode_frame(const uint8_t (&data)[frame_size], FrameData &dst);
+
         /**
          * @brief Frameを読み込む
          * @return Frame* 読み込んだFrameのポインタ
          * @note 読み込みに失敗した、またはオブジェクトが一つもなかった場合はNULL
          */
         Frame* read_frame();
+
+        /**
+         * @brief ヒープを使わずにフレームを読み込む
+         * @param[out] dst 読み込んだフレーム。読み込みに失敗した場合は何も見つかっていない状態になる
+         * @return bool 読み込めて、オブジェクトが1つでもあればtrue
+         */
+        bool read_frame(FrameData &dst);
+
+        /**
+         * @brief ヒープを使わずにフレームを読み込む
+         * @param[out] dst 読み込んだフレーム。読み込みに失敗した場合は書き換えない
+         * @return bool 読み込めたらtrue(オブジェクトが1つもなくても)
+         * @note read_frame()と違い、読み込みに失敗したのか何も見えていないのかを区別できる
+         */
+        bool receive_frame(FrameData &dst);
+    };
+
+    /**
+     * @brief カメラ1台の、画像上の座標から機体から見た方向への変換と、読み込み方の設定
+     * @details
+     *  全方位カメラ(per_pixelが0)は、画像上の機体の中心から見た方向を求める。
+     *  前向きのカメラは、光軸から横にずれたピクセル数に比例する角度とする。
+     *  どちらも最後にカメラの向き(mount)を足して、機体の正面を0とする方向にする。
+     */
+    struct Calibration {
+        //! 全方位カメラでは画像上の機体の中心、前向きのカメラでは光軸の位置
+        Position center;
+        //! 機体の正面から見たカメラの向き
+        robo::Angle mount;
+        //! 前向きのカメラで、横に1ピクセルずれたときの角度。0なら全方位カメラ
+        robo::Angle per_pixel;
+        //! 読み込んだばかりのフレームの確からしさ(1..255)
+        uint8_t confidence;
+        //! フレームの周期(ミリ秒)。OpenMVからフレームレートを受け取るまでは、この間隔で読み込む
+        uint16_t period;
+        //! これより古いフレームは使わない(ミリ秒)
+        uint16_t max_age;
+
+        /**
+         * @brief 画像上の座標から、機体から見た方向を求める
+         * @param[in] pos 画像上の座標
+         * @return Angle 方向(pos2angleと同じ向き)
+         */
+        robo::Angle direction(const Position &pos) const;
+    };
+
+    /**
+     * @brief MultiReaderで読み込むカメラ1台
+     */
+    class Camera {
+    public:
+        //! 読み込みに使うReader
+        Reader reader;
+        //! 座標の変換と読み込み方の設定
+        const Calibration &calibration;
+        //! 最後に読み込めたフレーム
+        FrameData frame;
+        //! 1度でもフレームを読み込めたかどうか
+        bool has_frame = false;
+        //! 最後に読み込みを試みた時刻(ミリ秒)
+        uint32_t last_poll = 0;
+        //! 最後にフレームを読み込めた時刻(ミリ秒)
+        uint32_t last_frame = 0;
+        //! 読み込めたフレームの数
+        uint16_t frames = 0;
+        //! 読み込みに失敗した回数
+        uint16_t misses = 0;
+
+        /**
+         * @brief Construct a new Camera object
+         * @param[in] addr OpenMVのアドレス
+         * @param[in] calibration 座標の変換と読み込み方の設定
+         * @param[in] wire 通信で使うI2Cバス
+         */
+        Camera(uint8_t addr, const Calibration &calibration, TwoWire &wire = Wire)
+            : reader(addr, wire), calibration(calibration) {}
+
+        /**
+         * @brief 最後にフレームを読み込んでからの時間
+         * @param[in] now 現在時刻(ミリ秒)
+         * @return uint16_t 経過時間(ミリ秒)。読み込んだことがなければ0xffff
+         */
+        uint16_t age(uint32_t now) const;
+
+        /**
+         * @brief 今のフレームの確からしさ
+         * @param[in] now 現在時刻(ミリ秒)
+         * @return uint8_t 確からしさ。古くなるほど下がり、max_ageで0になる
+         */
+        uint8_t confidence(uint32_t now) const;
+
+        /**
+         * @brief 読み込む間隔
+         * @return uint16_t OpenMVが測ったフレームレートから求めた周期(ミリ秒)。受け取っていなければCalibration::period
+         */
+        uint16_t period() const;
+    };
+
+    /**
+     * @brief 複数のカメラから選んだ、1つのものの見え方
+     */
+    struct Sighting {
+        //! 見えているかどうか
+        bool seen;
+        //! 見つけたカメラの番号
+        uint8_t source;
+        //! 見つけたカメラのフレームの確からしさ
+        uint8_t confidence;
+        //! 見つけたカメラのフレームの古さ(ミリ秒)
+        uint16_t age;
+        //! 機体から見た方向
+        robo::Angle dir;
+        //! 見つけたカメラの画像上の座標
+        Position pos;
+
+        /** @brief 見えていない状態で初期化 */
+        Sighting() : seen(false), source(0), confidence(0), age(0xffff), dir(), pos() {}
+
+        /**
+         * @brief 文字列表現を出力する
+         * @param[out] out 出力先
+         * @return size_t 出力した文字数
+         * @details "<方向(度)>deg cam<番号> conf:<確からしさ> age:<ms>"。見えていなければ"-"
+         */
+        size_t printTo(Print &out) const;
+    };
+
+    /**
+     * @brief 複数のカメラを合わせた観測
+     */
+    class Observation final : public Printable {
+    public:
+        //! ボール
+        Sighting ball;
+        //! 黄色のゴール
+        Sighting y_goal;
+        //! 青色のゴール
+        Sighting b_goal;
+
+        /**
+         * @brief 文字列表現を出力する
+         * @param[out] out 出力先
+         * @return size_t 出力した文字数
+         * @details "ball: ...\n" "y_goal: ...\n" "b_goal: ...\n"。形式はSighting::printTo()を参照
+         */
+        size_t printTo(Print &out) const override;
+    };
+
+    /**
+     * @brief アドレスの違う複数のOpenMVを読み込み、1つの観測にまとめるクラス
+     * @details
+     *  poll()を呼ぶたびに、読み込む時刻を最も過ぎているカメラを1台だけ読み込む。
+     *  各カメラは自分の周期(OpenMVが測ったフレームレートから求める)で読み込むので、交互に読むのと違って片方の周期が倍になることはない。
+     *  1回に読むのは1台なので、robo::I2CBusの1回分の通信にそのまま使える。
+     *
+     *  fuse()は、ボールとゴールそれぞれについて、見えているカメラのうち今の確からしさが最も高いものを選ぶ。
+     *  確からしさはCalibration::confidenceから、フレームが古くなるほど下げたもの。
+     *  方向はカメラごとのCalibrationで機体から見た方向に直してあるので、どのカメラを選んでも同じように使える。
+     * @note
+     *  ```C++
+     *  const omv::Calibration omni_cal = { omv::center, robo::Angle(), robo::Angle(), 160, 16, 100 };
+     *  const omv::Calibration front_cal = { {80, 60}, robo::Angle(), robo::Angle::from_degrees(1) / 2, 240, 33, 100 };
+     *  omv::Camera cameras[] = {
+     *      omv::Camera(0x12, omni_cal),
+     *      omv::Camera(0x13, front_cal),
+     *  };
+     *  omv::MultiReader cams(cameras);
+     *  omv::Observation obs;
+     *  void loop() {
+     *      cams.poll(millis());
+     *      cams.fuse(obs, millis());
+     *  }
+     *  ```
+     */
+    class MultiReader {
+    private:
+        Camera *const _cameras;
+        const uint8_t _count;
+
+    public:
+        /**
+         * @brief Construct a new MultiReader object
+         * @param[in] cameras カメラの配列
+         * @param[in] count カメラの台数
+         */
+        MultiReader(Camera *cameras, uint8_t count) : _cameras(cameras), _count(count) {}
+        /**
+         * @brief Construct a new MultiReader object
+         * @param[in] cameras カメラの配列
+         */
+        template<uint8_t N>
+        MultiReader(Camera (&cameras)[N]) : MultiReader(cameras, N) {}
+
+        /** @brief I2Cをセットアップする */
+        void setup();
+
+        /**
+         * @brief 読み込む時刻を最も過ぎているカメラを1台だけ読み込む
+         * @param[in] now 現在時刻(ミリ秒)
+         * @return bool まだ読み込む時刻を過ぎたカメラが残っていればtrue
+         * @note どのカメラも読み込む時刻になっていなければ、何もしない
+         */
+        bool poll(uint32_t now);
+
+        /**
+         * @brief 各カメラの最新のフレームを1つの観測にまとめる
+         * @param[out] dst まとめた観測
+         * @param[in] now 現在時刻(ミリ秒)
+         * @return bool 何か1つでも見えていればtrue
+         */
+        bool fuse(Observation &dst, uint32_t now) const;
+
+        /**
+         * @brief カメラを取得する
+         * @param[in] index カメラの番号
+         */
+        Camera &operator[](uint8_t index) { return _cameras[index]; }
+        const Camera &operator[](uint8_t index) const { return _cameras[index]; }
+
+        //! カメラの台数
+        uint8_t size() const { return _count; }
+
+        /**
+         * @brief 各カメラの統計を出力する
+         * @param[out] out 出力先
+         * @param[in] now 現在時刻(ミリ秒)
+         * @details 1台1行で "cam<番号> 0x<アドレス> frames:<数> misses:<数> fps:<fps> age:<ms>"
+         */
+        void print_stats(Print &out, uint32_t now) const;
     };
 
     constexpr float pos2dir(const Position & pos)
     {
         return atan2(
-            -float(pos.x) + 90, // = -(pos.x - 90)
-            float(pos.y) - 70
+            -float(pos.x) + center.x, // = -(pos.x - center.x)
+            float(pos.y) - center.y
         );
     }
+
+    /**
+     * @brief 画像上の座標から、機体から見た方向を求める
+     * @param[in] pos 画像上の座標
+     * @return Angle 方向(pos2dirと同じ向き)
+     * @details 浮動小数点数を使わず、robo::fastmath::iatan2で求める
+     */
+    inline robo::Angle pos2angle(const Position & pos)
+    {
+        return robo::fastmath::iatan2(int16_t(center.x - pos.x), int16_t(pos.y - center.y));
+    }
 } // namespace openmv
 
 } // namespace robo
@@ -0,0 +1,56 @@
+#include <Arduino.h>
+#include "orbit.h"
+#include "orbit_table.h"
+
+static_assert(robo::orbit::table::sectors % 4 == 0, "sectors must be a multiple of 4");
+
+uint8_t robo::orbit::bearing_sector(int16_t forward, int16_t left)
+{
+    // 第1象限(前から左へ90度)に回してから、象限の中の位置をtanの境目と比べる
+    int16_t x, y;
+    uint8_t quadrant;
+    if (forward > 0 && left >= 0) {
+        x = forward; y = left; quadrant = 0;
+    } else if (forward <= 0 && left > 0) {
+        x = left; y = -forward; quadrant = 1;
+    } else if (forward < 0 && left <= 0) {
+        x = -forward; y = -left; quadrant = 2;
+    } else {
+        x = -left; y = forward; quadrant = 3;
+    }
+    constexpr uint8_t per_quadrant = table::sectors / 4;
+    // y / x >= tan(境目) <=> y * 256 >= x * (tan(境目) * 256)
+    const int32_t y256 = int32_t(y) << 8;
+    uint8_t sub = 0;
+    while (sub < per_quadrant - 1
+        && y256 >= int32_t(x) * pgm_read_word(&table::tan_thresholds[sub])) {
+        sub++;
+    }
+    return quadrant * per_quadrant + sub;
+}
+
+uint8_t robo::orbit::distance_ring(int16_t forward, int16_t left)
+{
+    const uint32_t dist_sq = int32_t(forward) * forward + int32_t(left) * left;
+    uint8_t ring = 0;
+    while (ring < table::rings - 1
+        && dist_sq >= pgm_read_word(&table::ring_limits_sq[ring])) {
+        ring++;
+    }
+    return ring;
+}
+
+robo::orbit::Cell robo::orbit::lookup(int16_t forward, int16_t left)
+{
+    const int8_t *cell = table::field[bearing_sector(forward, left)][distance_ring(forward, left)];
+    return Cell{ int8_t(pgm_read_byte(&cell[0])), int8_t(pgm_read_byte(&cell[1])) };
+}
+
+robo::orbit::Cell robo::orbit::lookup(const robo::openmv::Position &ball_pos)
+{
+    // openmv::pos2dirと同じ向き: 画像のyが前、xの負の向きが左
+    return lookup(
+        int16_t(ball_pos.y) - int16_t(robo::openmv::center.y),
+        int16_t(robo::openmv::center.x) - int16_t(ball_pos.x)
+    );
+}
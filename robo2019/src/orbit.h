@@ -0,0 +1,88 @@
+/**
+ * @file orbit.h
+ * @brief ボールへの回り込みの動きを、表を引いて決める機能
+ */
+
+#pragma once
+
+#ifndef ROBO2019_ORBIT_H
+#define ROBO2019_ORBIT_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+#include "openmv.h"
+#include "vec2d.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @brief ボールへの回り込み
+ * @details
+ *  ボールの方向と距離で区切ったセルごとに、進む速度ベクトルを表(orbit_table.h)にしておき、
+ *  atan2/sin/cosを使わずに整数の比較だけで引く。
+ *  表はextras/gen_orbit.pyで生成する。回り込みの半径や減速を始める距離などを変えたときは、
+ *  スクリプトを実行し直すこと。
+ *  座標は機体から見た相対座標で、前を正とするforwardと、左を正とするleftで表す(単位はカメラのピクセル)。
+ */
+namespace orbit {
+    /** @brief 表から引いた速度ベクトル */
+    struct Cell {
+        //! 前方向の速さ
+        int8_t forward;
+        //! 左方向の速さ
+        int8_t left;
+
+        /**
+         * @brief モーターに渡す形に変換する
+         * @return robo::V2_float 速度ベクトル
+         */
+        robo::V2_float to_vec() const { return robo::V2_float(forward, left); }
+    };
+
+    /**
+     * @brief ボールがどの方向のセルにあるかを求める
+     * @param[in] forward ボールの前方向の位置
+     * @param[in] left ボールの左方向の位置
+     * @return uint8_t 前から左回りに数えたセルの番号
+     */
+    uint8_t bearing_sector(int16_t forward, int16_t left);
+
+    /**
+     * @brief ボールがどの距離のセルにあるかを求める
+     * @param[in] forward ボールの前方向の位置
+     * @param[in] left ボールの左方向の位置
+     * @return uint8_t 近い方から数えたセルの番号
+     */
+    uint8_t distance_ring(int16_t forward, int16_t left);
+
+    /**
+     * @brief ボールの位置から、進む速度ベクトルを引く
+     * @param[in] forward ボールの前方向の位置
+     * @param[in] left ボールの左方向の位置
+     * @return Cell 速度ベクトル
+     */
+    Cell lookup(int16_t forward, int16_t left);
+
+    /**
+     * @brief カメラの座標で表したボールの位置から、進む速度ベクトルを引く
+     * @param[in] ball_pos OpenMVで取得したボールの座標
+     * @return Cell 速度ベクトル
+     */
+    Cell lookup(const robo::openmv::Position &ball_pos);
+} // namespace orbit
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_ORBIT_H */
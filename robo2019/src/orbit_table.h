@@ -0,0 +1,70 @@
+/**
+ * @file orbit_table.h
+ * @brief orbit.hで使うベクトル場の表
+ * @note extras/gen_orbit.pyで生成したファイル。直接書き換えないこと
+ * @details
+ *  python3 extras/gen_orbit.py --sectors 32 --rings 10 16 22 30 40 52 66 --orbit-radius 20 --escape-angle 30 --capture-cone 15 --slow-radius 30 --max-speed 100 --min-speed 50 --capture-speed 60
+ */
+
+#pragma once
+
+#ifndef ROBO2019_ORBIT_TABLE_H
+#define ROBO2019_ORBIT_TABLE_H
+
+#include <avr/pgmspace.h>
+
+namespace robo {
+
+namespace orbit {
+
+namespace table {
+    //! 方向の分割数(4の倍数)
+    constexpr uint8_t sectors = 32;
+    //! 距離の分割数
+    constexpr uint8_t rings = 8;
+    //! 象限の中での方向の境目(tanを256倍したもの)
+    const uint16_t tan_thresholds[] PROGMEM = { 51, 106, 171, 256, 383, 618, 1287 };
+    //! 距離の境目(ピクセル数の2乗)
+    const uint16_t ring_limits_sq[] PROGMEM = { 100, 256, 484, 900, 1600, 2704, 4356 };
+    //! 速度ベクトル[方向][距離] = {前, 左}
+    const int8_t field[sectors][rings][2] PROGMEM = {
+        /*   0.0 */ { {  58,   6}, {  60,   6}, {  60,   6}, {  60,   6}, { 100,  10}, { 100,  10}, { 100,  10}, { 100,  10} },
+        /*  11.2 */ { {  54,  22}, {  58,  22}, {  58,  22}, {  58,  20}, {  95,  32}, {  95,  31}, {  95,  30}, {  95,  30} },
+        /*  22.5 */ { { -42,  41}, { -40,  59}, { -35,  74}, {  22,  91}, {  48,  88}, {  60,  80}, {  68,  73}, {  73,  69} },
+        /*  33.8 */ { { -51,  27}, { -55,  46}, { -53,  62}, {   1,  93}, {  27,  96}, {  42,  91}, {  51,  86}, {  57,  82} },
+        /*  45.0 */ { { -56,  17}, { -63,  35}, { -64,  50}, { -18,  92}, {   8, 100}, {  24,  97}, {  33,  94}, {  40,  92} },
+        /*  56.2 */ { { -58,   6}, { -68,  22}, { -73,  37}, { -35,  86}, { -12,  99}, {   4, 100}, {  14,  99}, {  21,  98} },
+        /*  67.5 */ { { -58,  -6}, { -71,   8}, { -79,  22}, { -51,  78}, { -31,  95}, { -15,  99}, {  -5, 100}, {   2, 100} },
+        /*  78.8 */ { { -56, -17}, { -71,  -6}, { -81,   6}, { -66,  66}, { -49,  87}, { -34,  94}, { -25,  97}, { -18,  98} },
+        /*  90.0 */ { { -51, -27}, { -69, -20}, { -81, -10}, { -77,  52}, { -65,  76}, { -52,  85}, { -43,  90}, { -37,  93} },
+        /* 101.2 */ { { -45, -37}, { -64, -33}, { -78, -26}, { -86,  36}, { -79,  62}, { -68,  74}, { -60,  80}, { -54,  84} },
+        /* 112.5 */ { { -37, -45}, { -56, -45}, { -71, -40}, { -91,  19}, { -89,  45}, { -81,  59}, { -74,  67}, { -69,  72} },
+        /* 123.8 */ { { -27, -51}, { -46, -55}, { -62, -53}, { -93,   1}, { -96,  27}, { -91,  42}, { -86,  51}, { -82,  57} },
+        /* 135.0 */ { { -17, -56}, { -35, -63}, { -50, -64}, { -92, -18}, {-100,   8}, { -97,  24}, { -94,  33}, { -92,  40} },
+        /* 146.2 */ { {  -6, -58}, { -22, -68}, { -37, -73}, { -86, -35}, { -99, -12}, {-100,   4}, { -99,  14}, { -98,  21} },
+        /* 157.5 */ { {   6, -58}, {  -8, -71}, { -22, -79}, { -78, -51}, { -95, -31}, { -99, -15}, {-100,  -5}, {-100,   2} },
+        /* 168.8 */ { {  17, -56}, {   6, -71}, {  -6, -81}, { -66, -66}, { -87, -49}, { -94, -34}, { -97, -25}, { -98, -18} },
+        /* 180.0 */ { {  17,  56}, {   6,  71}, {  -6,  81}, { -66,  66}, { -87,  49}, { -94,  34}, { -97,  25}, { -98,  18} },
+        /* 191.2 */ { {   6,  58}, {  -8,  71}, { -22,  79}, { -78,  51}, { -95,  31}, { -99,  15}, {-100,   5}, {-100,  -2} },
+        /* 202.5 */ { {  -6,  58}, { -22,  68}, { -37,  73}, { -86,  35}, { -99,  12}, {-100,  -4}, { -99, -14}, { -98, -21} },
+        /* 213.8 */ { { -17,  56}, { -35,  63}, { -50,  64}, { -92,  18}, {-100,  -8}, { -97, -24}, { -94, -33}, { -92, -40} },
+        /* 225.0 */ { { -27,  51}, { -46,  55}, { -62,  53}, { -93,  -1}, { -96, -27}, { -91, -42}, { -86, -51}, { -82, -57} },
+        /* 236.2 */ { { -37,  45}, { -56,  45}, { -71,  40}, { -91, -19}, { -89, -45}, { -81, -59}, { -74, -67}, { -69, -72} },
+        /* 247.5 */ { { -45,  37}, { -64,  33}, { -78,  26}, { -86, -36}, { -79, -62}, { -68, -74}, { -60, -80}, { -54, -84} },
+        /* 258.8 */ { { -51,  27}, { -69,  20}, { -81,  10}, { -77, -52}, { -65, -76}, { -52, -85}, { -43, -90}, { -37, -93} },
+        /* 270.0 */ { { -56,  17}, { -71,   6}, { -81,  -6}, { -66, -66}, { -49, -87}, { -34, -94}, { -25, -97}, { -18, -98} },
+        /* 281.2 */ { { -58,   6}, { -71,  -8}, { -79, -22}, { -51, -78}, { -31, -95}, { -15, -99}, {  -5,-100}, {   2,-100} },
+        /* 292.5 */ { { -58,  -6}, { -68, -22}, { -73, -37}, { -35, -86}, { -12, -99}, {   4,-100}, {  14, -99}, {  21, -98} },
+        /* 303.8 */ { { -56, -17}, { -63, -35}, { -64, -50}, { -18, -92}, {   8,-100}, {  24, -97}, {  33, -94}, {  40, -92} },
+        /* 315.0 */ { { -51, -27}, { -55, -46}, { -53, -62}, {   1, -93}, {  27, -96}, {  42, -91}, {  51, -86}, {  57, -82} },
+        /* 326.2 */ { { -42, -41}, { -40, -59}, { -35, -74}, {  22, -91}, {  48, -88}, {  60, -80}, {  68, -73}, {  73, -69} },
+        /* 337.5 */ { {  54, -22}, {  58, -22}, {  58, -22}, {  58, -20}, {  95, -32}, {  95, -31}, {  95, -30}, {  95, -30} },
+        /* 348.8 */ { {  58,  -6}, {  60,  -6}, {  60,  -6}, {  60,  -6}, { 100, -10}, { 100, -10}, { 100, -10}, { 100, -10} },
+    };
+} // namespace table
+
+} // namespace orbit
+
+} // namespace robo
+
+#endif /* ROBO2019_ORBIT_TABLE_H */
@@ -0,0 +1,253 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "params.h"
+#include "util.h"
+
+namespace {
+    // EEPROMに保存する形式: 識別子(2) パラメーターの数(1) 定義のCRC(1) 値(2 * 数) ここまでのCRC(1)
+    constexpr uint16_t params_magic = ('P' << 8) | 'R';
+    constexpr uint8_t header_size = 4;
+
+    const __FlashStringHelper *flash(const char *str)
+    {
+        return reinterpret_cast<const __FlashStringHelper *>(str);
+    }
+
+    void print_error(Print &out, const __FlashStringHelper *reason)
+    {
+        out.print(F("err "));
+        out.println(reason);
+    }
+
+    // 空白で区切った次の語を取り出す(区切りを'\0'に書き換える)。なければNULL
+    char *next_token(char *&ptr)
+    {
+        while (*ptr == ' ' || *ptr == '\t') ptr++;
+        if (*ptr == '\0') return NULL;
+        char *token = ptr;
+        while (*ptr != '\0' && *ptr != ' ' && *ptr != '\t') ptr++;
+        if (*ptr != '\0') *(ptr++) = '\0';
+        return token;
+    }
+
+    // 10進数の整数を読む。数でない文字が混ざっていたり、int16_tに収まらなかったりしたらfalse
+    bool parse_int16(const char *str, int16_t &dst)
+    {
+        char *end;
+        const long value = strtol(str, &end, 10);
+        if (end == str || *end != '\0' || value < INT16_MIN || value > INT16_MAX) return false;
+        dst = int16_t(value);
+        return true;
+    }
+}
+
+//implementations of robo::ParamRegistry
+constexpr uint8_t robo::ParamRegistry::not_found;
+
+robo::ParamDef robo::ParamRegistry::def(uint8_t id) const
+{
+    robo::ParamDef d;
+    memcpy_P(&d, &_defs[id], sizeof(d));
+    return d;
+}
+
+bool robo::ParamRegistry::set(uint8_t id, int16_t value)
+{
+    if (id >= _count) return false;
+    const robo::ParamDef d = def(id);
+    if (value < d.lower || d.upper < value) return false;
+    _values[id] = value;
+    return true;
+}
+
+void robo::ParamRegistry::reset()
+{
+    for (uint8_t id = 0; id < _count; id++) {
+        _values[id] = int16_t(pgm_read_word(&_defs[id].default_value));
+    }
+}
+
+uint8_t robo::ParamRegistry::find(const char *name) const
+{
+    for (uint8_t id = 0; id < _count; id++) {
+        const char *def_name = reinterpret_cast<const char *>(pgm_read_ptr(&_defs[id].name));
+        if (strcmp_P(name, def_name) == 0) return id;
+    }
+    return not_found;
+}
+
+size_t robo::ParamRegistry::print(Print &out, uint8_t id) const
+{
+    size_t n = out.print(flash(def(id).name));
+    n += out.print('=');
+    n += out.print(_values[id]);
+    return n;
+}
+
+void robo::ParamRegistry::print_all(Print &out) const
+{
+    for (uint8_t id = 0; id < _count; id++) {
+        const robo::ParamDef d = def(id);
+        print(out, id);
+        out.print(F(" ["));
+        out.print(d.lower);
+        out.print(F(".."));
+        out.print(d.upper);
+        out.println(']');
+    }
+}
+
+uint8_t robo::ParamRegistry::layout_crc() const
+{
+    uint8_t crc = 0xff;
+    for (uint8_t id = 0; id < _count; id++) {
+        const robo::ParamDef d = def(id);
+        for (const char *p = d.name; pgm_read_byte(p) != '\0'; p++) {
+            crc = robo::crc8_update(crc, pgm_read_byte(p));
+        }
+        crc = robo::crc8_update(crc, uint16_t(d.lower) & 0xff);
+        crc = robo::crc8_update(crc, uint16_t(d.lower) >> 8);
+        crc = robo::crc8_update(crc, uint16_t(d.upper) & 0xff);
+        crc = robo::crc8_update(crc, uint16_t(d.upper) >> 8);
+    }
+    return crc;
+}
+
+void robo::ParamRegistry::save(uint16_t address) const
+{
+    uint8_t crc = 0xff;
+    uint16_t a = address;
+    #define PUT(_byte_) do { const uint8_t b = (_byte_); EEPROM.update(a++, b); crc = robo::crc8_update(crc, b); } while (0)
+    PUT(params_magic & 0xff);
+    PUT(params_magic >> 8);
+    PUT(_count);
+    PUT(layout_crc());
+    for (uint8_t id = 0; id < _count; id++) {
+        PUT(uint16_t(_values[id]) & 0xff);
+        PUT(uint16_t(_values[id]) >> 8);
+    }
+    #undef PUT
+    EEPROM.update(a, crc);
+}
+
+bool robo::ParamRegistry::load(uint16_t address)
+{
+    if (EEPROM.read(address) != (params_magic & 0xff)
+        || EEPROM.read(address + 1) != (params_magic >> 8)
+        || EEPROM.read(address + 2) != _count
+        || EEPROM.read(address + 3) != layout_crc()) {
+        return false;
+    }
+    // 値を書き換える前に、全体のCRCを確かめる
+    const uint16_t crc_address = address + storage_size() - 1;
+    uint8_t crc = 0xff;
+    for (uint16_t a = address; a < crc_address; a++) crc = robo::crc8_update(crc, EEPROM.read(a));
+    if (crc != EEPROM.read(crc_address)) return false;
+
+    for (uint8_t id = 0; id < _count; id++) {
+        const uint16_t a = address + header_size + 2 * id;
+        const int16_t value = int16_t(EEPROM.read(a) | (uint16_t(EEPROM.read(a + 1)) << 8));
+        // 定義のCRCが合っていれば範囲内のはずだが、念のため範囲外なら既定値にする
+        if (!set(id, value)) _values[id] = def(id).default_value;
+    }
+    return true;
+}
+
+//implementations of robo::ParamConsole
+constexpr uint8_t robo::ParamConsole::line_size;
+constexpr uint16_t robo::ParamConsole::no_eeprom;
+
+bool robo::ParamConsole::poll(Stream &io)
+{
+    bool changed = false;
+    while (io.available() > 0) {
+        const char c = char(io.read());
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (_length + 1 < line_size) {
+                _line[_length++] = c;
+            } else {
+                _overflow = true;
+            }
+            continue;
+        }
+        _line[_length] = '\0';
+        if (_overflow) {
+            print_error(io, F("too long"));
+        } else if (execute(_line, io)) {
+            changed = true;
+        }
+        _length = 0;
+        _overflow = false;
+    }
+    return changed;
+}
+
+bool robo::ParamConsole::execute(char *line, Print &out)
+{
+    char *ptr = line;
+    const char *command = next_token(ptr);
+    if (command == NULL) return false;
+
+    if (strcmp_P(command, PSTR("list")) == 0) {
+        _params.print_all(out);
+        return false;
+    }
+    if (strcmp_P(command, PSTR("reset")) == 0) {
+        _params.reset();
+        out.println(F("ok"));
+        return true;
+    }
+    if (strcmp_P(command, PSTR("save")) == 0) {
+        if (_address == no_eeprom) {
+            print_error(out, F("no eeprom"));
+            return false;
+        }
+        _params.save(_address);
+        out.println(F("ok"));
+        return false;
+    }
+    if (strcmp_P(command, PSTR("load")) == 0) {
+        if (_address == no_eeprom) {
+            print_error(out, F("no eeprom"));
+            return false;
+        }
+        if (!_params.load(_address)) {
+            print_error(out, F("no saved values"));
+            return false;
+        }
+        out.println(F("ok"));
+        return true;
+    }
+
+    const bool is_set = strcmp_P(command, PSTR("set")) == 0;
+    if (!is_set && strcmp_P(command, PSTR("get")) != 0) {
+        print_error(out, F("unknown command"));
+        return false;
+    }
+    const char *name = next_token(ptr);
+    const uint8_t id = name == NULL ? robo::ParamRegistry::not_found : _params.find(name);
+    if (id == robo::ParamRegistry::not_found) {
+        print_error(out, F("unknown param"));
+        return false;
+    }
+    if (is_set) {
+        const char *text = next_token(ptr);
+        int16_t value;
+        if (text == NULL || !parse_int16(text, value)) {
+            print_error(out, F("bad value"));
+            return false;
+        }
+        if (!_params.set(id, value)) {
+            const robo::ParamDef d = _params.def(id);
+            out.print(F("err range "));
+            out.print(d.lower);
+            out.print(F(".."));
+            out.println(d.upper);
+            return false;
+        }
+    }
+    _params.print(out, id);
+    out.println();
+    return is_set;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file params.h
+ * @brief 実行中に調整できるパラメーターと、シリアルで読み書きするコンソールのクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_PARAMS_H
+#define ROBO2019_PARAMS_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <Stream.h>
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @brief パラメーター1つの定義
+ * @details 名前と範囲は変わらないので、表ごとPROGMEMに置く
+ */
+struct ParamDef {
+    //! 名前(PROGMEMの文字列。空白を含まないこと)
+    const char *name;
+    //! 既定値
+    int16_t default_value;
+    //! 最小値
+    int16_t lower;
+    //! 最大値
+    int16_t upper;
+};
+
+/**
+ * @class ParamRegistry
+ * @brief パラメーターの表の、大きさによらない部分
+ * @details
+ *  定義(robo::ParamDef)はPROGMEMの表から、値はSRAMの配列から読む。
+ *  名前で探す、範囲を確かめて書き換える、EEPROMに保存する、といった遅くてよい処理はここにまとめる。
+ *  制御の中で値を読むときはrobo::Params::operator[]を使う。
+ */
+class ParamRegistry
+{
+public:
+    //! find()で見つからなかったときの値
+    static constexpr uint8_t not_found = 0xff;
+
+private:
+    //! 定義の表(PROGMEM)
+    const ParamDef *const _defs;
+    //! 値(SRAM)
+    int16_t *const _values;
+    const uint8_t _count;
+
+    //! 定義の名前と範囲のCRC。表を変えたら、EEPROMに保存した値を使わないようにするため
+    uint8_t layout_crc() const;
+
+protected:
+    /**
+     * @brief Construct a new ParamRegistry object
+     * @param[in] defs 定義の表(PROGMEM)
+     * @param[in] values 値を入れる配列(count個)
+     * @param[in] count パラメーターの数
+     */
+    ParamRegistry(const ParamDef *defs, int16_t *values, uint8_t count)
+        : _defs(defs), _values(values), _count(count) {}
+
+public:
+    /**
+     * @brief 定義を読む
+     * @param[in] id パラメーターの番号
+     * @return ParamDef 定義(nameはPROGMEMを指したまま)
+     */
+    ParamDef def(uint8_t id) const;
+
+    //! パラメーターの数
+    uint8_t size() const { return _count; }
+
+    /**
+     * @brief 値を読む
+     * @param[in] id パラメーターの番号
+     */
+    int16_t get(uint8_t id) const { return _values[id]; }
+
+    /**
+     * @brief 値を書き換える
+     * @param[in] id パラメーターの番号
+     * @param[in] value 値
+     * @return bool 範囲内で書き換えたらtrue。番号か値が範囲外なら書き換えずにfalse
+     */
+    bool set(uint8_t id, int16_t value);
+
+    /** @brief すべての値を既定値に戻す */
+    void reset();
+
+    /**
+     * @brief 名前でパラメーターを探す
+     * @param[in] name 名前(SRAMの文字列)
+     * @return uint8_t パラメーターの番号。見つからなければnot_found
+     */
+    uint8_t find(const char *name) const;
+
+    /**
+     * @brief "名前=値"の形で出力する
+     * @param[out] out 出力先
+     * @param[in] id パラメーターの番号
+     * @return size_t 出力した文字数
+     */
+    size_t print(Print &out, uint8_t id) const;
+
+    /**
+     * @brief すべてのパラメーターを1行ずつ出力する
+     * @param[out] out 出力先
+     * @details 1行は"名前=値 [最小値..最大値]"
+     */
+    void print_all(Print &out) const;
+
+    //! EEPROMに保存するときのバイト数
+    uint16_t storage_size() const { return 5 + 2 * uint16_t(_count); }
+
+    /**
+     * @brief 値をEEPROMに保存する
+     * @param[in] address EEPROMのアドレス
+     * @note 値が変わったバイトだけを書き込む(EEPROM.update())
+     */
+    void save(uint16_t address) const;
+
+    /**
+     * @brief EEPROMに保存した値を読み込む
+     * @param[in] address EEPROMのアドレス
+     * @return bool 読み込めたらtrue
+     * @details 識別子、パラメーターの数、定義のCRC、値のCRCのどれかが合わなければ、値を変えずにfalseを返す
+     */
+    bool load(uint16_t address);
+};
+
+/**
+ * @class Params
+ * @brief 実行中に調整できるパラメーターの表
+ * @tparam N パラメーターの数
+ * @details
+ *  値を持つ配列をこのクラスの中に置くので、グローバル変数にすれば`params[id]`は1回のメモリの読み込みで済む。
+ *  シリアルから読み書きするにはrobo::ParamConsoleを使う。
+ * @note
+ *  ```C++
+ *  namespace param {
+ *      enum : uint8_t { max_speed, line_white, count };
+ *      const char max_speed_name[] PROGMEM = "max_speed";
+ *      const char line_white_name[] PROGMEM = "line_white";
+ *      constexpr robo::ParamDef defs[] PROGMEM = {
+ *          { max_speed_name, 100, 0, 100 },
+ *          { line_white_name, 450, 0, 1023 },
+ *      };
+ *  }
+ *  robo::Params<param::count> params(param::defs);
+ *  int8_t speed = params[param::max_speed];
+ *  ```
+ */
+template<uint8_t N>
+class Params : public ParamRegistry
+{
+private:
+    int16_t _storage[N];
+
+public:
+    /**
+     * @brief Construct a new Params object
+     * @param[in] defs 定義の表(PROGMEM)。値は既定値で初期化する
+     */
+    Params(const ParamDef (&defs)[N]) : ParamRegistry(defs, _storage, N) { reset(); }
+
+    /**
+     * @brief 値を読む
+     * @param[in] id パラメーターの番号
+     */
+    int16_t operator[](uint8_t id) const { return _storage[id]; }
+};
+
+/**
+ * @class ParamConsole
+ * @brief シリアルから1行ずつコマンドを受け取り、パラメーターを読み書きする
+ * @details
+ *  受け取った文字は決まった大きさの配列にため、改行で実行する。ヒープは使わない。
+ *  コマンド:
+ *  - `list` すべてのパラメーターを出力する
+ *  - `get <名前>` 値を出力する
+ *  - `set <名前> <値>` 値を書き換える
+ *  - `save` EEPROMに保存する
+ *  - `load` EEPROMから読み込む
+ *  - `reset` 既定値に戻す
+ *
+ *  get/setは"名前=値"を、save/load/resetは"ok"を返す。失敗したときは"err <理由>"を返す。
+ */
+class ParamConsole
+{
+public:
+    //! 1行の長さの上限('\0'を含む)
+    static constexpr uint8_t line_size = 32;
+    //! EEPROMを使わないときのアドレス
+    static constexpr uint16_t no_eeprom = 0xffff;
+
+private:
+    ParamRegistry &_params;
+    const uint16_t _address;
+    char _line[line_size];
+    uint8_t _length;
+    //! 行が長すぎたので、改行まで捨てているところかどうか
+    bool _overflow;
+
+public:
+    /**
+     * @brief Construct a new ParamConsole object
+     * @param[in] params 読み書きするパラメーター
+     * @param[in] address EEPROMのアドレス(no_eepromならsave/loadを受け付けない)
+     */
+    ParamConsole(ParamRegistry &params, uint16_t address = no_eeprom)
+        : _params(params), _address(address), _length(0), _overflow(false) {}
+
+    /**
+     * @brief 受け取った文字を読み、行が揃ったら実行する
+     * @param[in,out] io 読み書きするシリアル
+     * @return bool 値が変わったらtrue(値から求めたものを作り直すときに使う)
+     * @details 受け取っている文字だけを読むので、待たずに戻る
+     */
+    bool poll(Stream &io);
+
+    /**
+     * @brief 1行を実行する
+     * @param[in,out] line コマンド(区切りを'\0'に書き換える)
+     * @param[out] out 応答の出力先
+     * @return bool 値が変わったらtrue
+     */
+    bool execute(char *line, Print &out);
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_PARAMS_H */
@@ -0,0 +1,185 @@
+/**
+ * @file pin.h
+ * @brief ピン番号をテンプレート引数にとる、入出力用のクラス定義
+ */
+
+#pragma once
+
+#ifndef ROBO2019_PIN_H
+#define ROBO2019_PIN_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+// ATmega328P(Arduino Uno)ではピン番号からレジスタをコンパイル時に決め、
+// digitalWrite()などのテーブル参照を省いてsbi/cbi/sbis命令1つにする。
+// それ以外のマイコンではArduinoの関数にそのまま任せる。
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+#define ROBO2019_DIRECT_PORT 1
+#else
+#define ROBO2019_DIRECT_PORT 0
+#endif
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @brief デジタルピン
+ * @tparam number Arduinoのピン番号
+ * @details
+ *  ATmega328Pでのピン番号とレジスタの対応:
+ *  - 0-7: PORTD
+ *  - 8-13: PORTB
+ *  - 14-19(A0-A5): PORTC
+ * @note digitalWrite()と違い、PWM出力の停止は行わない。analogWrite()したピンには使わないこと。
+ */
+template<uint8_t number>
+class DigitalPin
+{
+public:
+    //! Arduinoのピン番号
+    static constexpr uint8_t pin = number;
+
+#if ROBO2019_DIRECT_PORT
+    static_assert(number < 20, "ATmega328P has only 20 digital pins");
+
+    //! レジスタ内でのビット位置
+    static constexpr uint8_t bit_pos = number < 8 ? number : number < 14 ? number - 8 : number - 14;
+    //! レジスタ内でのマスク
+    static constexpr uint8_t mask = 1 << bit_pos;
+
+    //! 出力レジスタ(PORTx)
+    static volatile uint8_t &port() { return number < 8 ? PORTD : number < 14 ? PORTB : PORTC; }
+    //! 入力レジスタ(PINx)
+    static volatile uint8_t &in() { return number < 8 ? PIND : number < 14 ? PINB : PINC; }
+    //! 方向レジスタ(DDRx)
+    static volatile uint8_t &ddr() { return number < 8 ? DDRD : number < 14 ? DDRB : DDRC; }
+
+    /**
+     * @brief ピンのモードを設定する
+     * @param[in] mode INPUT, OUTPUT, INPUT_PULLUPのいずれか
+     */
+    static void set_mode(uint8_t mode)
+    {
+        if (mode == OUTPUT) {
+            ddr() |= mask;
+        } else {
+            ddr() &= ~mask;
+            if (mode == INPUT_PULLUP) port() |= mask;
+            else port() &= ~mask;
+        }
+    }
+
+    /** @brief HIGHを出力する */
+    static void high() { port() |= mask; }
+    /** @brief LOWを出力する */
+    static void low() { port() &= ~mask; }
+    /** @brief 出力を反転する(PINxに1を書くとPORTxが反転する) */
+    static void toggle() { in() = mask; }
+    /**
+     * @brief 入力を読む
+     * @return HIGHならtrue
+     */
+    static bool read() { return in() & mask; }
+#else /* ROBO2019_DIRECT_PORT */
+    static void set_mode(uint8_t mode) { pinMode(number, mode); }
+    static void high() { digitalWrite(number, HIGH); }
+    static void low() { digitalWrite(number, LOW); }
+    static void toggle() { digitalWrite(number, !digitalRead(number)); }
+    static bool read() { return digitalRead(number) == HIGH; }
+#endif /* ROBO2019_DIRECT_PORT */
+
+    /**
+     * @brief 値を出力する
+     * @param[in] value trueならHIGH
+     */
+    static void write(bool value)
+    {
+        if (value) high();
+        else low();
+    }
+
+    /**
+     * @brief パルスの長さを測る
+     * @param[in] state 測るパルスのレベル(HIGH/LOW)
+     * @param[in] timeout タイムアウト(マイクロ秒)
+     * @return パルスの長さ(マイクロ秒)。タイムアウトした場合は0
+     */
+    static unsigned long pulse_in(uint8_t state, unsigned long timeout)
+    {
+        return pulseIn(number, state, timeout);
+    }
+};
+
+/**
+ * @brief アナログ入力ピン
+ * @tparam channel アナログピンの番号(A0なら0)
+ * @details
+ *  ADCのレジスタを直接操作する。変換には約104us(13 ADCクロック)かかるので、
+ *  start()で変換を始めて他の処理をし、ready()を確認してからresult()で読むこともできる。
+ * @note analogReference()の設定は使わず、常にAVCCを基準にする
+ */
+template<uint8_t channel>
+class AnalogPin
+{
+public:
+    //! アナログピンの番号
+    static constexpr uint8_t pin = channel;
+
+#if ROBO2019_DIRECT_PORT
+    static_assert(channel < 8, "ATmega328P has only 8 analog channels");
+
+    /** @brief 入力に設定する(A0-A5の場合のみ) */
+    static void setup()
+    {
+        if (channel < 6) DigitalPin<14 + (channel < 6 ? channel : 0)>::set_mode(INPUT);
+    }
+
+    /** @brief AD変換を開始する */
+    static void start()
+    {
+        ADMUX = _BV(REFS0) | channel;
+        ADCSRA |= _BV(ADSC);
+    }
+
+    /**
+     * @brief AD変換が終わったかどうか
+     * @return 終わっていればtrue
+     */
+    static bool ready() { return !bit_is_set(ADCSRA, ADSC); }
+
+    /**
+     * @brief AD変換の結果を読む
+     * @return 0-1023
+     */
+    static uint16_t result() { return ADC; }
+
+    /**
+     * @brief AD変換を行い、終わるまで待って結果を返す
+     * @return 0-1023
+     */
+    static uint16_t read()
+    {
+        start();
+        while (!ready()) {}
+        return result();
+    }
+#else /* ROBO2019_DIRECT_PORT */
+    static void setup() { pinMode(analogInputToDigitalPin(channel), INPUT); }
+    static uint16_t read() { return analogRead(channel); }
+#endif /* ROBO2019_DIRECT_PORT */
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_PIN_H */
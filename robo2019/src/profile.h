@@ -0,0 +1,99 @@
+/**
+ * @file profile.h
+ * @brief 機体の配線表
+ * @details READMEの「各モジュールとメインボードとの接続」の表をそのまま定数にしたもの。
+ *  配線を変えたときはここだけを書き換える。
+ */
+
+#pragma once
+
+#ifndef ROBO2019_PROFILE_H
+#define ROBO2019_PROFILE_H
+
+#ifdef ARDUINO
+
+#include "line_sensor.h"
+#include "pin.h"
+#include "uss.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/** @brief 機体の配線表 */
+namespace profile {
+    //! OpenMVのI2Cアドレス
+    constexpr uint8_t openmv_address = 0x12;
+    //! 前向きのOpenMVのI2Cアドレス(robo::openmv::MultiReaderで全方位カメラと合わせて読む)
+    constexpr uint8_t openmv_front_address = 0x13;
+    //! BNO055のI2Cアドレス
+    constexpr uint8_t bno055_address = 0x28;
+    //! LCDのI2Cアドレス
+    constexpr uint8_t lcd_address = 0x27;
+    //! LCDの列数
+    constexpr uint8_t lcd_cols = 16;
+    //! LCDの行数
+    constexpr uint8_t lcd_rows = 2;
+
+    /**
+     * @brief 超音波センサー HC-SR04 (Echo, Trig)
+     * @note
+     *  HC-SR04 1のEchoはD1で、SerialのTXと同じピン。Serialを使っている間はUARTがピンを使うので読めない。
+     *  offense.inoではSerialを使うため、USE_USSを定義していない(超音波センサーを読まない)。
+     */
+    namespace uss {
+        //! HC-SR04 1
+        using Left = robo::USSensor<1, 2>;
+        //! HC-SR04 2
+        using Right = robo::USSensor<3, 4>;
+        //! HC-SR04 3
+        using Back = robo::USSensor<5, 6>;
+    }
+
+    /** @brief ラインセンサー (アナログピン) */
+    namespace lines {
+        //! offense機のline_whiteの既定値(センサーの値がこれ以上なら白)
+        constexpr int16_t offense_line_white = 450;
+        //! defence機のline_whiteの既定値(センサーの値がこれより大きければ白)
+        constexpr int16_t defence_line_white = 550;
+        //! Line Sensor 1
+        using Left = robo::LineSensor<1>;
+        //! Line Sensor 2
+        using Right = robo::LineSensor<2>;
+        //! Line Sensor 3
+        using Back = robo::LineSensor<3>;
+    }
+
+    /** @brief Motor Control Board (SoftwareSerial) */
+    namespace motor {
+        //! SoftwareSerialのRXピン
+        constexpr uint8_t rx_pin = 12;
+        //! SoftwareSerialのTXピン
+        constexpr uint8_t tx_pin = 13;
+        //! 通信速度
+        constexpr long baud = 19200;
+    }
+
+    //! キッカーのピン
+    using Kicker = robo::DigitalPin<10>;
+
+    /** @brief EEPROMの使い方(先頭のアドレス) */
+    namespace eeprom {
+        //! BNO055の較正値(robo::BNO055::save_calibration())
+        constexpr uint16_t bno055_calibration = 0;
+        //! 調整用のパラメーター(robo::ParamRegistry::save())。BNO055の較正値は26バイト
+        constexpr uint16_t params = 32;
+    }
+} // namespace profile
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_PROFILE_H */
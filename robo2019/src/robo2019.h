@@ -10,13 +10,31 @@
 
 #ifdef ARDUINO
 
+#include "angle.h"
 #include "bno055.h"
+#include "boot.h"
+#include "fastmath.h"
+#include "fixed.h"
+#include "goalie.h"
+#include "i2c_bus.h"
+#include "intercept.h"
 #include "interrupt.h"
+#include "kicker.h"
 #include "lcd.h"
+#include "line_escape.h"
 #include "line_sensor.h"
+#include "localization.h"
+#include "maneuver.h"
+#include "memory.h"
 #include "motor.h"
 #include "move_info.h"
 #include "openmv.h"
+#include "orbit.h"
+#include "params.h"
+#include "pin.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "strategy.h"
 #include "uss.h"
 #include "util.h"
 #include "vec2d.h"
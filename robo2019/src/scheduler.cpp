@@ -0,0 +1,79 @@
+#include <Arduino.h>
+#include "scheduler.h"
+
+void robo::Scheduler::setup()
+{
+    const uint32_t now = micros();
+    for (uint8_t i = 0; i < _count; i++) {
+        Task &task = _tasks[i];
+        task.release = now;
+        task.last_start = now;
+    }
+}
+
+bool robo::Scheduler::run()
+{
+    const uint32_t now = micros();
+    for (uint8_t i = 0; i < _count; i++) {
+        Task &task = _tasks[i];
+        uint32_t late = 0;
+        if (task.period == 0) {
+            if (!task.notified) continue;
+            task.notified = false;
+        } else {
+            late = now - task.release;
+            // 予定時刻より前(差が負)ならまだ動かない
+            if (int32_t(late) < 0) continue;
+            if (late >= task.period) {
+                // 周期を飛ばした分は実行せず、位相だけ合わせる
+                ++task.overruns;
+                task.release += (late / task.period) * task.period;
+            }
+            task.release += task.period;
+        }
+
+        if (late > task.max_lateness) task.max_lateness = late > 0xffff ? 0xffff : late;
+        task.dt = now - task.last_start;
+        task.last_start = now;
+        task.callback(task.dt);
+        uint32_t exec = micros() - now;
+        task.exec_time = exec > 0xffff ? 0xffff : exec;
+        if (task.exec_time > task.max_exec_time) task.max_exec_time = task.exec_time;
+        return true;
+    }
+    return false;
+}
+
+void robo::Scheduler::notify(uint8_t index)
+{
+    if (index < _count) _tasks[index].notified = true;
+}
+
+void robo::Scheduler::reset_stats()
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        Task &task = _tasks[i];
+        task.max_exec_time = 0;
+        task.max_lateness = 0;
+        task.overruns = 0;
+    }
+}
+
+void robo::Scheduler::print_stats(Print &out) const
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        const Task &task = _tasks[i];
+        out.print(F("task"));
+        out.print(i);
+        out.print(F(" dt:"));
+        out.print(task.dt);
+        out.print(F(" exec:"));
+        out.print(task.exec_time);
+        out.print('/');
+        out.print(task.max_exec_time);
+        out.print(F(" late:"));
+        out.print(task.max_lateness);
+        out.print(F(" overruns:"));
+        out.println(task.overruns);
+    }
+}
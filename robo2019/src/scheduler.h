@@ -0,0 +1,159 @@
+/**
+ * @file scheduler.h
+ * @brief 周期タスクのスケジューラ
+ */
+
+#pragma once
+
+#ifndef ROBO2019_SCHEDULER_H
+#define ROBO2019_SCHEDULER_H
+
+#ifdef ARDUINO
+
+#include <Print.h>
+
+#include "util.h"
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @class Task
+ * @brief スケジューラで動かすタスク
+ * @details 実行時間などの統計もここに記録される
+ */
+class Task
+{
+public:
+    /**
+     * @brief タスクの処理
+     * @param dt 前回このタスクが始まってからの時間(マイクロ秒)
+     */
+    using Callback = void (*)(uint32_t dt);
+
+    //! タスクの処理
+    const Callback callback;
+    //! 周期(マイクロ秒)。0ならnotify()されたときだけ動く
+    const uint32_t period;
+
+    //! 次に動くべき時刻(micros())
+    uint32_t release = 0;
+    //! 前回動き始めた時刻(micros())
+    uint32_t last_start = 0;
+    //! 前回のdt(マイクロ秒)
+    uint32_t dt = 0;
+    //! 前回の実行時間(マイクロ秒)
+    uint16_t exec_time = 0;
+    //! 実行時間の最大値(マイクロ秒)
+    uint16_t max_exec_time = 0;
+    //! 動くべき時刻から実際に動き始めるまでの遅れの最大値(マイクロ秒)
+    uint16_t max_lateness = 0;
+    //! 遅れすぎて周期を1回以上飛ばした回数
+    uint16_t overruns = 0;
+    //! notify()された
+    volatile bool notified = false;
+
+    /**
+     * @brief Construct a new Task object
+     * @param[in] callback タスクの処理
+     * @param[in] hz 1秒あたりの実行回数。0ならnotify()されたときだけ動く
+     */
+    Task(Callback callback, uint16_t hz)
+        : callback(callback), period(hz == 0 ? 0 : 1000000UL / hz) {}
+};
+
+/**
+ * @class Scheduler
+ * @brief 周期の違う複数のタスクを、決まった周期で動かす協調型のスケジューラ
+ * @details
+ *  Timer0(micros())を時間の基準に、各タスクを決まった時刻に動かす。
+ *  次に動く時刻は前回の予定時刻に周期を足して決めるので、実行の遅れが積み重ならない。
+ *  同時に動くべきタスクがある場合は、配列で前にあるものが優先される。
+ *  タスクの途中で割り込むことはしないので、あるタスクの反応の遅れは
+ *  「周期 + 遅れの最大値(max_lateness) + 実行時間」で上から抑えられる。
+ * @note
+ *  ```C++
+ *  robo::Task tasks[] = {
+ *      robo::Task(read_heading, 100),
+ *      robo::Task(read_lines, 200),
+ *      robo::Task(read_camera, 0), // データが来たらnotify()
+ *      robo::Task(update_lcd, 20),
+ *  };
+ *  robo::Scheduler scheduler(tasks);
+ *  void setup() { scheduler.setup(); }
+ *  void loop() { scheduler.run(); }
+ *  ```
+ */
+class Scheduler
+{
+private:
+    Task *const _tasks;
+    const uint8_t _count;
+
+public:
+    /**
+     * @brief Construct a new Scheduler object
+     * @param[in] tasks タスクの配列。前にあるほど優先度が高い
+     * @param[in] count タスクの数
+     */
+    Scheduler(Task *tasks, uint8_t count) : _tasks(tasks), _count(count) {}
+    /**
+     * @brief Construct a new Scheduler object
+     * @param[in] tasks タスクの配列。前にあるほど優先度が高い
+     */
+    template<uint8_t N>
+    Scheduler(Task (&tasks)[N]) : Scheduler(tasks, N) {}
+
+    /**
+     * @brief 各タスクの最初の実行時刻を今に設定する
+     * @note 全体のsetupの最後で呼ぶ
+     */
+    void setup();
+
+    /**
+     * @brief 動くべきタスクのうち、最も優先度の高いものを1つ動かす
+     * @return タスクを動かしたらtrue
+     * @note loop()の中で呼び続ける
+     */
+    bool run();
+
+    /**
+     * @brief 周期0のタスクに、動くべきことを知らせる
+     * @param[in] index タスクの番号
+     * @note 割り込みハンドラからも呼べる
+     */
+    void notify(uint8_t index);
+
+    /**
+     * @brief タスクを取得する
+     * @param[in] index タスクの番号
+     * @return タスク
+     */
+    const Task &operator[](uint8_t index) const { return _tasks[index]; }
+
+    //! タスクの数
+    uint8_t size() const { return _count; }
+
+    /** @brief 各タスクの統計をリセットする */
+    void reset_stats();
+
+    /**
+     * @brief 各タスクの統計を出力する
+     * @param[out] out 出力先
+     * @details 1タスク1行で "task<番号> dt:<us> exec:<us>/<us> late:<us> overruns:<回数>"
+     */
+    void print_stats(Print &out) const;
+};
+
+} // namespace robo
+
+#else /* ARDUINO */
+
+#error This liblary is for Arduino.
+
+#endif /* ARDUINO */
+
+#endif /* ROBO2019_SCHEDULER_H */
@@ -0,0 +1,195 @@
+/**
+ * @file strategy.h
+ * @brief 表で定義する状態機械
+ * @note ホストのPCでもテストできるよう、Arduinoの機能には依存しない
+ */
+
+#pragma once
+
+#ifndef ROBO2019_STRATEGY_H
+#define ROBO2019_STRATEGY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#endif
+
+/**
+ * @namespace robo
+ * @brief 自作ライブラリの機能をまとめたもの
+ */
+namespace robo {
+
+/**
+ * @brief 状態機械の表の要素
+ */
+namespace strategy {
+    //! 遷移元に指定すると、どの状態からでも遷移できる
+    constexpr uint8_t any = 0xff;
+
+    /**
+     * @brief 状態
+     * @tparam Context 判断材料と出力先をまとめた型
+     */
+    template<typename Context>
+    struct State {
+        //! 状態に入ったときに1回呼ばれる(NULL可)
+        void (*enter)(Context &);
+        //! 状態にいる間、update()のたびに呼ばれる(NULL可)
+        void (*action)(Context &);
+        //! 状態に入ってから、preemptでない遷移が許されるまでの時間(ミリ秒)
+        uint16_t min_dwell;
+    };
+
+    /**
+     * @brief 遷移
+     * @tparam Context 判断材料と出力先をまとめた型
+     */
+    template<typename Context>
+    struct Transition {
+        //! 遷移元の状態(anyならすべての状態)
+        uint8_t from;
+        //! 遷移先の状態
+        uint8_t to;
+        //! 遷移する条件
+        bool (*guard)(const Context &);
+        //! trueなら遷移元の最短滞在時間を無視する
+        bool preempt;
+    };
+
+#ifdef __AVR__
+    template<typename T> T *read_ptr(T *const *p) { return reinterpret_cast<T *>(pgm_read_ptr(p)); }
+    inline uint8_t read_u8(const uint8_t *p) { return pgm_read_byte(p); }
+    inline uint16_t read_u16(const uint16_t *p) { return pgm_read_word(p); }
+    inline bool read_bool(const bool *p) { return pgm_read_byte(p); }
+#else
+    template<typename T> T *read_ptr(T *const *p) { return *p; }
+    inline uint8_t read_u8(const uint8_t *p) { return *p; }
+    inline uint16_t read_u16(const uint16_t *p) { return *p; }
+    inline bool read_bool(const bool *p) { return *p; }
+#endif
+} // namespace strategy
+
+/**
+ * @class Strategy
+ * @brief 状態、条件付きの遷移、最短滞在時間を表で定義する状態機械
+ * @tparam Context 判断材料(センサーの値など)と出力先をまとめた型
+ * @details
+ *  状態と遷移の表はconstexprにしてPROGMEMに置く(SRAMを使わない)。
+ *  update()では、表の前から順に「今の状態から出る遷移」の条件を調べ、最初に成り立ったものに従う。
+ *  調べる遷移の数は表の大きさで決まるので、1回の判断にかかる時間はほぼ一定になる。
+ *  遷移元の状態に入ってからmin_dwellが経っていなければ、preemptの遷移以外は無視される。
+ *  これで、条件の境目で状態が行ったり来たりするのを防ぐ。
+ *  遷移先が今の状態と同じ遷移(遷移元がanyのものなど)は無視するので、入り直してenterが呼ばれることはない。
+ *  今の状態のまま判断材料が変わったときに決め直したいことは、actionの中で行う。
+ * @note
+ *  ```C++
+ *  enum : uint8_t { IDLE, CHASE };
+ *  const robo::strategy::State<Ctx> states[] PROGMEM = {
+ *      { NULL, stop, 0 },     // IDLE
+ *      { NULL, chase, 100 },  // CHASE
+ *  };
+ *  const robo::strategy::Transition<Ctx> transitions[] PROGMEM = {
+ *      { IDLE, CHASE, ball_seen, false },
+ *      { CHASE, IDLE, ball_lost, false },
+ *  };
+ *  robo::Strategy<Ctx> strategy(states, transitions, IDLE);
+ *  // 周期ごとに
+ *  strategy.update(ctx, millis());
+ *  ```
+ */
+template<typename Context>
+class Strategy
+{
+public:
+    using State = robo::strategy::State<Context>;
+    using Transition = robo::strategy::Transition<Context>;
+
+private:
+    const State *const _states;
+    const uint8_t _state_count;
+    const Transition *const _transitions;
+    const uint8_t _transition_count;
+    const uint8_t _initial;
+    uint8_t _state;
+    bool _entered;
+    uint32_t _entered_at;
+
+    void enter(uint8_t state, Context &ctx, uint32_t now)
+    {
+        _state = state;
+        _entered = true;
+        _entered_at = now;
+        auto enter = robo::strategy::read_ptr(&_states[state].enter);
+        if (enter != NULL) enter(ctx);
+    }
+
+public:
+    /**
+     * @brief Construct a new Strategy object
+     * @param[in] states 状態の表(PROGMEM)。添字が状態の番号
+     * @param[in] transitions 遷移の表(PROGMEM)。前にあるほど優先される
+     * @param[in] initial 最初の状態
+     */
+    template<uint8_t S, uint8_t T>
+    Strategy(const State (&states)[S], const Transition (&transitions)[T], uint8_t initial)
+        : _states(states), _state_count(S),
+          _transitions(transitions), _transition_count(T),
+          _initial(initial), _state(initial), _entered(false), _entered_at(0) {}
+
+    /** @brief 最初の状態に戻す(次のupdate()でenterが呼ばれる) */
+    void reset()
+    {
+        _state = _initial;
+        _entered = false;
+    }
+
+    /**
+     * @brief 遷移を判断し、今の状態のactionを実行する
+     * @param[in,out] ctx 判断材料と出力先
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return 実行した状態
+     */
+    uint8_t update(Context &ctx, uint32_t now)
+    {
+        if (!_entered) enter(_state, ctx, now);
+        const bool dwelt = now - _entered_at >= robo::strategy::read_u16(&_states[_state].min_dwell);
+        for (uint8_t i = 0; i < _transition_count; i++) {
+            const Transition &t = _transitions[i];
+            const uint8_t from = robo::strategy::read_u8(&t.from);
+            if (from != _state && from != robo::strategy::any) continue;
+            const uint8_t to = robo::strategy::read_u8(&t.to);
+            if (to == _state) continue;
+            if (!dwelt && !robo::strategy::read_bool(&t.preempt)) continue;
+            auto guard = robo::strategy::read_ptr(&t.guard);
+            if (guard != NULL && !guard(ctx)) continue;
+            enter(to, ctx, now);
+            break;
+        }
+        auto action = robo::strategy::read_ptr(&_states[_state].action);
+        if (action != NULL) action(ctx);
+        return _state;
+    }
+
+    //! 今の状態
+    uint8_t state() const { return _state; }
+    //! 状態の数
+    uint8_t size() const { return _state_count; }
+
+    /**
+     * @brief 今の状態に入ってからの時間
+     * @param[in] now 現在時刻(ミリ秒)
+     * @return 経過時間(ミリ秒)
+     */
+    uint32_t dwell(uint32_t now) const { return now - _entered_at; }
+};
+
+} // namespace robo
+
+#endif /* ROBO2019_STRATEGY_H */
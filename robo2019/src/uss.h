@@ -10,6 +10,7 @@
 
 #ifdef ARDUINO
 
+#include "pin.h"
 #include "util.h"
 
 /**
@@ -21,26 +22,45 @@ namespace robo {
 /**
  * @class USSensor
  * @brief 超音波センサーHC-SR04操作用のクラス
+ * @tparam input_pin Echo pinの番号
+ * @tparam order_pin Trig pinの番号
  * @note robo::Sensorはutil.h内
  */
+template<uint8_t input_pin, uint8_t order_pin>
 class USSensor : public robo::Sensor
 {
-public: // variables
-    //! Echo pinの番号
-    const int input_pin;
-    //! Trig pinの番号
-    const int order_pin;
+public: // static variables
+    //! Echo pin
+    using Echo = robo::DigitalPin<input_pin>;
+    //! Trig pin
+    using Trig = robo::DigitalPin<order_pin>;
 
-public: // functions
     /**
-     * @brief コンストラクタ
-     * @param[in] i Echo pinの番号
-     * @param[in] o Trig pinの番号
+     * @brief エコーを待つ時間の上限(マイクロ秒)
+     * @details HC-SR04の測定範囲(400cm)の往復にかかる時間より少し長くしてある。
+     *  pulseIn()のデフォルトは1秒なので、指定しないと物がないときにloopが止まる。
      */
-    USSensor(int i, int o) : input_pin(i), order_pin(o) {}
+    static constexpr unsigned long timeout = 25000;
+
+public: // functions
+    void setup() override
+    {
+        Echo::set_mode(INPUT);
+        Trig::set_mode(OUTPUT);
+        Trig::low();
+    }
 
-    void setup() override;
-    int read() override;
+    /**
+     * @brief 距離を測る
+     * @return 距離(cm)。範囲外の場合は0
+     */
+    int read() override
+    {
+        Trig::high();
+        delayMicroseconds(10);
+        Trig::low();
+        return Echo::pulse_in(HIGH, timeout) / 59;
+    }
 };
 
 } // namespace robo
@@ -1,3 +1,18 @@
 #include <Arduino.h>
 #include "util.h"
 
+uint8_t robo::crc8_update(uint8_t crc, uint8_t data)
+{
+    crc ^= data;
+    for (uint8_t b = 0; b < 8; b++) {
+        crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+    }
+    return crc;
+}
+
+uint8_t robo::crc8(const uint8_t *data, uint8_t size)
+{
+    uint8_t crc = 0xff;
+    for (uint8_t i = 0; i < size; i++) crc = robo::crc8_update(crc, data[i]);
+    return crc;
+}
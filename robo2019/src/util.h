@@ -10,6 +10,8 @@
 
 #ifdef ARDUINO
 
+#include <Arduino.h>
+
 /**
  * @namespace robo
  * @brief 自作ライブラリの機能をまとめたもの
@@ -66,8 +68,257 @@ public:
     static Derived& instance();
 };
 
+/**
+ * @brief コンパイラによるメモリアクセスの並べ替えを禁止する
+ * @details 割り込みと共有するデータを書いてから、volatileのインデックスを更新するときなどに使う
+ */
+inline void memory_barrier()
+{
+    __asm__ __volatile__("" ::: "memory");
+}
+
+/**
+ * @brief CRC-8(多項式0x31)を1バイト分進める
+ * @param[in] crc これまでのCRC(最初は0xff)
+ * @param[in] data 次のバイト
+ * @return uint8_t dataまでのCRC
+ * @details EEPROMから1バイトずつ読みながら確かめるときに使う
+ */
+uint8_t crc8_update(uint8_t crc, uint8_t data);
+
+/**
+ * @brief CRC-8(多項式0x31、初期値0xff)
+ * @param[in] data データ
+ * @param[in] size dataのバイト数
+ * @return uint8_t CRC
+ * @details EEPROMに保存した値が壊れていないか確かめるのに使う
+ */
+uint8_t crc8(const uint8_t *data, uint8_t size);
+
+/**
+ * @class RingBuffer
+ * @brief ロックなしのリングバッファ(単一の書き手と単一の読み手用)
+ * @tparam T 要素の型
+ * @tparam N 容量。2のべき乗で、128以下でなければならない
+ * @details
+ *  push()する側とpop()する側がそれぞれ1つなら、片方が割り込みハンドラでも割り込みを禁止せずに使える。
+ *  インデックスは1バイトで、AVRでは読み書きが1命令で終わるためアトミックになる。
+ *  書き手/読み手はどちらが割り込み側でもよく、割り込みで受け取ったイベントをloopで処理する場合にも、
+ *  loopで積んだ送信データを割り込みやloopの空き時間に少しずつ送る場合にも使える。
+ * @note
+ *  インデックスは0-255を回り続け、`N - 1`とのANDで位置を求める。
+ *  要素数は`head - tail`で求まるので、満杯と空を区別するための空き要素は不要。
+ */
+template<typename T, uint8_t N>
+class RingBuffer
+{
+private:
+    static_assert(N != 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+    static_assert(N <= 128, "capacity must be 128 or less");
+
+    //! 位置を求めるためのマスク
+    static constexpr uint8_t mask = N - 1;
+
+    T _data[N];
+    //! 次に書き込む位置。書き手だけが更新する
+    volatile uint8_t _head = 0;
+    //! 次に読み込む位置。読み手だけが更新する
+    volatile uint8_t _tail = 0;
+
+public:
+    //! 容量
+    static constexpr uint8_t capacity = N;
+
+    /**
+     * @brief 要素を追加する(書き手側)
+     * @param[in] value 追加する要素
+     * @return 追加できたらtrue。満杯ならfalse
+     */
+    bool push(const T &value)
+    {
+        uint8_t head = _head;
+        if (uint8_t(head - _tail) == N) return false;
+        _data[head & mask] = value;
+        memory_barrier();
+        _head = head + 1;
+        return true;
+    }
+
+    /**
+     * @brief 要素を取り出す(読み手側)
+     * @param[out] dst 取り出した要素
+     * @return 取り出せたらtrue。空ならfalse
+     */
+    bool pop(T &dst)
+    {
+        uint8_t tail = _tail;
+        if (tail == _head) return false;
+        dst = _data[tail & mask];
+        memory_barrier();
+        _tail = tail + 1;
+        return true;
+    }
+
+    /**
+     * @brief 先頭の要素を取り出さずに見る(読み手側)
+     * @return 先頭の要素へのポインタ。空ならNULL
+     * @note 次にpop()するまで有効
+     */
+    const T *peek() const
+    {
+        uint8_t tail = _tail;
+        if (tail == _head) return NULL;
+        return &_data[tail & mask];
+    }
+
+    /**
+     * @brief 先頭の要素を捨てる(読み手側)
+     * @return 捨てられたらtrue。空ならfalse
+     */
+    bool drop()
+    {
+        uint8_t tail = _tail;
+        if (tail == _head) return false;
+        _tail = tail + 1;
+        return true;
+    }
+
+    /** @brief 読み込んでいない要素をすべて捨てる(読み手側) */
+    void clear() { _tail = _head; }
+
+    //! 入っている要素数
+    uint8_t size() const { return uint8_t(_head - _tail); }
+    //! 空き要素数
+    uint8_t space() const { return N - size(); }
+    //! 空かどうか
+    bool empty() const { return _head == _tail; }
+    //! 満杯かどうか
+    bool full() const { return size() == N; }
+};
+
+/**
+ * @class BufferPrint
+ * @brief 決まった大きさの配列に書き込むPrint
+ * @details
+ *  printTo(Print&)で文字列にするクラスを、配列に書き込むときに使う。
+ *  snprintfと同じく、入りきらない分は捨てて必ず'\0'で終わらせ、length()は捨てた分も含めた長さを返す。
+ */
+class BufferPrint : public Print
+{
+private:
+    char *const _dst;
+    const size_t _size;
+    size_t _length;
+
+public:
+    /**
+     * @brief Construct a new BufferPrint object
+     * @param[out] dst 書き込む先(NULLなら数えるだけ)
+     * @param[in] size dstの容量('\0'を含む)
+     */
+    BufferPrint(char *dst, size_t size) : _dst(dst), _size(dst == NULL ? 0 : size), _length(0)
+    {
+        if (_size != 0) _dst[0] = '\0';
+    }
+
+    size_t write(uint8_t c) override
+    {
+        if (_length + 1 < _size) {
+            _dst[_length] = char(c);
+            _dst[_length + 1] = '\0';
+        }
+        _length++;
+        return 1;
+    }
+
+    //! 書き込もうとした文字数('\0'を含まない)
+    size_t length() const { return _length; }
+    //! 入りきらずに切り詰めたかどうか
+    bool truncated() const { return _length >= _size; }
+};
+
+/**
+ * @class StringPrint
+ * @brief Stringの末尾に書き足すPrint
+ * @details printTo(Print&)で文字列にするクラスのString版の関数に使う
+ */
+class StringPrint : public Print
+{
+private:
+    String &_dst;
+
+public:
+    /**
+     * @brief Construct a new StringPrint object
+     * @param[out] dst 書き足す先
+     */
+    explicit StringPrint(String &dst) : _dst(dst) {}
+
+    size_t write(uint8_t c) override { return _dst.concat(char(c)) ? 1 : 0; }
+};
+
+/**
+ * @brief printTo(Print&)を持つ値を配列に書き込む
+ * @tparam T printTo(Print&)を持つ型
+ * @param[out] dst 書き込む先
+ * @param[in] size dstの容量('\0'を含む)
+ * @param[in] value 書き込む値
+ * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
+ */
+template<typename T>
+size_t print_to_buffer(char *dst, size_t size, const T &value)
+{
+    BufferPrint out(dst, size);
+    value.printTo(out);
+    return out.length();
+}
+
+/**
+ * @brief printTo(Print&)を持つ値をStringにする
+ * @tparam T printTo(Print&)を持つ型
+ * @param[in] value 文字列にする値
+ * @return String 文字列
+ */
+template<typename T>
+String print_to_string(const T &value)
+{
+    String dst;
+    StringPrint out(dst);
+    value.printTo(out);
+    return dst;
+}
+
+/**
+ * @class PrintableRef
+ * @brief printTo(Print&)を持つがPrintableを継承していない値を、Printableとして渡すためのもの
+ * @tparam T printTo(Print&)を持つ型
+ * @details
+ *  robo::Vector2Dはconstexprで使えるよう仮想関数を持たないので、Printableを継承していない。
+ *  `Serial.print(robo::printable(vec))`のように使う。
+ */
+template<typename T>
+class PrintableRef : public Printable
+{
+private:
+    const T &_value;
+
+public:
+    explicit PrintableRef(const T &value) : _value(value) {}
+    size_t printTo(Print &out) const override { return _value.printTo(out); }
+};
+
+/**
+ * @brief printTo(Print&)を持つ値をPrintableとして渡す
+ * @param[in] value 値。戻り値を使い終わるまで生きていなければならない
+ */
+template<typename T>
+PrintableRef<T> printable(const T &value) { return PrintableRef<T>(value); }
+
 } // namespace robo
 
+template<typename T, uint8_t N> constexpr uint8_t robo::RingBuffer<T, N>::capacity;
+template<typename T, uint8_t N> constexpr uint8_t robo::RingBuffer<T, N>::mask;
+
 template<typename Derived> Derived& robo::SingletonBase<Derived>::instance()
 {
     static Derived ins;
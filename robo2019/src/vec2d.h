@@ -1,15 +1,23 @@
 /**
- * @file vec2d_.h
+ * @file vec2d.h
  * @brief 自作のベクトル型
  */
 
 #pragma once
 
+#ifndef ROBO2019_VEC2D_H
+#define ROBO2019_VEC2D_H
+
 #ifdef ARDUINO
 
 #include <ArxTypeTraits.h>
 #include <ArxContainer.h>
 
+#include "angle.h"
+#include "fastmath.h"
+#include "fixed.h"
+#include "util.h"
+
 /**
  * @namespace robo
  * @brief 自作ライブラリの機能をまとめたもの
@@ -18,18 +26,53 @@ namespace robo {
 
 /**
  * @brief 自作のベクトル型
- * @tparam T 成分の型。算術型でなければならない
+ * @tparam T 成分の型。算術型か固定小数点数(robo::Q8_8、robo::Q16_16)でなければならない
+ * @tparam Math atan2/hypot/sin/cosの計算方法(robo::fastmath::Policy)。既定はROBO2019_FASTMATH_ACCURACYの精度
  * @details
  *  実装している演算(`v`, `v1`, `v2`をベクトル値、`t`をT型の値とする):
  *  - `v1 [+,-,*,/] v2` -> `(v1.x [+,-,*,/] v2.x, v1.y [+,-,*,/] v2.y)`
  *  - `v [*,/] t` -> `(v.x [*,/] t, v.y [*,/] t)` 左右交換も可
  *  `+=`なども同様。
  *  任意のベクトルを要素数2の配列に置き換えることができる。ただし、ベクトルが絡む文脈でなければいけない。
+ *
+ *  ヘッダーだけで定義し、値を変えない演算はすべてconstexprなので、定数のベクトルの計算はコンパイル時に済む。
+ *  成分を固定小数点数にすると、偏角(direction())以外の計算で浮動小数点数を使わない。
  */
-template<typename  T> class Vector2D
+template<typename T, typename Math = robo::fastmath::Policy<robo::fastmath::default_accuracy>> class Vector2D
 {
 private: // static part
-    static_assert(std::is_arithmetic<T>::value, "must be a number type");
+    static_assert(std::is_arithmetic<T>::value || robo::is_fixed_point<T>::value, "must be a number type");
+
+    // 成分の型の種類(0: 浮動小数点数, 1: 固定小数点数, 2: 整数)
+    template<uint8_t K> using Kind = std::integral_constant<uint8_t, K>;
+    using kind = Kind<std::is_floating_point<T>::value ? 0 : robo::is_fixed_point<T>::value ? 1 : 2>;
+
+    // magnitude * q15 / 32767
+    static T scale_q15(const T &magnitude, int16_t q15, Kind<0>) { return magnitude * q15 * (1.0f / 32767); }
+    static T scale_q15(const T &magnitude, int16_t q15, Kind<1>) { return magnitude * T::from_q15(q15); }
+    static T scale_q15(const T &magnitude, int16_t q15, Kind<2>) { return T(robo::Angle::unscale(int32_t(magnitude) * q15)); }
+
+    // 16ビットの整数で表せる成分はiatan2で偏角を求める
+    static constexpr bool int16_direction = sizeof(T) <= 2 && !std::is_floating_point<T>::value;
+    static int16_t to_int16(const T &v, Kind<1>) { return v.raw(); }
+    static int16_t to_int16(const T &v, Kind<2>) { return int16_t(v); }
+    robo::Angle direction(std::true_type) const { return robo::fastmath::iatan2(to_int16(y, kind()), to_int16(x, kind())); }
+    robo::Angle direction(std::false_type) const { return robo::Angle::from_radians(angle()); }
+
+    // 成分1つを出力する。浮動小数点数はdtostrf(v, 5, 2)と同じく、5文字に満たなければ左を空白で埋める
+    static size_t print_float(Print &out, float v)
+    {
+        const size_t pad = (v >= 0 && v + 0.005f < 10) ? 1 : 0;
+        if (pad) out.write(' ');
+        return pad + out.print(v, 2);
+    }
+    static size_t put(Print &out, const T &v, Kind<0>) { return print_float(out, v); }
+    static size_t put(Print &out, const T &v, Kind<1>) { return print_float(out, float(v)); }
+    static size_t put(Print &out, const T &v, Kind<2>)
+    {
+        return std::is_signed<T>::value ? out.print(long(v)) : out.print((unsigned long)(v));
+    }
+
 public:
     /**
      * @brief 極形式から座標形式のベクトルを作成する
@@ -42,7 +85,7 @@ public:
      */
     static Vector2D from_polar_coord(const float & angle, const T & magnitude)
     {
-        robo::Vector2D<T> result;
+        Vector2D result;
         from_polar_coord(&result, angle, magnitude);
         return result;
     }
@@ -59,8 +102,37 @@ public:
     {
         if (dst == NULL)
             return;
-        dst->x = magnitude * cos(angle);
-        dst->y = magnitude * sin(angle);
+        float s, c;
+        Math::sincos(angle, s, c);
+        dst->x = magnitude * c;
+        dst->y = magnitude * s;
+    }
+    /**
+     * @brief 極形式から座標形式のベクトルを作成する
+     * @param[in] angle 偏角
+     * @param[in] magnitude 大きさ
+     * @return 座標形式に変換したベクトル
+     * @details sin/cosを表から引くので、ラジアンで指定するより速い
+     */
+    static Vector2D from_polar_coord(robo::Angle angle, const T & magnitude)
+    {
+        Vector2D result;
+        from_polar_coord(&result, angle, magnitude);
+        return result;
+    }
+    /**
+     * @brief 極形式から座標形式のベクトルを作成する
+     * @param[in] angle 偏角
+     * @param[in] magnitude 大きさ
+     * @param[out] dst 座標形式に変換したベクトル
+     * @details sin/cosを表から引くので、ラジアンで指定するより速い
+     */
+    static void from_polar_coord(Vector2D * dst, robo::Angle angle, const T & magnitude)
+    {
+        if (dst == NULL)
+            return;
+        dst->x = scale_q15(magnitude, angle.cos(), kind());
+        dst->y = scale_q15(magnitude, angle.sin(), kind());
     }
 
 public: // instance properties
@@ -73,135 +145,201 @@ public: // instance properties
      * @brief デフォルトのコンストラクタ
      * @details x, yともに0で初期化される
      */
-    Vector2D() : x(0), y(0) {}
+    constexpr Vector2D() : x(0), y(0) {}
     /** @brief x, y成分を指定して初期化 */
-    Vector2D(const T &x, const T &y) : x(x), y(y) {}
+    constexpr Vector2D(const T &x, const T &y) : x(x), y(y) {}
     /** @brief コピーコンストラクター */
-    Vector2D(const Vector2D &p) : x(p.x), y(p.y) {}
+    constexpr Vector2D(const Vector2D &p) : x(p.x), y(p.y) {}
     /**
      * @brief 配列から初期化
      * @details 0番の要素がx、1番の要素がy
      */
-    Vector2D(const T (&p)[2]);
+    constexpr Vector2D(const T (&p)[2]) : x(p[0]), y(p[1]) {}
 
-    Vector2D& operator=(const Vector2D &rh);
-    Vector2D& operator=(const T (&rh)[2]);
+    Vector2D& operator=(const Vector2D &rh)
+    {
+        x = rh.x;
+        y = rh.y;
+        return *this;
+    }
+    Vector2D& operator=(const T (&rh)[2])
+    {
+        x = rh[0];
+        y = rh[1];
+        return *this;
+    }
 
-    const T& operator[](size_t index) const;
-    T& operator[](size_t index);
+    /**
+     * @brief 成分を取得する
+     * @param[in] index 0ならx、それ以外ならy
+     */
+    constexpr const T& operator[](size_t index) const { return index ? y : x; }
+    /**
+     * @brief 成分を取得する
+     * @param[in] index 0ならx、それ以外ならy
+     */
+    T& operator[](size_t index) { return index ? y : x; }
 
+    /**
+     * @brief ベクトルの文字列表現を出力する
+     * @param[out] out 出力先
+     * @return size_t 出力した文字数
+     * @details "(x, y)"をバッファを介さずにoutに直接書き込む。
+     *  仮想関数を持たないようPrintableは継承していないので、Printに渡すときは`robo::printable(v)`を使う。
+     */
+    size_t printTo(Print &out) const
+    {
+        size_t n = out.write('(');
+        n += put(out, x, kind());
+        n += out.write(", ", 2);
+        n += put(out, y, kind());
+        return n + out.write(')');
+    }
     /**
      * @brief ベクトルの文字列表現を返す
      * @param[out] dst "(x, y)"
-     * @return uint8_t 書き込んだ文字数
-     * @note 配列の容量チェックは行っていないので注意すること。
+     * @param[in] size dstの容量('\0'を含む)
+     * @return size_t 書き込もうとした文字数。size以上なら切り詰めている(snprintfと同じ)
      */
-    uint8_t to_string(char *dst);
+    size_t to_string(char *dst, size_t size) const { return robo::print_to_buffer(dst, size, *this); }
     /**
      * @brief ベクトルの文字列表現を返す
      * @param[out] dst "(x, y)"
+     * @return size_t 書き込もうとした文字数。N以上なら切り詰めている
      */
-    void to_string(String *dst);
+    template<size_t N>
+    size_t to_string(char (&dst)[N]) const { return to_string(dst, N); }
+    /**
+     * @brief ベクトルの文字列表現を返す
+     * @param[out] dst "(x, y)"
+     */
+    void to_string(String *dst) const
+    {
+        if (dst == NULL) return;
+        *dst = to_string();
+    }
     /**
      * @brief ベクトルの文字列表現を返す
      * @return String "(x, y)"
      */
-    String to_string();
+    String to_string() const { return robo::print_to_string(*this); }
 
     /**
      * @brief ベクトルvとの内積を返す
      * @param[in] v 内積をとるベクトル
      * @return x * v.x + y * v.y
      */
-    T dot(const Vector2D &v) const;
+    constexpr T dot(const Vector2D &v) const { return x * v.x + y * v.y; }
     /**
      * @brief 配列tmpをベクトルとみなし、それとの内積を返す
      * @param[in] tmp 内積をとるベクトルの配列形式
      * @return x * tmp[0] + y * tmp[1]
      */
-    T dot(const T (&tmp)[2]) const;
+    constexpr T dot(const T (&tmp)[2]) const { return x * tmp[0] + y * tmp[1]; }
     /**
      * @brief ベクトル(x, y)との内積を返す
      * @param[in] x 内積をとるベクトルのx成分
      * @param[in] y 内積をとるベクトルのy成分
      * @return this->x * x + this->y * y
      */
-    T dot(const T &x, const T &y) const;
+    constexpr T dot(const T &x, const T &y) const { return this->x * x + this->y * y; }
 
     /**
      * @brief ベクトルvとの内積を返す
      * @param[in] v 内積をとるベクトル
      * @param[out] dst x * v.x + y * v.y
      */
-    void dot(T *dst, const Vector2D &v);
+    void dot(T *dst, const Vector2D &v) const { if (dst != NULL) *dst = dot(v); }
     /**
      * @brief 配列tmpをベクトルとみなし、それとの内積を返す
      * @param[in] tmp 内積をとるベクトルの配列形式
      * @param[out] dst x * tmp[0] + y * tmp[1]
      */
-    void dot(T *dst, const T (&tmp)[2]);
+    void dot(T *dst, const T (&tmp)[2]) const { if (dst != NULL) *dst = dot(tmp); }
     /**
      * @brief ベクトル(x, y)との内積を返す
      * @param[in] x 内積をとるベクトルのx成分
      * @param[in] y 内積をとるベクトルのy成分
      * @param[out] dst this->x * x + this->y * y
      */
-    void dot(T *dst, const T &x, const T &y);
+    void dot(T *dst, const T &x, const T &y) const { if (dst != NULL) *dst = dot(x, y); }
 
     /**
      * @brief ベクトルの偏角を返す
      * @return 偏角(ラジアン)
      */
-    float angle() const;
+    float angle() const { return Math::atan2(float(y), float(x)); }
     /**
      * @brief ベクトルの偏角を返す
      * @param[out] dst 偏角(ラジアン)
      */
-    void angle(float *dst);
+    void angle(float *dst) const { if (dst != NULL) *dst = angle(); }
+    /**
+     * @brief ベクトルの偏角をrobo::Angleで返す
+     * @return 偏角
+     * @details 成分が16ビット以下の整数か固定小数点数なら、浮動小数点数を使わずに求める
+     */
+    robo::Angle direction() const { return direction(std::integral_constant<bool, int16_direction>()); }
     /**
      * @brief ベクトルの大きさを返す
      * @return ベクトルの大きさ
      */
-    float mag() const;
+    float mag() const { return Math::hypot(float(x), float(y)); }
     /**
      * @brief ベクトルの大きさを返す
      * @param[out] dst ベクトルの大きさ
      */
-    void mag(float *dst);
+    void mag(float *dst) const { if (dst != NULL) *dst = mag(); }
+
+    constexpr Vector2D operator+() const { return *this; }
+    constexpr Vector2D operator-() const { return Vector2D(-x, -y); }
+
+    // 演算子は、成分の型への暗黙の変換が効くようにfriendにする
+#define ROBO2019_VEC2D_OP(_op_)                                                                       \
+    friend constexpr Vector2D operator _op_(const Vector2D &lh, const Vector2D &rh)                    \
+    { return Vector2D(lh.x _op_ rh.x, lh.y _op_ rh.y); }                                               \
+    friend constexpr Vector2D operator _op_(const Vector2D &lh, const T (&rh)[2])                      \
+    { return Vector2D(lh.x _op_ rh[0], lh.y _op_ rh[1]); }                                             \
+    friend constexpr Vector2D operator _op_(const T (&lh)[2], const Vector2D &rh)                      \
+    { return Vector2D(lh[0] _op_ rh.x, lh[1] _op_ rh.y); }                                             \
+    Vector2D &operator _op_##=(const Vector2D &rh) { x = x _op_ rh.x; y = y _op_ rh.y; return *this; } \
+    Vector2D &operator _op_##=(const T (&rh)[2]) { x = x _op_ rh[0]; y = y _op_ rh[1]; return *this; }
+#define ROBO2019_VEC2D_SCALAR_OP(_op_)                                                                \
+    friend constexpr Vector2D operator _op_(const Vector2D &lh, const T &rh)                           \
+    { return Vector2D(lh.x _op_ rh, lh.y _op_ rh); }                                                   \
+    friend constexpr Vector2D operator _op_(const T &lh, const Vector2D &rh)                           \
+    { return Vector2D(lh _op_ rh.x, lh _op_ rh.y); }                                                   \
+    Vector2D &operator _op_##=(const T &rh) { x = x _op_ rh; y = y _op_ rh; return *this; }
+
+    ROBO2019_VEC2D_OP(+)
+    ROBO2019_VEC2D_OP(-)
+    ROBO2019_VEC2D_OP(*)
+    ROBO2019_VEC2D_OP(/)
+    ROBO2019_VEC2D_SCALAR_OP(*)
+    ROBO2019_VEC2D_SCALAR_OP(/)
+
+#undef ROBO2019_VEC2D_OP
+#undef ROBO2019_VEC2D_SCALAR_OP
+
+    friend constexpr bool operator==(const Vector2D &lh, const Vector2D &rh) { return lh.x == rh.x && lh.y == rh.y; }
+    friend constexpr bool operator!=(const Vector2D &lh, const Vector2D &rh) { return lh.x != rh.x || lh.y != rh.y; }
 };
 
 //! Vector2D<float>のエイリアス
 using V2_float = Vector2D<float>;
 //! Vector2D<int>のエイリアス
 using V2_int = Vector2D<int>;
+//! Vector2D<Q8_8>のエイリアス
+using V2_q8_8 = Vector2D<robo::Q8_8>;
+//! Vector2D<Q16_16>のエイリアス
+using V2_q16_16 = Vector2D<robo::Q16_16>;
 
 } // namespace robo
 
-template<typename T> uint8_t robo::Vector2D<T>::to_string(char * dst)
-{
-    if (dst == NULL) return 0;
-    if (std::is_floating_point<T>::value) {
-        char *ptr = dst;
-        *(ptr++) = '(';
-        dtostrf(x, 5, 2, ptr);
-        ptr += 5;
-        ptr[0] = ',';
-        ptr[1] = ' ';
-        ptr += 2;
-        dtostrf(y, 5, 2, ptr);
-        ptr += 5;
-        *(ptr++) = ')';
-        ptr[0] = '\0';
-        return ptr - dst;
-    } else if (std::is_signed<T>::value) {
-        return sprintf_P(dst, PSTR("(%d, %d)"), x, y);
-    } else {
-        return sprintf_P(dst, PSTR("(%u, %u)"), x, y);
-    }
-}
-
 #else /* ARDUINO */
 
 #error This liblary is for Arduino.
 
 #endif /* ARDUINO */
+
+#endif /* ROBO2019_VEC2D_H */